@@ -36,6 +36,8 @@
 #include "exec/ram_addr.h"
 #include "exec/address-spaces.h"
 #include "qemu/event_notifier.h"
+#include "qemu/main-loop.h"
+#include "qemu/timer.h"
 #include "trace.h"
 #include "hw/irq.h"
 
@@ -63,12 +65,32 @@
 
 #define KVM_MSI_HASHTAB_SIZE    256
 
+/* Architectures without dirty ring support never enable it */
+#ifndef KVM_DIRTY_LOG_PAGE_OFFSET
+#define KVM_DIRTY_LOG_PAGE_OFFSET 0
+#endif
+
+/* How often the reaper empties the dirty rings, in milliseconds */
+#define KVM_DIRTY_RING_REAPER_PERIOD 1000
+
 struct KVMParkedVcpu {
     unsigned long vcpu_id;
     int kvm_fd;
+    uint32_t kvm_fetch_index;
     QLIST_ENTRY(KVMParkedVcpu) node;
 };
 
+typedef struct KVMDirtyRingReaper {
+    /* Runs while the dirty log is started, see kvm_log_global_start() */
+    QemuThread thread;
+    QemuSemaphore sem;          /* posted to stop the thread */
+    bool running;
+    Notifier exit;
+    /* Statistics, updated with the iothread lock held */
+    uint64_t iterations;
+    uint64_t reaped_pages;
+} KVMDirtyRingReaper;
+
 struct KVMState
 {
     AccelState parent_obj;
@@ -77,6 +99,7 @@ struct KVMState
     int fd;
     int vmfd;
     int coalesced_mmio;
+    int coalesced_pio;
     struct kvm_coalesced_mmio_ring *coalesced_mmio_ring;
     bool coalesced_flush_in_progress;
     int vcpu_events;
@@ -103,6 +126,13 @@ struct KVMState
 #endif
     KVMMemoryListener memory_listener;
     QLIST_HEAD(, KVMParkedVcpu) kvm_parked_vcpus;
+    /* Memory listener of each address space, indexed by as_id */
+    KVMMemoryListener **as;
+    int nr_as;
+    /* Entries in each vcpu's dirty ring, 0 if dirty bitmaps are used */
+    uint32_t kvm_dirty_ring_size;
+    uint32_t kvm_dirty_ring_bytes;
+    KVMDirtyRingReaper reaper;
 };
 
 KVMState *kvm_state;
@@ -255,6 +285,238 @@ static int kvm_set_user_memory_region(KVMMemoryListener *kml, KVMSlot *slot)
     return ret;
 }
 
+/*
+ * dirty ring
+ *
+ * With KVM_CAP_DIRTY_LOG_RING each vcpu pushes the pages it dirties to
+ * a ring shared with userspace, so collecting them costs time in the
+ * number of dirty pages rather than in the size of guest memory.
+ */
+
+bool kvm_dirty_ring_enabled(void)
+{
+    return kvm_state && kvm_state->kvm_dirty_ring_size;
+}
+
+static bool dirty_gfn_is_dirtied(struct kvm_dirty_gfn *gfn)
+{
+    return atomic_load_acquire(&gfn->flags) == KVM_DIRTY_GFN_F_DIRTY;
+}
+
+static void dirty_gfn_set_collected(struct kvm_dirty_gfn *gfn)
+{
+    atomic_store_release(&gfn->flags, KVM_DIRTY_GFN_F_RESET);
+}
+
+/* Called with the iothread lock held */
+static void kvm_dirty_ring_mark_page(KVMState *s, uint32_t as_id,
+                                     uint32_t slot_id, uint64_t offset)
+{
+    KVMMemoryListener *kml;
+    KVMSlot *mem;
+
+    if (as_id >= s->nr_as || !s->as[as_id] || slot_id >= s->nr_slots) {
+        return;
+    }
+
+    kml = s->as[as_id];
+    mem = &kml->slots[slot_id];
+
+    /* The slot may be gone already, its pages are of no interest then */
+    if (!mem->memory_size ||
+        offset * qemu_real_host_page_size >= mem->memory_size) {
+        return;
+    }
+
+    cpu_physical_memory_set_dirty_range(mem->ram_start_offset +
+                                        offset * qemu_real_host_page_size,
+                                        qemu_real_host_page_size,
+                                        DIRTY_CLIENTS_NOCODE);
+}
+
+/* Called with the iothread lock held */
+static uint32_t kvm_dirty_ring_reap_one(KVMState *s, CPUState *cpu)
+{
+    struct kvm_dirty_gfn *dirty_gfns = cpu->kvm_dirty_gfns, *cur;
+    uint32_t ring_size = s->kvm_dirty_ring_size;
+    uint32_t count = 0, fetch = cpu->kvm_fetch_index;
+
+    if (!dirty_gfns) {
+        return 0;
+    }
+
+    while (true) {
+        cur = &dirty_gfns[fetch & (ring_size - 1)];
+        if (!dirty_gfn_is_dirtied(cur)) {
+            break;
+        }
+        kvm_dirty_ring_mark_page(s, cur->slot >> 16, cur->slot & 0xffff,
+                                 cur->offset);
+        dirty_gfn_set_collected(cur);
+        fetch++;
+        count++;
+    }
+    cpu->kvm_fetch_index = fetch;
+
+    if (count) {
+        cpu_dirty_pages_add(cpu, count);
+    }
+    trace_kvm_dirty_ring_reap_vcpu(cpu->cpu_index, count);
+
+    return count;
+}
+
+/*
+ * Collect the dirty rings of @cpu, or of all vcpus if @cpu is NULL,
+ * and give the harvested entries back to KVM.
+ *
+ * Called with the iothread lock held.
+ */
+static uint64_t kvm_dirty_ring_reap(KVMState *s, CPUState *cpu)
+{
+    int64_t stamp = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+    uint64_t total = 0;
+    int ret;
+
+    if (cpu) {
+        total = kvm_dirty_ring_reap_one(s, cpu);
+    } else {
+        CPU_FOREACH(cpu) {
+            total += kvm_dirty_ring_reap_one(s, cpu);
+        }
+    }
+
+    if (total) {
+        ret = kvm_vm_ioctl(s, KVM_RESET_DIRTY_RINGS);
+        assert(ret == total);
+    }
+
+    s->reaper.reaped_pages += total;
+    trace_kvm_dirty_ring_reap(total,
+                              qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - stamp);
+
+    return total;
+}
+
+static void do_kvm_cpu_synchronize_kick(CPUState *cpu, run_on_cpu_data arg)
+{
+    /* Leaving KVM_RUN is all that is needed */
+}
+
+/*
+ * Make sure that every page dirtied before the call is in QEMU's dirty
+ * bitmaps when it returns.  Hardware may buffer dirty pages (e.g. PML)
+ * until the vcpu exits, so kick all vcpus out of the guest before
+ * collecting the rings.
+ *
+ * Called with the iothread lock held.
+ */
+static void kvm_dirty_ring_flush(KVMState *s)
+{
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        run_on_cpu(cpu, do_kvm_cpu_synchronize_kick, RUN_ON_CPU_NULL);
+    }
+    kvm_dirty_ring_reap(s, NULL);
+}
+
+static void *kvm_dirty_ring_reaper_thread(void *data)
+{
+    KVMState *s = data;
+
+    rcu_register_thread();
+
+    /* Empty the rings in the background, so that vcpus rarely exit
+     * with KVM_EXIT_DIRTY_RING_FULL and migration only has to collect
+     * what was dirtied since the last round.
+     */
+    while (qemu_sem_timedwait(&s->reaper.sem,
+                              KVM_DIRTY_RING_REAPER_PERIOD) < 0) {
+        qemu_mutex_lock_iothread();
+        kvm_dirty_ring_reap(s, NULL);
+        s->reaper.iterations++;
+        qemu_mutex_unlock_iothread();
+    }
+
+    rcu_unregister_thread();
+    return NULL;
+}
+
+static void kvm_dirty_ring_reaper_start(KVMState *s)
+{
+    if (s->reaper.running) {
+        return;
+    }
+    s->reaper.running = true;
+    qemu_thread_create(&s->reaper.thread, "kvm-reaper",
+                       kvm_dirty_ring_reaper_thread, s,
+                       QEMU_THREAD_JOINABLE);
+}
+
+static void kvm_dirty_ring_reaper_stop(KVMState *s)
+{
+    bool locked = qemu_mutex_iothread_locked();
+
+    if (!s->reaper.running) {
+        return;
+    }
+    s->reaper.running = false;
+    qemu_sem_post(&s->reaper.sem);
+
+    /* The reaper may be waiting for the iothread lock */
+    if (locked) {
+        qemu_mutex_unlock_iothread();
+    }
+    qemu_thread_join(&s->reaper.thread);
+    if (locked) {
+        qemu_mutex_lock_iothread();
+    }
+}
+
+static void kvm_dirty_ring_reaper_exit(Notifier *n, void *data)
+{
+    KVMState *s = container_of(n, KVMState, reaper.exit);
+
+    kvm_dirty_ring_reaper_stop(s);
+}
+
+static int kvm_dirty_ring_init(KVMState *s, uint32_t ring_size)
+{
+    uint32_t ring_bytes = ring_size * sizeof(struct kvm_dirty_gfn);
+    int max_bytes;
+    int ret;
+
+    max_bytes = kvm_vm_check_extension(s, KVM_CAP_DIRTY_LOG_RING);
+    if (!max_bytes) {
+        warn_report("KVM dirty ring not supported by the host kernel, "
+                    "falling back to dirty bitmaps");
+        return 0;
+    }
+
+    if (ring_bytes > max_bytes) {
+        error_report("KVM dirty ring size %" PRIu32 " too big "
+                     "(maximum is %zu)", ring_size,
+                     max_bytes / sizeof(struct kvm_dirty_gfn));
+        return -EINVAL;
+    }
+
+    ret = kvm_vm_enable_cap(s, KVM_CAP_DIRTY_LOG_RING, 0, ring_bytes);
+    if (ret) {
+        error_report("Enabling of KVM dirty ring failed: %s",
+                     strerror(-ret));
+        return ret;
+    }
+
+    s->kvm_dirty_ring_size = ring_size;
+    s->kvm_dirty_ring_bytes = ring_bytes;
+
+    qemu_sem_init(&s->reaper.sem, 0);
+    s->reaper.exit.notify = kvm_dirty_ring_reaper_exit;
+    qemu_add_exit_notifier(&s->reaper.exit);
+    return 0;
+}
+
 int kvm_destroy_vcpu(CPUState *cpu)
 {
     KVMState *s = kvm_state;
@@ -276,15 +538,27 @@ int kvm_destroy_vcpu(CPUState *cpu)
         goto err;
     }
 
+    if (cpu->kvm_dirty_gfns) {
+        /* Don't lose what the vcpu dirtied last */
+        kvm_dirty_ring_reap(s, cpu);
+        ret = munmap(cpu->kvm_dirty_gfns, s->kvm_dirty_ring_bytes);
+        if (ret < 0) {
+            goto err;
+        }
+        cpu->kvm_dirty_gfns = NULL;
+    }
+
     vcpu = g_malloc0(sizeof(*vcpu));
     vcpu->vcpu_id = kvm_arch_vcpu_id(cpu);
     vcpu->kvm_fd = cpu->kvm_fd;
+    vcpu->kvm_fetch_index = cpu->kvm_fetch_index;
     QLIST_INSERT_HEAD(&kvm_state->kvm_parked_vcpus, vcpu, node);
 err:
     return ret;
 }
 
-static int kvm_get_vcpu(KVMState *s, unsigned long vcpu_id)
+static int kvm_get_vcpu(KVMState *s, unsigned long vcpu_id,
+                        uint32_t *fetch_index)
 {
     struct KVMParkedVcpu *cpu;
 
@@ -294,11 +568,14 @@ static int kvm_get_vcpu(KVMState *s, unsigned long vcpu_id)
 
             QLIST_REMOVE(cpu, node);
             kvm_fd = cpu->kvm_fd;
+            /* The kernel's ring index survives the vcpu being parked */
+            *fetch_index = cpu->kvm_fetch_index;
             g_free(cpu);
             return kvm_fd;
         }
     }
 
+    *fetch_index = 0;
     return kvm_vm_ioctl(s, KVM_CREATE_VCPU, (void *)vcpu_id);
 }
 
@@ -310,7 +587,7 @@ int kvm_init_vcpu(CPUState *cpu)
 
     DPRINTF("kvm_init_vcpu\n");
 
-    ret = kvm_get_vcpu(s, kvm_arch_vcpu_id(cpu));
+    ret = kvm_get_vcpu(s, kvm_arch_vcpu_id(cpu), &cpu->kvm_fetch_index);
     if (ret < 0) {
         DPRINTF("kvm_create_vcpu failed\n");
         goto err;
@@ -340,6 +617,19 @@ int kvm_init_vcpu(CPUState *cpu)
             (void *)cpu->kvm_run + s->coalesced_mmio * PAGE_SIZE;
     }
 
+    if (s->kvm_dirty_ring_size) {
+        cpu->kvm_dirty_gfns = mmap(NULL, s->kvm_dirty_ring_bytes,
+                                   PROT_READ | PROT_WRITE, MAP_SHARED,
+                                   cpu->kvm_fd,
+                                   PAGE_SIZE * KVM_DIRTY_LOG_PAGE_OFFSET);
+        if (cpu->kvm_dirty_gfns == MAP_FAILED) {
+            cpu->kvm_dirty_gfns = NULL;
+            ret = -errno;
+            DPRINTF("mmap'ing vcpu dirty ring failed\n");
+            goto err;
+        }
+    }
+
     ret = kvm_arch_init_vcpu(cpu);
 err:
     return ret;
@@ -536,6 +826,40 @@ static void kvm_uncoalesce_mmio_region(MemoryListener *listener,
     }
 }
 
+static void kvm_coalesce_pio_add(MemoryListener *listener,
+                                 MemoryRegionSection *section,
+                                 hwaddr start, hwaddr size)
+{
+    KVMState *s = kvm_state;
+
+    if (s->coalesced_pio) {
+        struct kvm_coalesced_mmio_zone zone;
+
+        zone.addr = start;
+        zone.size = size;
+        zone.pio = 1;
+
+        (void)kvm_vm_ioctl(s, KVM_REGISTER_COALESCED_MMIO, &zone);
+    }
+}
+
+static void kvm_coalesce_pio_del(MemoryListener *listener,
+                                 MemoryRegionSection *section,
+                                 hwaddr start, hwaddr size)
+{
+    KVMState *s = kvm_state;
+
+    if (s->coalesced_pio) {
+        struct kvm_coalesced_mmio_zone zone;
+
+        zone.addr = start;
+        zone.size = size;
+        zone.pio = 1;
+
+        (void)kvm_vm_ioctl(s, KVM_UNREGISTER_COALESCED_MMIO, &zone);
+    }
+}
+
 int kvm_check_extension(KVMState *s, unsigned int extension)
 {
     int ret;
@@ -725,7 +1049,11 @@ static void kvm_set_phys_mem(KVMMemoryListener *kml,
             return;
         }
         if (mem->flags & KVM_MEM_LOG_DIRTY_PAGES) {
-            kvm_physical_sync_dirty_bitmap(kml, section);
+            if (kvm_state->kvm_dirty_ring_size) {
+                kvm_dirty_ring_reap(kvm_state, NULL);
+            } else {
+                kvm_physical_sync_dirty_bitmap(kml, section);
+            }
         }
 
         /* unregister the slot */
@@ -744,6 +1072,9 @@ static void kvm_set_phys_mem(KVMMemoryListener *kml,
     mem->memory_size = size;
     mem->start_addr = start_addr;
     mem->ram = ram;
+    mem->ram_start_offset = memory_region_get_ram_addr(mr) +
+                            section->offset_within_region +
+                            (start_addr - section->offset_within_address_space);
     mem->flags = kvm_mem_flags(mr);
 
     err = kvm_set_user_memory_region(kml, mem);
@@ -784,6 +1115,43 @@ static void kvm_log_sync(MemoryListener *listener,
     }
 }
 
+/*
+ * The dirty rings cover all address spaces, so the hooks below only act
+ * for address space 0.
+ */
+static void kvm_log_sync_global(MemoryListener *listener, bool flush)
+{
+    KVMMemoryListener *kml = container_of(listener, KVMMemoryListener, listener);
+
+    if (kml->as_id != 0) {
+        return;
+    }
+    if (flush) {
+        kvm_dirty_ring_flush(kvm_state);
+    } else {
+        /* Entries still buffered by running vcpus show up next time */
+        kvm_dirty_ring_reap(kvm_state, NULL);
+    }
+}
+
+static void kvm_log_global_start(MemoryListener *listener)
+{
+    KVMMemoryListener *kml = container_of(listener, KVMMemoryListener, listener);
+
+    if (kml->as_id == 0) {
+        kvm_dirty_ring_reaper_start(kvm_state);
+    }
+}
+
+static void kvm_log_global_stop(MemoryListener *listener)
+{
+    KVMMemoryListener *kml = container_of(listener, KVMMemoryListener, listener);
+
+    if (kml->as_id == 0) {
+        kvm_dirty_ring_reaper_stop(kvm_state);
+    }
+}
+
 static void kvm_mem_ioeventfd_add(MemoryListener *listener,
                                   MemoryRegionSection *section,
                                   bool match_data, uint64_t data,
@@ -869,15 +1237,26 @@ void kvm_memory_listener_register(KVMState *s, KVMMemoryListener *kml,
     kml->listener.region_del = kvm_region_del;
     kml->listener.log_start = kvm_log_start;
     kml->listener.log_stop = kvm_log_stop;
-    kml->listener.log_sync = kvm_log_sync;
+    if (s->kvm_dirty_ring_size) {
+        kml->listener.log_sync_global = kvm_log_sync_global;
+        kml->listener.log_global_start = kvm_log_global_start;
+        kml->listener.log_global_stop = kvm_log_global_stop;
+    } else {
+        kml->listener.log_sync = kvm_log_sync;
+    }
     kml->listener.priority = 10;
 
+    assert(as_id < s->nr_as);
+    s->as[as_id] = kml;
+
     memory_listener_register(&kml->listener, as);
 }
 
 static MemoryListener kvm_io_listener = {
     .eventfd_add = kvm_io_ioeventfd_add,
     .eventfd_del = kvm_io_ioeventfd_del,
+    .coalesced_io_add = kvm_coalesce_pio_add,
+    .coalesced_io_del = kvm_coalesce_pio_del,
     .priority = 10,
 };
 
@@ -1558,6 +1937,19 @@ static int kvm_init(MachineState *ms)
 
     s->vmfd = ret;
 
+    s->nr_as = kvm_check_extension(s, KVM_CAP_MULTI_ADDRESS_SPACE);
+    if (s->nr_as <= 1) {
+        s->nr_as = 1;
+    }
+    s->as = g_new0(KVMMemoryListener *, s->nr_as);
+
+    if (machine_kvm_dirty_ring_size(ms)) {
+        ret = kvm_dirty_ring_init(s, machine_kvm_dirty_ring_size(ms));
+        if (ret < 0) {
+            goto err;
+        }
+    }
+
     /* check the vcpu limits */
     soft_vcpus_limit = kvm_recommended_vcpus(s);
     hard_vcpus_limit = kvm_max_vcpus(s);
@@ -1591,6 +1983,8 @@ static int kvm_init(MachineState *ms)
     }
 
     s->coalesced_mmio = kvm_check_extension(s, KVM_CAP_COALESCED_MMIO);
+    s->coalesced_pio = s->coalesced_mmio &&
+                       kvm_check_extension(s, KVM_CAP_COALESCED_PIO);
 
 #ifdef KVM_CAP_VCPU_EVENTS
     s->vcpu_events = kvm_check_extension(s, KVM_CAP_VCPU_EVENTS);
@@ -1649,8 +2043,8 @@ static int kvm_init(MachineState *ms)
         s->memory_listener.listener.eventfd_add = kvm_mem_ioeventfd_add;
         s->memory_listener.listener.eventfd_del = kvm_mem_ioeventfd_del;
     }
-    s->memory_listener.listener.coalesced_mmio_add = kvm_coalesce_mmio_region;
-    s->memory_listener.listener.coalesced_mmio_del = kvm_uncoalesce_mmio_region;
+    s->memory_listener.listener.coalesced_io_add = kvm_coalesce_mmio_region;
+    s->memory_listener.listener.coalesced_io_del = kvm_uncoalesce_mmio_region;
 
     kvm_memory_listener_register(s, &s->memory_listener,
                                  &address_space_memory, 0);
@@ -1672,6 +2066,7 @@ err:
         close(s->fd);
     }
     g_free(s->memory_listener.slots);
+    g_free(s->as);
 
     return ret;
 }
@@ -1735,10 +2130,13 @@ void kvm_flush_coalesced_mmio_buffer(void)
         struct kvm_coalesced_mmio_ring *ring = s->coalesced_mmio_ring;
         while (ring->first != ring->last) {
             struct kvm_coalesced_mmio *ent;
+            AddressSpace *as;
 
             ent = &ring->coalesced_mmio[ring->first];
 
-            cpu_physical_memory_write(ent->phys_addr, ent->data, ent->len);
+            as = ent->pio == 1 ? &address_space_io : &address_space_memory;
+            address_space_write_coalesced(as, ent->phys_addr,
+                                          ent->data, ent->len);
             smp_wmb();
             ring->first = (ring->first + 1) % KVM_COALESCED_MMIO_MAX;
         }
@@ -1949,6 +2347,14 @@ int kvm_cpu_exec(CPUState *cpu)
             DPRINTF("irq_window_open\n");
             ret = EXCP_INTERRUPT;
             break;
+        case KVM_EXIT_DIRTY_RING_FULL:
+            /* The reaper fell behind; empty our own ring and go on */
+            trace_kvm_dirty_ring_full(cpu->cpu_index);
+            qemu_mutex_lock_iothread();
+            kvm_dirty_ring_reap(kvm_state, cpu);
+            qemu_mutex_unlock_iothread();
+            ret = 0;
+            break;
         case KVM_EXIT_SHUTDOWN:
             DPRINTF("shutdown\n");
             qemu_system_reset_request(SHUTDOWN_CAUSE_GUEST_RESET);
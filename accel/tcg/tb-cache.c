@@ -0,0 +1,664 @@
+/*
+ * Persistent translation cache for user-mode emulation
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+/*
+ * Translated code is written to a file when the guest process exits, and
+ * every TB_CACHE_SAVE_INTERVAL while it translates new code, and mapped
+ * back over the code buffer when the same guest binary is started again.
+ * Host code is not relocatable: it embeds the addresses of helpers, of
+ * other TBs and of the prologue.  The file is therefore only used if QEMU
+ * itself and its code buffer are at the same host addresses as when the
+ * file was written, and -tb-cache is refused by PIE builds, where this
+ * is never the case.  In a non-PIE build the code buffer is static, so
+ * only shared libraries move; TBs that call or refer to anything outside
+ * the QEMU image are not saved, see below.
+ *
+ * Cached TBs are not visible to the execution loop until tb_gen_code()
+ * asks for them and the guest code they were translated from is found,
+ * unchanged, at the same guest address.  Jumps between TBs are reset when
+ * a TB is adopted, and chained again as usual.
+ *
+ * A TB is checked to refer only to code and data inside the image when
+ * it is first looked up, and before it is saved again; nothing else in
+ * the file is used before that.  Nothing can tell whether the host code
+ * itself is what QEMU generated, so the cache directory must be trusted
+ * as much as the QEMU binary is.
+ *
+ * TBs whose code embeds a pointer outside the QEMU image, such as the
+ * g_malloc'd ARMCPRegInfo passed to the ARM coprocessor helpers or a
+ * helper in a shared library, are marked CF_NOPERSIST by tcg_ptr_value()
+ * and never written out.  The guest libraries need no identity of their
+ * own: the guest code of every TB is compared before the TB is used.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu-common.h"
+#include "cpu.h"
+#include "trace.h"
+#include "qemu/error-report.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "exec/exec-all.h"
+#include "exec/cpu_ldst.h"
+#include "exec/tb-cache.h"
+#include "exec/tb-context.h"
+#include "tcg.h"
+#include "translate-all.h"
+
+#define TB_CACHE_MAGIC   "QEMUTBC2"
+
+#define TB_CACHE_SAVE_INTERVAL  (60 * NANOSECONDS_PER_SECOND)
+
+typedef struct TBCacheHeader {
+    char magic[8];
+    uint32_t header_size;
+    uint32_t n_tbs;
+    /* identity of the QEMU binary and of its address space layout */
+    uint64_t host_dev;
+    uint64_t host_ino;
+    uint64_t host_size;
+    uint64_t host_mtime;
+    uint64_t text_ref;
+    uint64_t guest_base;
+    /* SHA-256 of the guest executable */
+    uint8_t exec_sum[32];
+    /* code image, mapped at code_base; TBs start at code_start */
+    uint64_t code_base;
+    uint64_t code_start;
+    uint64_t code_size;
+    uint64_t code_offset;
+    /* one TBCacheIndex per TB, followed by the guest code of each TB */
+    uint64_t index_offset;
+    uint64_t guest_offset;
+    uint64_t guest_size;
+} TBCacheHeader;
+
+typedef struct TBCacheIndex {
+    uint64_t tb_offset;
+    uint64_t guest_offset;
+} TBCacheIndex;
+
+typedef struct TBCacheEntry TBCacheEntry;
+struct TBCacheEntry {
+    uint64_t pc;
+    TranslationBlock *tb;
+    const uint8_t *guest;
+    TBCacheEntry *next;
+};
+
+static struct {
+    char *path;
+    char *exec_path;
+    TBCacheHeader id;
+    bool exec_sum_valid;
+    /* TBs loaded from the file that have not been adopted yet */
+    GHashTable *pending;
+    TBCacheEntry *entries;
+    uint8_t *guest;
+    uint64_t guest_size;
+    /* end of the code image loaded from the file */
+    uint8_t *image_end;
+    /* end of the code that the file already has */
+    void *saved_end;
+    int64_t saved_at;
+    unsigned hits;
+} tbc;
+
+static bool tb_cache_identify(TBCacheHeader *hdr)
+{
+    struct stat st;
+
+    if (stat("/proc/self/exe", &st) < 0) {
+        return false;
+    }
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, TB_CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->header_size = sizeof(*hdr);
+    hdr->host_dev = st.st_dev;
+    hdr->host_ino = st.st_ino;
+    hdr->host_size = st.st_size;
+    hdr->host_mtime = st.st_mtime;
+    hdr->text_ref = (uintptr_t)tb_gen_code;
+    hdr->guest_base = guest_base;
+    hdr->code_base = (uintptr_t)QEMU_ALIGN_PTR_DOWN(tcg_ctx->code_gen_buffer,
+                                                    qemu_real_host_page_size);
+    hdr->code_start = (uintptr_t)tcg_ctx->code_gen_buffer;
+    return true;
+}
+
+/*
+ * The cache file is named after a hash of the identity of the guest
+ * executable, the CPU model, the address at which the executable was
+ * loaded and the options that change the code generated for it.  Only
+ * stat() data is used, so that starting QEMU does not cost a read of the
+ * whole executable; its contents are compared against the checksum in
+ * the file when one is found, see tb_cache_exec_sum().
+ */
+static char *tb_cache_key(const char *exec_path, const char *cpu_model,
+                          abi_ulong load_addr)
+{
+    struct {
+        uint64_t dev, ino, size, mtime, mtime_nsec, load_addr;
+        int32_t singlestep, regalloc, nochain;
+    } id;
+    struct stat st;
+    GChecksum *sum;
+    char *key;
+
+    if (stat(exec_path, &st) < 0) {
+        return NULL;
+    }
+    memset(&id, 0, sizeof(id));
+    id.dev = st.st_dev;
+    id.ino = st.st_ino;
+    id.size = st.st_size;
+    id.mtime = st.st_mtim.tv_sec;
+    id.mtime_nsec = st.st_mtim.tv_nsec;
+    id.load_addr = load_addr;
+    id.singlestep = singlestep;
+    id.regalloc = tcg_regalloc_mode;
+    id.nochain = qemu_loglevel_mask(CPU_LOG_TB_NOCHAIN);
+
+    sum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(sum, (const guchar *)&id, sizeof(id));
+    g_checksum_update(sum, (const guchar *)TARGET_NAME, strlen(TARGET_NAME));
+    g_checksum_update(sum, (const guchar *)cpu_model, strlen(cpu_model));
+    key = g_strdup(g_checksum_get_string(sum));
+    g_checksum_free(sum);
+    return key;
+}
+
+/* Store the SHA-256 of the guest executable in tbc.id.  */
+static bool tb_cache_exec_sum(void)
+{
+    GMappedFile *mf;
+    GChecksum *sum;
+    gsize len = sizeof(tbc.id.exec_sum);
+
+    if (tbc.exec_sum_valid) {
+        return true;
+    }
+    mf = g_mapped_file_new(tbc.exec_path, FALSE, NULL);
+    if (!mf) {
+        return false;
+    }
+    sum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(sum, (const guchar *)g_mapped_file_get_contents(mf),
+                      g_mapped_file_get_length(mf));
+    g_checksum_get_digest(sum, tbc.id.exec_sum, &len);
+    g_checksum_free(sum);
+    g_mapped_file_unref(mf);
+    tbc.exec_sum_valid = true;
+    return true;
+}
+
+static const char *tb_cache_check(int fd, const TBCacheHeader *hdr)
+{
+    const TBCacheHeader *id = &tbc.id;
+    size_t prologue = id->code_start - id->code_base;
+    uint8_t *buf;
+    struct stat st;
+    bool same;
+
+    if (memcmp(hdr->magic, id->magic, sizeof(hdr->magic)) ||
+        hdr->header_size != id->header_size) {
+        return "bad header";
+    }
+    if (hdr->host_dev != id->host_dev || hdr->host_ino != id->host_ino ||
+        hdr->host_size != id->host_size ||
+        hdr->host_mtime != id->host_mtime) {
+        return "different QEMU binary";
+    }
+    if (hdr->text_ref != id->text_ref || hdr->code_base != id->code_base ||
+        hdr->code_start != id->code_start) {
+        return "QEMU loaded at a different address";
+    }
+    if (hdr->guest_base != id->guest_base) {
+        return "different guest_base";
+    }
+    if (hdr->code_size < prologue + sizeof(TranslationBlock) ||
+        hdr->code_size > (uintptr_t)tcg_ctx->code_gen_highwater -
+                         hdr->code_base ||
+        hdr->code_offset & (qemu_real_host_page_size - 1)) {
+        return "bad code image";
+    }
+    if (fstat(fd, &st) < 0 ||
+        hdr->code_size > st.st_size ||
+        hdr->code_offset > st.st_size - hdr->code_size ||
+        hdr->n_tbs * sizeof(TBCacheIndex) > st.st_size ||
+        hdr->index_offset > st.st_size - hdr->n_tbs * sizeof(TBCacheIndex) ||
+        hdr->guest_size > st.st_size ||
+        hdr->guest_offset > st.st_size - hdr->guest_size) {
+        return "truncated file";
+    }
+
+    /* The image starts with the prologue, which must not have changed */
+    buf = g_malloc(prologue);
+    same = pread(fd, buf, prologue, hdr->code_offset) == prologue &&
+           !memcmp(buf, (void *)(uintptr_t)id->code_base, prologue);
+    g_free(buf);
+    return same ? NULL : "different prologue";
+}
+
+/*
+ * Check that @tb, loaded from the file as @e, only refers to host code
+ * and data within the loaded image, and that its guest code is in the
+ * file.  Nothing in a TB is used before this has succeeded.
+ */
+static bool tb_cache_check_tb(TranslationBlock *tb, const TBCacheEntry *e)
+{
+    uint8_t *start = (uint8_t *)(uintptr_t)tbc.id.code_start;
+    uint8_t *end = tbc.image_end;
+    uint64_t guest_offset = e->guest - tbc.guest;
+    int n;
+
+    if (tb_cflags(tb) & (CF_INVALID | CF_NOCACHE | CF_NOPERSIST) ||
+        tb->size == 0 || tb->size > TARGET_PAGE_SIZE ||
+        tb->icount == 0 || tb->icount > TCG_MAX_INSNS ||
+        tb->size > tbc.guest_size ||
+        guest_offset > tbc.guest_size - tb->size) {
+        return false;
+    }
+    if ((uint8_t *)tb->tc.ptr < (uint8_t *)(tb + 1) ||
+        (uint8_t *)tb->tc.ptr < start || (uint8_t *)tb->tc.ptr >= end ||
+        tb->tc.size == 0 || tb->tc.size > end - (uint8_t *)tb->tc.ptr) {
+        return false;
+    }
+    for (n = 0; n < 2; n++) {
+        if (tb->jmp_reset_offset[n] == TB_JMP_RESET_OFFSET_INVALID) {
+            continue;
+        }
+        if (tb->jmp_reset_offset[n] >= tb->tc.size) {
+            return false;
+        }
+        if (TCG_TARGET_HAS_direct_jump &&
+            tb->jmp_target_arg[n] >= tb->tc.size) {
+            return false;
+        }
+    }
+    return tb_search_data_valid(tb, end);
+}
+
+/*
+ * Map the code image of @fd at its original address.  It is made
+ * executable only once the prologue in it is known to be the one QEMU
+ * generated; on failure the original, empty code buffer is put back.
+ */
+static const char *tb_cache_map(int fd, const TBCacheHeader *hdr)
+{
+    void *base = (void *)(uintptr_t)hdr->code_base;
+    size_t prologue = hdr->code_start - hdr->code_base;
+    uint8_t *saved;
+
+    saved = g_memdup(base, prologue);
+    if (mmap(base, hdr->code_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, fd, hdr->code_offset) != base) {
+        goto fail;
+    }
+    if (memcmp(base, saved, prologue) ||
+        mprotect(base, hdr->code_size,
+                 PROT_READ | PROT_WRITE | PROT_EXEC) < 0) {
+        goto fail;
+    }
+    g_free(saved);
+    return NULL;
+
+fail:
+    if (mmap(base, hdr->code_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != base) {
+        /* The prologue is gone; nothing sensible can be done */
+        error_report("tb-cache: cannot restore code buffer: %s",
+                     strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    memcpy(base, saved, prologue);
+    flush_icache_range((uintptr_t)base, (uintptr_t)base + prologue);
+    g_free(saved);
+    return "invalid code image";
+}
+
+static void tb_cache_load(const char *path)
+{
+    TBCacheHeader hdr;
+    TBCacheIndex *index = NULL;
+    const char *err;
+    void *base;
+    uint32_t i;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+        err = "truncated file";
+        goto fail;
+    }
+    err = tb_cache_check(fd, &hdr);
+    if (err) {
+        goto fail;
+    }
+    if (!tb_cache_exec_sum() ||
+        memcmp(hdr.exec_sum, tbc.id.exec_sum, sizeof(hdr.exec_sum))) {
+        err = "different guest binary";
+        goto fail;
+    }
+
+    index = g_new(TBCacheIndex, hdr.n_tbs);
+    tbc.guest = g_malloc(hdr.guest_size);
+    if (pread(fd, index, hdr.n_tbs * sizeof(TBCacheIndex), hdr.index_offset)
+        != hdr.n_tbs * sizeof(TBCacheIndex) ||
+        pread(fd, tbc.guest, hdr.guest_size, hdr.guest_offset)
+        != hdr.guest_size) {
+        err = "read error";
+        goto fail;
+    }
+    for (i = 0; i < hdr.n_tbs; i++) {
+        if (index[i].tb_offset < hdr.code_start - hdr.code_base ||
+            index[i].tb_offset & (sizeof(uintptr_t) - 1) ||
+            index[i].tb_offset > hdr.code_size - sizeof(TranslationBlock) ||
+            index[i].guest_offset > hdr.guest_size) {
+            err = "bad index";
+            goto fail;
+        }
+    }
+    err = tb_cache_map(fd, &hdr);
+    if (err) {
+        goto fail;
+    }
+
+    base = (void *)(uintptr_t)hdr.code_base;
+    tbc.guest_size = hdr.guest_size;
+    tbc.image_end = base + hdr.code_size;
+    tbc.saved_end = tbc.image_end;
+    tcg_ctx->code_gen_ptr = tbc.image_end;
+    flush_icache_range((uintptr_t)base, (uintptr_t)tbc.image_end);
+
+    tbc.entries = g_new0(TBCacheEntry, hdr.n_tbs);
+    for (i = 0; i < hdr.n_tbs; i++) {
+        TBCacheEntry *e = &tbc.entries[i];
+        TranslationBlock *tb = base + index[i].tb_offset;
+
+        e->pc = tb->pc;
+        e->tb = tb;
+        e->guest = tbc.guest + index[i].guest_offset;
+        e->next = g_hash_table_lookup(tbc.pending, &e->pc);
+        g_hash_table_replace(tbc.pending, &e->pc, e);
+    }
+    g_free(index);
+    close(fd);
+    trace_tb_cache_load(path, hdr.n_tbs, hdr.code_size);
+    return;
+
+fail:
+    g_free(index);
+    g_free(tbc.guest);
+    tbc.guest = NULL;
+    close(fd);
+    trace_tb_cache_reject(path, err);
+}
+
+/*
+ * Called once the guest binary is loaded and the TCG prologue and region
+ * are set up, before any code is translated.
+ */
+void tb_cache_init(const char *dir, const char *exec_path,
+                   const char *cpu_model, abi_ulong load_addr)
+{
+    char *key;
+
+    if (!dir || !tb_cache_identify(&tbc.id)) {
+        return;
+    }
+    key = tb_cache_key(exec_path, cpu_model, load_addr);
+    if (!key) {
+        return;
+    }
+    tbc.path = g_strdup_printf("%s/%s.tbc", dir, key);
+    /* The guest may change directory before the cache is saved */
+    tbc.exec_path = realpath(exec_path, NULL);
+    if (!tbc.exec_path) {
+        g_free(tbc.path);
+        tbc.path = NULL;
+        g_free(key);
+        return;
+    }
+    tbc.pending = g_hash_table_new(g_int64_hash, g_int64_equal);
+    tbc.saved_end = tcg_ctx->code_gen_buffer;
+    tbc.saved_at = get_clock();
+    g_free(key);
+
+    tb_cache_load(tbc.path);
+}
+
+static bool tb_cache_guest_matches(TranslationBlock *tb, const uint8_t *guest)
+{
+    return page_check_range(tb->pc, tb->size, PAGE_READ) == 0 &&
+           !memcmp(g2h(tb->pc), guest, tb->size);
+}
+
+/*
+ * Return a cached TB for the given state whose guest code is unchanged,
+ * linked as if it had just been translated, or NULL.
+ *
+ * Called with mmap_lock and tb_lock held.
+ */
+TranslationBlock *tb_cache_lookup(CPUState *cpu, target_ulong pc,
+                                  target_ulong cs_base, uint32_t flags,
+                                  uint32_t cflags)
+{
+    uint64_t key = pc;
+    TBCacheEntry *e, **pe, *head;
+    TranslationBlock *tb;
+    target_ulong virt_page2;
+    tb_page_addr_t phys_page2;
+
+    if (!tbc.pending) {
+        return NULL;
+    }
+    head = g_hash_table_lookup(tbc.pending, &key);
+    for (pe = &head; (e = *pe) != NULL; pe = &e->next) {
+        tb = e->tb;
+        if (tb->pc == pc && tb->cs_base == cs_base && tb->flags == flags &&
+            tb_cflags(tb) == cflags &&
+            tb->trace_vcpu_dstate == *cpu->trace_dstate) {
+            if (!tb_cache_check_tb(tb, e)) {
+                trace_tb_cache_reject(tbc.path, "invalid TB");
+                continue;
+            }
+            if (tb_cache_guest_matches(tb, e->guest)) {
+                break;
+            }
+        }
+    }
+    if (!e) {
+        return NULL;
+    }
+
+    /* Unlink the entry; it is saved again from tb_tree if still valid */
+    *pe = e->next;
+    if (head) {
+        g_hash_table_replace(tbc.pending, &head->pc, head);
+    } else {
+        g_hash_table_remove(tbc.pending, &key);
+    }
+
+    virt_page2 = (pc + tb->size - 1) & TARGET_PAGE_MASK;
+    phys_page2 = -1;
+    if ((pc & TARGET_PAGE_MASK) != virt_page2) {
+        phys_page2 = virt_page2;
+    }
+    tb_link_cached(tb, pc, phys_page2);
+    tbc.hits++;
+    return tb;
+}
+
+/*
+ * Called from tb_flush, which overwrites the loaded image.  Anything
+ * translated from now on is new to the file, even if the code buffer
+ * does not get past where the image used to end.
+ */
+void tb_cache_flush(void)
+{
+    if (tbc.pending) {
+        g_hash_table_remove_all(tbc.pending);
+        tbc.saved_end = tcg_ctx->code_gen_buffer;
+    }
+}
+
+typedef struct TBCacheWriter {
+    GArray *index;
+    GByteArray *guest;
+    uint8_t *base;
+} TBCacheWriter;
+
+static void tb_cache_add(TBCacheWriter *w, TranslationBlock *tb,
+                         const uint8_t *guest)
+{
+    TBCacheIndex idx;
+
+    if (tb_cflags(tb) & (CF_INVALID | CF_NOCACHE | CF_NOPERSIST)) {
+        return;
+    }
+    idx.tb_offset = (uint8_t *)tb - w->base;
+    idx.guest_offset = w->guest->len;
+    g_array_append_val(w->index, idx);
+    g_byte_array_append(w->guest, guest, tb->size);
+}
+
+static gboolean tb_cache_add_iter(gpointer key, gpointer value, gpointer data)
+{
+    TranslationBlock *tb = value;
+
+    if (page_check_range(tb->pc, tb->size, PAGE_READ) == 0) {
+        tb_cache_add(data, tb, g2h(tb->pc));
+    }
+    return false;
+}
+
+static void tb_cache_add_pending(gpointer key, gpointer value, gpointer data)
+{
+    TBCacheEntry *e;
+
+    for (e = value; e; e = e->next) {
+        if (tb_cache_check_tb(e->tb, e)) {
+            tb_cache_add(data, e->tb, e->guest);
+        }
+    }
+}
+
+static bool tb_cache_write(int fd, TBCacheWriter *w, uint8_t *end)
+{
+    TBCacheHeader hdr = tbc.id;
+    size_t page_size = qemu_real_host_page_size;
+    size_t pad;
+    void *zero;
+    bool ok;
+
+    hdr.n_tbs = w->index->len;
+    hdr.code_size = end - w->base;
+    hdr.index_offset = sizeof(hdr);
+    hdr.guest_offset = hdr.index_offset + w->index->len * sizeof(TBCacheIndex);
+    hdr.guest_size = w->guest->len;
+    hdr.code_offset = ROUND_UP(hdr.guest_offset + hdr.guest_size, page_size);
+    pad = hdr.code_offset - hdr.guest_offset - hdr.guest_size;
+
+    zero = g_malloc0(pad);
+    ok = qemu_write_full(fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+         qemu_write_full(fd, w->index->data,
+                         w->index->len * sizeof(TBCacheIndex)) ==
+         w->index->len * sizeof(TBCacheIndex) &&
+         qemu_write_full(fd, w->guest->data, w->guest->len) == w->guest->len &&
+         qemu_write_full(fd, zero, pad) == pad &&
+         qemu_write_full(fd, w->base, hdr.code_size) == hdr.code_size;
+    g_free(zero);
+    if (ok) {
+        trace_tb_cache_save(tbc.path, hdr.n_tbs, hdr.code_size, tbc.hits);
+    }
+    return ok;
+}
+
+/*
+ * Write the translated code to the cache file.  The file is replaced
+ * atomically, so that concurrent instances of the same binary do not see
+ * a partially written file.
+ *
+ * Called with mmap_lock and tb_lock held.
+ */
+static void tb_cache_do_save(void)
+{
+    TBCacheWriter w;
+    uint8_t *end;
+    char *tmp;
+    int fd;
+
+    end = tcg_ctx->code_gen_ptr;
+    if (end == tbc.saved_end) {
+        /* Nothing was translated that the file does not already have */
+        return;
+    }
+    if (!tb_cache_exec_sum()) {
+        return;
+    }
+
+    w.base = (uint8_t *)(uintptr_t)tbc.id.code_base;
+    w.index = g_array_new(FALSE, FALSE, sizeof(TBCacheIndex));
+    w.guest = g_byte_array_new();
+    g_tree_foreach(tb_ctx.tb_tree, tb_cache_add_iter, &w);
+    g_hash_table_foreach(tbc.pending, tb_cache_add_pending, &w);
+
+    tmp = g_strdup_printf("%s.XXXXXX", tbc.path);
+    fd = g_mkstemp(tmp);
+    if (fd >= 0) {
+        bool ok = tb_cache_write(fd, &w, end);
+
+        close(fd);
+        if (!ok || rename(tmp, tbc.path) < 0) {
+            unlink(tmp);
+        } else {
+            tbc.saved_end = end;
+        }
+    }
+    g_free(tmp);
+    g_array_free(w.index, TRUE);
+    g_byte_array_free(w.guest, TRUE);
+}
+
+/*
+ * Save the cache if it was last saved more than TB_CACHE_SAVE_INTERVAL
+ * ago, so that guests that are killed, or exec another program, keep
+ * what they translated.
+ *
+ * Called from tb_gen_code with mmap_lock and tb_lock held.
+ */
+void tb_cache_checkpoint(void)
+{
+    int64_t now;
+
+    if (!tbc.path) {
+        return;
+    }
+    now = get_clock();
+    if (now - tbc.saved_at >= TB_CACHE_SAVE_INTERVAL) {
+        tbc.saved_at = now;
+        tb_cache_do_save();
+    }
+}
+
+/* Called when the guest process exits.  */
+void tb_cache_save(void)
+{
+    if (!tbc.path) {
+        return;
+    }
+
+    mmap_lock();
+    tb_lock();
+    tb_cache_do_save();
+    tb_unlock();
+    mmap_unlock();
+}
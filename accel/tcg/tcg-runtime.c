@@ -144,23 +144,91 @@ uint64_t HELPER(ctpop_i64)(uint64_t arg)
     return ctpop64(arg);
 }
 
+static void *tb_ptr_chain(CPUState *cpu, TranslationBlock *tb,
+                          target_ulong pc, target_ulong cs_base,
+                          uint32_t flags)
+{
+    qemu_log_mask_and_addr(CPU_LOG_EXEC, pc,
+                           "Chain %d: %p ["
+                           TARGET_FMT_lx "/" TARGET_FMT_lx "/%#x] %s\n",
+                           cpu->cpu_index, tb->tc.ptr, cs_base, pc, flags,
+                           lookup_symbol(pc));
+    return tb->tc.ptr;
+}
+
+/*
+ * Most indirect branches, and all direct branches that cross a page,
+ * keep going to the same TB.  Each such branch site first checks the
+ * TB it jumped to last time, before doing a full lookup.
+ */
 void *HELPER(lookup_tb_ptr)(CPUArchState *env)
 {
     CPUState *cpu = ENV_GET_CPU(env);
     TranslationBlock *tb;
     target_ulong cs_base, pc;
-    uint32_t flags;
+    uint32_t flags, cf_mask = curr_cflags();
+    unsigned int site = tb_ibtc_hash_func(GETPC());
+
+    cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
+    tb = atomic_read(&cpu->tb_ibtc[site]);
+    if (likely(tb && tb_lookup_cmp(cpu, tb, pc, cs_base, flags, cf_mask))) {
+        atomic_set(&cpu->tb_ibtc_hits, cpu->tb_ibtc_hits + 1);
+        return tb_ptr_chain(cpu, tb, pc, cs_base, flags);
+    }
 
-    tb = tb_lookup__cpu_state(cpu, &pc, &cs_base, &flags, curr_cflags());
+    atomic_set(&cpu->tb_ibtc_misses, cpu->tb_ibtc_misses + 1);
+    tb = tb_lookup(cpu, pc, cs_base, flags, cf_mask);
     if (tb == NULL) {
         return tcg_ctx->code_gen_epilogue;
     }
-    qemu_log_mask_and_addr(CPU_LOG_EXEC, pc,
-                           "Chain %d: %p ["
-                           TARGET_FMT_lx "/" TARGET_FMT_lx "/%#x] %s\n",
-                           cpu->cpu_index, tb->tc.ptr, cs_base, pc, flags,
-                           lookup_symbol(pc));
-    return tb->tc.ptr;
+    atomic_set(&cpu->tb_ibtc[site], tb);
+    return tb_ptr_chain(cpu, tb, pc, cs_base, flags);
+}
+
+/*
+ * Returns are predicted with a per-vCPU stack of the TBs following
+ * the guest's calls.  The stack wraps around, so deep recursion only
+ * loses the oldest predictions.
+ */
+void *HELPER(lookup_tb_ptr_ret)(CPUArchState *env)
+{
+    CPUState *cpu = ENV_GET_CPU(env);
+    TranslationBlock *tb;
+    target_ulong cs_base, pc;
+    uint32_t flags, cf_mask = curr_cflags();
+    unsigned int top = --cpu->tb_ras_top & (TB_RAS_SIZE - 1);
+
+    cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
+    tb = atomic_read(&cpu->tb_ras[top]);
+    if (likely(tb && tb_lookup_cmp(cpu, tb, pc, cs_base, flags, cf_mask))) {
+        atomic_set(&cpu->tb_ras_hits, cpu->tb_ras_hits + 1);
+        return tb_ptr_chain(cpu, tb, pc, cs_base, flags);
+    }
+
+    atomic_set(&cpu->tb_ras_misses, cpu->tb_ras_misses + 1);
+    tb = tb_lookup(cpu, pc, cs_base, flags, cf_mask);
+    if (tb == NULL) {
+        return tcg_ctx->code_gen_epilogue;
+    }
+    return tb_ptr_chain(cpu, tb, pc, cs_base, flags);
+}
+
+/*
+ * @ret_pc is the pc of the return address, as cpu_get_tb_cpu_state()
+ * will compute it.  Its TB is looked up now in the jump cache only;
+ * if it is not there yet, the return will be mispredicted once.
+ */
+void HELPER(ras_push)(CPUArchState *env, target_ulong ret_pc)
+{
+    CPUState *cpu = ENV_GET_CPU(env);
+    unsigned int top = cpu->tb_ras_top++ & (TB_RAS_SIZE - 1);
+    TranslationBlock *tb;
+
+    tb = atomic_rcu_read(&cpu->tb_jmp_cache[tb_jmp_cache_hash_func(ret_pc)]);
+    if (tb && tb->pc != ret_pc) {
+        tb = NULL;
+    }
+    atomic_set(&cpu->tb_ras[top], tb);
 }
 
 void HELPER(exit_atomic)(CPUArchState *env)
@@ -51,6 +51,7 @@
 
 #include "exec/cputlb.h"
 #include "exec/tb-hash.h"
+#include "exec/tb-cache.h"
 #include "translate-all.h"
 #include "qemu/bitmap.h"
 #include "qemu/error-report.h"
@@ -110,7 +111,8 @@ typedef struct PageDesc {
     unsigned int code_write_count;
     unsigned long *code_bitmap;
 #else
-    unsigned long flags;
+    /* the host page was made read-only to catch writes to its code */
+    bool write_protected;
 #endif
 } PageDesc;
 
@@ -511,6 +513,195 @@ static inline PageDesc *page_find(tb_page_addr_t index)
     return page_find_alloc(index, 0);
 }
 
+#ifdef CONFIG_USER_ONLY
+/*
+ * The page flags of user-mode emulation are kept in a sorted array of
+ * disjoint address ranges whose pages all have the same flags; unmapped
+ * pages are not stored.  Readers look the array up under rcu_read_lock()
+ * and do not need mmap_lock.  Writers hold mmap_lock.  When the flags of
+ * a whole range change they are updated in place, otherwise a new copy
+ * of the array is published, so that the cost of an update depends on
+ * the number of mappings rather than on their size.
+ *
+ * The array holds the flags set by page_set_flags().  Pages whose host
+ * page was made read-only because it contains translated code are marked
+ * in their PageDesc instead, so that translating code and handling writes
+ * to it never change the array.
+ */
+typedef struct PageFlagsRange {
+    target_ulong start;
+    target_ulong last;
+    int flags;
+} PageFlagsRange;
+
+typedef struct PageFlagsMap {
+    struct rcu_head rcu;
+    unsigned nr;
+    PageFlagsRange range[];
+} PageFlagsMap;
+
+static PageFlagsMap page_flags_empty;
+static PageFlagsMap *page_flags_map = &page_flags_empty;
+
+/* Return the index of the first range of @map that ends at or after @addr */
+static unsigned page_flags_lower_bound(PageFlagsMap *map, target_ulong addr)
+{
+    unsigned lo = 0, hi = map->nr;
+
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+
+        if (map->range[mid].last < addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Return the range of @map that contains @addr, or NULL */
+static PageFlagsRange *page_flags_find(PageFlagsMap *map, target_ulong addr)
+{
+    unsigned i = page_flags_lower_bound(map, addr);
+
+    if (i < map->nr && map->range[i].start <= addr) {
+        return &map->range[i];
+    }
+    return NULL;
+}
+
+/* Return the union of the flags of the pages in [start, last] */
+static int page_flags_union(target_ulong start, target_ulong last)
+{
+    PageFlagsMap *map;
+    unsigned i;
+    int flags = 0;
+
+    rcu_read_lock();
+    map = atomic_rcu_read(&page_flags_map);
+    for (i = page_flags_lower_bound(map, start);
+         i < map->nr && map->range[i].start <= last; i++) {
+        flags |= atomic_read(&map->range[i].flags);
+    }
+    rcu_read_unlock();
+    return flags;
+}
+
+static void page_flags_emit(PageFlagsMap *map, target_ulong start,
+                            target_ulong last, int flags)
+{
+    PageFlagsRange *prev = map->nr ? &map->range[map->nr - 1] : NULL;
+
+    if (!flags) {
+        return;
+    }
+    if (prev && prev->flags == flags && prev->last + 1 == start) {
+        prev->last = last;
+        return;
+    }
+    map->range[map->nr].start = start;
+    map->range[map->nr].last = last;
+    map->range[map->nr].flags = flags;
+    map->nr++;
+}
+
+/*
+ * Set the flags of the pages in [start, last] to @flags.
+ *
+ * Called with mmap_lock held.
+ */
+static void page_flags_update(target_ulong start, target_ulong last,
+                              int flags)
+{
+    PageFlagsMap *old = page_flags_map;
+    PageFlagsMap *map;
+    PageFlagsRange *r;
+    bool done = false;
+    unsigned i;
+
+    assert_memory_lock();
+
+    /*
+     * If the pages are exactly one range, and it does not have to be
+     * merged with a neighbour, readers can just see the new flags.
+     */
+    i = page_flags_lower_bound(old, start);
+    r = &old->range[i];
+    if (flags && i < old->nr && r->start == start && r->last == last &&
+        (i == 0 || r[-1].flags != flags || r[-1].last + 1 != start) &&
+        (i + 1 == old->nr || r[1].flags != flags || r[1].start != last + 1)) {
+        atomic_set(&r->flags, flags);
+        return;
+    }
+
+    /* At most one old range is split at either end */
+    map = g_malloc(sizeof(*map) + (old->nr + 2) * sizeof(map->range[0]));
+    map->nr = 0;
+    for (i = 0; i < old->nr; i++) {
+        r = &old->range[i];
+        if (r->last < start) {
+            page_flags_emit(map, r->start, r->last, r->flags);
+            continue;
+        }
+        if (r->start > last) {
+            if (!done) {
+                page_flags_emit(map, start, last, flags);
+                done = true;
+            }
+            page_flags_emit(map, r->start, r->last, r->flags);
+            continue;
+        }
+
+        if (r->start < start) {
+            page_flags_emit(map, r->start, start - 1, r->flags);
+        }
+        if (!done) {
+            page_flags_emit(map, start, last, flags);
+            done = true;
+        }
+        if (r->last > last) {
+            page_flags_emit(map, last + 1, r->last, r->flags);
+        }
+    }
+    if (!done) {
+        page_flags_emit(map, start, last, flags);
+    }
+
+    atomic_rcu_set(&page_flags_map, map);
+    if (old != &page_flags_empty) {
+        g_free_rcu(old, rcu);
+    }
+}
+
+/*
+ * Return the PageDesc of the first page in [*addr, last] that holds
+ * translated code or is write-protected because of it, and store its
+ * address in *@addr.  Return NULL if there is none.
+ */
+static PageDesc *page_find_code(target_ulong *addr, target_ulong last)
+{
+    tb_page_addr_t index = *addr >> TARGET_PAGE_BITS;
+    tb_page_addr_t last_index = last >> TARGET_PAGE_BITS;
+
+    while (index <= last_index) {
+        PageDesc *p = page_find(index);
+
+        if (!p) {
+            /* No page of this leaf of l1_map ever held code */
+            index = (index | (V_L2_SIZE - 1)) + 1;
+            continue;
+        }
+        if (atomic_read(&p->first_tb) || atomic_read(&p->write_protected)) {
+            *addr = (target_ulong)index << TARGET_PAGE_BITS;
+            return p;
+        }
+        index++;
+    }
+    return NULL;
+}
+#endif
+
 #if defined(CONFIG_USER_ONLY)
 /* Currently it is not recommended to allocate big chunks of data in
    user mode. It will change when a dedicated libc will be used.  */
@@ -918,6 +1109,7 @@ static void do_tb_flush(CPUState *cpu, run_on_cpu_data tb_flush_count)
 
     qht_reset_size(&tb_ctx.htable, CODE_GEN_HTABLE_SIZE);
     page_flush_tb();
+    tb_cache_flush();
 
     tcg_region_reset_all();
     /* XXX: flush processor icache at this point if cache flush is
@@ -1173,25 +1365,21 @@ static inline void tb_alloc_page(TranslationBlock *tb,
     invalidate_page_bitmap(p);
 
 #if defined(CONFIG_USER_ONLY)
-    if (p->flags & PAGE_WRITE) {
+    if (page_get_flags(page_addr) & PAGE_WRITE) {
         target_ulong addr;
-        PageDesc *p2;
         int prot;
 
         /* force the host page as non writable (writes will have a
            page fault + mprotect overhead) */
         page_addr &= qemu_host_page_mask;
-        prot = 0;
+        prot = page_flags_union(page_addr,
+                                page_addr + qemu_host_page_size - 1);
         for (addr = page_addr; addr < page_addr + qemu_host_page_size;
-            addr += TARGET_PAGE_SIZE) {
+             addr += TARGET_PAGE_SIZE) {
+            PageDesc *p2 = page_find_alloc(addr >> TARGET_PAGE_BITS, 1);
 
-            p2 = page_find(addr >> TARGET_PAGE_BITS);
-            if (!p2) {
-                continue;
-            }
-            prot |= p2->flags;
-            p2->flags &= ~PAGE_WRITE;
-          }
+            atomic_set(&p2->write_protected, true);
+        }
         mprotect(g2h(page_addr), qemu_host_page_size,
                  (prot & PAGE_BITS) & ~PAGE_WRITE);
         if (DEBUG_TB_INVALIDATE_GATE) {
@@ -1259,6 +1447,14 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
 
     phys_pc = get_page_addr_code(env, pc);
 
+    if (!(cflags & CF_NOCACHE)) {
+        tb = tb_cache_lookup(cpu, pc, cs_base, flags, cflags);
+        if (tb) {
+            return tb;
+        }
+    }
+    tb_cache_checkpoint();
+
  buffer_overflow:
     tb = tb_alloc(pc);
     if (unlikely(!tb)) {
@@ -1290,6 +1486,9 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     tcg_ctx->cpu = ENV_GET_CPU(env);
     gen_intermediate_code(cpu, tb);
     tcg_ctx->cpu = NULL;
+    if (tcg_ctx->tb_nopersist) {
+        tb->cflags |= CF_NOPERSIST;
+    }
 
     trace_translate_block(tb, tb->pc, tb->tc.ptr);
 
@@ -1399,6 +1598,89 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     return tb;
 }
 
+#ifdef CONFIG_USER_ONLY
+/*
+ * Make @tb, which was loaded from the persistent translation cache and
+ * checked against guest memory, visible to the execution loop.  Jumps
+ * that were chained when the cache was written are reset.
+ *
+ * Called with mmap_lock and tb_lock held.
+ */
+void tb_link_cached(TranslationBlock *tb, tb_page_addr_t phys_pc,
+                    tb_page_addr_t phys_page2)
+{
+    tb->jmp_list_first = (uintptr_t)tb | 2;
+    tb->jmp_list_next[0] = (uintptr_t)NULL;
+    tb->jmp_list_next[1] = (uintptr_t)NULL;
+    if (tb->jmp_reset_offset[0] != TB_JMP_RESET_OFFSET_INVALID) {
+        tb_reset_jump(tb, 0);
+    }
+    if (tb->jmp_reset_offset[1] != TB_JMP_RESET_OFFSET_INVALID) {
+        tb_reset_jump(tb, 1);
+    }
+
+    tb_link_page(tb, phys_pc, phys_page2);
+    g_tree_insert(tb_ctx.tb_tree, &tb->tc, tb);
+}
+
+/* As decode_sleb128, but fail instead of reading at or past @end.  */
+static bool decode_sleb128_checked(const uint8_t **pp, const uint8_t *end,
+                                   target_long *pval)
+{
+    const uint8_t *p = *pp;
+    target_long val = 0;
+    int byte, shift = 0;
+
+    do {
+        if (p >= end || shift >= TARGET_LONG_BITS + 7) {
+            return false;
+        }
+        byte = *p++;
+        if (shift < TARGET_LONG_BITS) {
+            val |= (target_ulong)(byte & 0x7f) << shift;
+        }
+        shift += 7;
+    } while (byte & 0x80);
+    if (shift < TARGET_LONG_BITS && (byte & 0x40)) {
+        val |= -(target_ulong)1 << shift;
+    }
+
+    *pp = p;
+    *pval = val;
+    return true;
+}
+
+/*
+ * Check that the search data that follows the host code of @tb, which
+ * was loaded from the persistent translation cache, ends before @end and
+ * only refers to host code within the TB, so that cpu_restore_state()
+ * can use it safely.
+ */
+bool tb_search_data_valid(TranslationBlock *tb, const uint8_t *end)
+{
+    const uint8_t *p = tb->tc.ptr + tb->tc.size;
+    target_ulong host_off = 0;
+    target_long val;
+    int i, j;
+
+    for (i = 0; i < tb->icount; ++i) {
+        for (j = 0; j < TARGET_INSN_START_WORDS; ++j) {
+            if (!decode_sleb128_checked(&p, end, &val)) {
+                return false;
+            }
+        }
+        if (!decode_sleb128_checked(&p, end, &val) || val < 0) {
+            return false;
+        }
+        host_off += val;
+        if (host_off > tb->tc.size) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
 /*
  * Invalidate all TBs which intersect with the target physical address range
  * [start;end[. NOTE: start and end may refer to *different* physical pages.
@@ -1799,12 +2081,38 @@ static void tb_jmp_cache_clear_page(CPUState *cpu, target_ulong page_addr)
     }
 }
 
+static inline void tb_ibtc_clear_entry(TranslationBlock **ptb,
+                                       target_ulong page_addr)
+{
+    TranslationBlock *tb = atomic_read(ptb);
+
+    /* Same pages as the jump cache: TBs starting on this page or on the
+       previous one, which may extend into it.  */
+    if (tb && ((tb->pc & TARGET_PAGE_MASK) == page_addr ||
+               (tb->pc & TARGET_PAGE_MASK) == page_addr - TARGET_PAGE_SIZE)) {
+        atomic_set(ptb, NULL);
+    }
+}
+
+static void tb_ibtc_clear_page(CPUState *cpu, target_ulong page_addr)
+{
+    unsigned int i;
+
+    for (i = 0; i < TB_IBTC_SIZE; i++) {
+        tb_ibtc_clear_entry(&cpu->tb_ibtc[i], page_addr);
+    }
+    for (i = 0; i < TB_RAS_SIZE; i++) {
+        tb_ibtc_clear_entry(&cpu->tb_ras[i], page_addr);
+    }
+}
+
 void tb_flush_jmp_cache(CPUState *cpu, target_ulong addr)
 {
     /* Discard jump cache entries for any tb which might potentially
        overlap the flushed page.  */
     tb_jmp_cache_clear_page(cpu, addr - TARGET_PAGE_SIZE);
     tb_jmp_cache_clear_page(cpu, addr);
+    tb_ibtc_clear_page(cpu, addr & TARGET_PAGE_MASK);
 }
 
 static void print_qht_statistics(FILE *f, fprintf_function cpu_fprintf,
@@ -1876,6 +2184,28 @@ static gboolean tb_tree_stats_iter(gpointer key, gpointer value, gpointer data)
     return false;
 }
 
+static void print_ib_statistics(FILE *f, fprintf_function cpu_fprintf)
+{
+    unsigned long ibtc_hits = 0, ibtc_misses = 0;
+    unsigned long ras_hits = 0, ras_misses = 0;
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        ibtc_hits += atomic_read(&cpu->tb_ibtc_hits);
+        ibtc_misses += atomic_read(&cpu->tb_ibtc_misses);
+        ras_hits += atomic_read(&cpu->tb_ras_hits);
+        ras_misses += atomic_read(&cpu->tb_ras_misses);
+    }
+    cpu_fprintf(f, "indirect jump cache %lu hits %lu misses (%lu%% hit rate)\n",
+                ibtc_hits, ibtc_misses,
+                ibtc_hits + ibtc_misses ?
+                ibtc_hits * 100 / (ibtc_hits + ibtc_misses) : 0);
+    cpu_fprintf(f, "return predictions  %lu hits %lu misses (%lu%% hit rate)\n",
+                ras_hits, ras_misses,
+                ras_hits + ras_misses ?
+                ras_hits * 100 / (ras_hits + ras_misses) : 0);
+}
+
 void dump_exec_info(FILE *f, fprintf_function cpu_fprintf)
 {
     struct tb_tree_stats tst = {};
@@ -1919,6 +2249,7 @@ void dump_exec_info(FILE *f, fprintf_function cpu_fprintf)
                 atomic_read(&tb_ctx.tb_flush_count));
     cpu_fprintf(f, "TB invalidate count %d\n", tb_ctx.tb_phys_invalidate_count);
     cpu_fprintf(f, "TLB flush count     %zu\n", tlb_flush_count());
+    print_ib_statistics(f, cpu_fprintf);
     tcg_dump_info(f, cpu_fprintf);
 
     tb_unlock();
@@ -1942,88 +2273,24 @@ void cpu_interrupt(CPUState *cpu, int mask)
  * Walks guest process memory "regions" one by one
  * and calls callback function 'fn' for each region.
  */
-struct walk_memory_regions_data {
-    walk_memory_regions_fn fn;
-    void *priv;
-    target_ulong start;
-    int prot;
-};
-
-static int walk_memory_regions_end(struct walk_memory_regions_data *data,
-                                   target_ulong end, int new_prot)
-{
-    if (data->start != -1u) {
-        int rc = data->fn(data->priv, data->start, end, data->prot);
-        if (rc != 0) {
-            return rc;
-        }
-    }
-
-    data->start = (new_prot ? end : -1u);
-    data->prot = new_prot;
-
-    return 0;
-}
-
-static int walk_memory_regions_1(struct walk_memory_regions_data *data,
-                                 target_ulong base, int level, void **lp)
-{
-    target_ulong pa;
-    int i, rc;
-
-    if (*lp == NULL) {
-        return walk_memory_regions_end(data, base, 0);
-    }
-
-    if (level == 0) {
-        PageDesc *pd = *lp;
-
-        for (i = 0; i < V_L2_SIZE; ++i) {
-            int prot = pd[i].flags;
-
-            pa = base | (i << TARGET_PAGE_BITS);
-            if (prot != data->prot) {
-                rc = walk_memory_regions_end(data, pa, prot);
-                if (rc != 0) {
-                    return rc;
-                }
-            }
-        }
-    } else {
-        void **pp = *lp;
-
-        for (i = 0; i < V_L2_SIZE; ++i) {
-            pa = base | ((target_ulong)i <<
-                (TARGET_PAGE_BITS + V_L2_BITS * level));
-            rc = walk_memory_regions_1(data, pa, level - 1, pp + i);
-            if (rc != 0) {
-                return rc;
-            }
-        }
-    }
-
-    return 0;
-}
-
 int walk_memory_regions(void *priv, walk_memory_regions_fn fn)
 {
-    struct walk_memory_regions_data data;
-    uintptr_t i, l1_sz = v_l1_size;
+    PageFlagsMap *map;
+    unsigned i;
+    int rc = 0;
 
-    data.fn = fn;
-    data.priv = priv;
-    data.start = -1u;
-    data.prot = 0;
+    rcu_read_lock();
+    map = atomic_rcu_read(&page_flags_map);
+    for (i = 0; i < map->nr; i++) {
+        PageFlagsRange *r = &map->range[i];
 
-    for (i = 0; i < l1_sz; i++) {
-        target_ulong base = i << (v_l1_shift + TARGET_PAGE_BITS);
-        int rc = walk_memory_regions_1(&data, base, v_l2_levels, l1_map + i);
+        rc = fn(priv, r->start, r->last + 1, atomic_read(&r->flags));
         if (rc != 0) {
-            return rc;
+            break;
         }
     }
-
-    return walk_memory_regions_end(&data, 0, 0);
+    rcu_read_unlock();
+    return rc;
 }
 
 static int dump_region(void *priv, target_ulong start,
@@ -2052,13 +2319,24 @@ void page_dump(FILE *f)
 
 int page_get_flags(target_ulong address)
 {
-    PageDesc *p;
+    PageFlagsRange *r;
+    int flags = 0;
 
-    p = page_find(address >> TARGET_PAGE_BITS);
-    if (!p) {
-        return 0;
+    rcu_read_lock();
+    r = page_flags_find(atomic_rcu_read(&page_flags_map), address);
+    if (r) {
+        flags = atomic_read(&r->flags);
+    }
+    rcu_read_unlock();
+
+    if (flags & PAGE_WRITE) {
+        PageDesc *p = page_find(address >> TARGET_PAGE_BITS);
+
+        if (p && atomic_read(&p->write_protected)) {
+            flags &= ~PAGE_WRITE;
+        }
     }
-    return p->flags;
+    return flags;
 }
 
 /* Modify the flags of a page and invalidate the code if necessary.
@@ -2066,7 +2344,8 @@ int page_get_flags(target_ulong address)
    on PAGE_WRITE.  The mmap_lock should already be held.  */
 void page_set_flags(target_ulong start, target_ulong end, int flags)
 {
-    target_ulong addr, len;
+    target_ulong addr, last;
+    PageDesc *p;
 
     /* This function should never be called with addresses outside the
        guest address space.  If this assert fires, it probably indicates
@@ -2084,27 +2363,34 @@ void page_set_flags(target_ulong start, target_ulong end, int flags)
         flags |= PAGE_WRITE_ORG;
     }
 
-    for (addr = start, len = end - start;
-         len != 0;
-         len -= TARGET_PAGE_SIZE, addr += TARGET_PAGE_SIZE) {
-        PageDesc *p = page_find_alloc(addr >> TARGET_PAGE_BITS, 1);
+    last = end - 1;
 
-        /* If the write protection bit is set, then we invalidate
-           the code inside.  */
-        if (!(p->flags & PAGE_WRITE) &&
-            (flags & PAGE_WRITE) &&
-            p->first_tb) {
+    /* If the write protection bit is set, then we invalidate
+       the code inside.  */
+    for (addr = start; (p = page_find_code(&addr, last)) != NULL;
+         addr += TARGET_PAGE_SIZE) {
+        if ((flags & PAGE_WRITE) && p->first_tb &&
+            !(page_get_flags(addr) & PAGE_WRITE)) {
             tb_invalidate_phys_page(addr, 0);
         }
-        p->flags = flags;
+        atomic_set(&p->write_protected, false);
+        if (addr + TARGET_PAGE_SIZE - 1 >= last) {
+            break;
+        }
     }
+
+    page_flags_update(start, last, flags);
 }
 
 int page_check_range(target_ulong start, target_ulong len, int flags)
 {
+    PageFlagsMap *map;
+    PageFlagsRange *r;
     PageDesc *p;
-    target_ulong end;
+    target_ulong last;
     target_ulong addr;
+    int ret = 0;
+    int rflags;
 
     /* This function should never be called with addresses outside the
        guest address space.  If this assert fires, it probably indicates
@@ -2122,37 +2408,53 @@ int page_check_range(target_ulong start, target_ulong len, int flags)
     }
 
     /* must do before we loose bits in the next step */
-    end = TARGET_PAGE_ALIGN(start + len);
+    last = (start + len - 1) | ~TARGET_PAGE_MASK;
     start = start & TARGET_PAGE_MASK;
 
-    for (addr = start, len = end - start;
-         len != 0;
-         len -= TARGET_PAGE_SIZE, addr += TARGET_PAGE_SIZE) {
-        p = page_find(addr >> TARGET_PAGE_BITS);
-        if (!p) {
-            return -1;
-        }
-        if (!(p->flags & PAGE_VALID)) {
-            return -1;
+    rcu_read_lock();
+    map = atomic_rcu_read(&page_flags_map);
+    for (addr = start; ; addr = r->last + 1) {
+        r = page_flags_find(map, addr);
+        rflags = r ? atomic_read(&r->flags) : 0;
+        if (!(rflags & PAGE_VALID)) {
+            ret = -1;
+            break;
         }
 
-        if ((flags & PAGE_READ) && !(p->flags & PAGE_READ)) {
-            return -1;
+        if ((flags & PAGE_READ) && !(rflags & PAGE_READ)) {
+            ret = -1;
+            break;
         }
         if (flags & PAGE_WRITE) {
-            if (!(p->flags & PAGE_WRITE_ORG)) {
-                return -1;
+            target_ulong page, hi = MIN(r->last, last);
+
+            if (!(rflags & PAGE_WRITE_ORG)) {
+                ret = -1;
+                break;
             }
-            /* unprotect the page if it was put read-only because it
-               contains translated code */
-            if (!(p->flags & PAGE_WRITE)) {
-                if (!page_unprotect(addr, 0)) {
-                    return -1;
+            /* unprotect the pages if they were put read-only because
+               they contain translated code */
+            for (page = addr; (p = page_find_code(&page, hi)) != NULL;
+                 page += TARGET_PAGE_SIZE) {
+                if (atomic_read(&p->write_protected) &&
+                    !page_unprotect(page, 0)) {
+                    ret = -1;
+                    break;
+                }
+                if (page + TARGET_PAGE_SIZE - 1 >= hi) {
+                    break;
                 }
             }
+            if (ret) {
+                break;
+            }
+        }
+        if (r->last >= last) {
+            break;
         }
     }
-    return 0;
+    rcu_read_unlock();
+    return ret;
 }
 
 /* called from signal handler: invalidate the code and unprotect the
@@ -2165,7 +2467,7 @@ int page_unprotect(target_ulong address, uintptr_t pc)
 {
     unsigned int prot;
     bool current_tb_invalidated;
-    PageDesc *p;
+    int flags;
     target_ulong host_start, host_end, addr;
 
     /* Technically this isn't safe inside a signal handler.  However we
@@ -2173,17 +2475,13 @@ int page_unprotect(target_ulong address, uintptr_t pc)
        practice it seems to be ok.  */
     mmap_lock();
 
-    p = page_find(address >> TARGET_PAGE_BITS);
-    if (!p) {
-        mmap_unlock();
-        return 0;
-    }
+    flags = page_get_flags(address);
 
     /* if the page was really writable, then we change its
        protection back to writable */
-    if (p->flags & PAGE_WRITE_ORG) {
+    if (flags & PAGE_WRITE_ORG) {
         current_tb_invalidated = false;
-        if (p->flags & PAGE_WRITE) {
+        if (flags & PAGE_WRITE) {
             /* If the page is actually marked WRITE then assume this is because
              * this thread raced with another one which got here first and
              * set the page to PAGE_WRITE and did the TB invalidate for us.
@@ -2198,12 +2496,15 @@ int page_unprotect(target_ulong address, uintptr_t pc)
             host_start = address & qemu_host_page_mask;
             host_end = host_start + qemu_host_page_size;
 
-            prot = 0;
             for (addr = host_start; addr < host_end; addr += TARGET_PAGE_SIZE) {
-                p = page_find(addr >> TARGET_PAGE_BITS);
-                p->flags |= PAGE_WRITE;
-                prot |= p->flags;
+                PageDesc *p = page_find(addr >> TARGET_PAGE_BITS);
 
+                if (p) {
+                    atomic_set(&p->write_protected, false);
+                }
+            }
+            prot = page_flags_union(host_start, host_end - 1);
+            for (addr = host_start; addr < host_end; addr += TARGET_PAGE_SIZE) {
                 /* and since the content will be modified, we must invalidate
                    the corresponding translated code. */
                 current_tb_invalidated |= tb_invalidate_phys_page(addr, pc);
@@ -31,6 +31,9 @@ void tb_check_watchpoint(CPUState *cpu);
 
 #ifdef CONFIG_USER_ONLY
 int page_unprotect(target_ulong address, uintptr_t pc);
+void tb_link_cached(TranslationBlock *tb, tb_page_addr_t phys_pc,
+                    tb_page_addr_t phys_page2);
+bool tb_search_data_valid(TranslationBlock *tb, const uint8_t *end);
 #endif
 
 #endif /* TRANSLATE_ALL_H */
@@ -415,7 +415,9 @@ static void throttle_group_restart_queue(ThrottleGroupMember *tgm, bool is_write
     rd->tgm = tgm;
     rd->is_write = is_write;
 
-    co = qemu_coroutine_create(throttle_group_restart_queue_entry, rd);
+    /* The queued requests run on their own stacks once woken up */
+    co = qemu_coroutine_create_with_stack(throttle_group_restart_queue_entry,
+                                          rd, 64 * 1024);
     aio_co_enter(tgm->aio_context, co);
 }
 
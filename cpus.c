@@ -224,6 +224,19 @@ void qemu_tcg_configure(QemuOpts *opts, Error **errp)
     } else {
         mttcg_enabled = default_mttcg_enabled();
     }
+
+#ifdef CONFIG_TCG
+    t = qemu_opt_get(opts, "regalloc");
+    if (t) {
+        if (strcmp(t, "greedy") == 0) {
+            tcg_regalloc_mode = TCG_REGALLOC_GREEDY;
+        } else if (strcmp(t, "spill-cost") == 0) {
+            tcg_regalloc_mode = TCG_REGALLOC_SPILL_COST;
+        } else {
+            error_setg(errp, "Invalid 'regalloc' setting %s", t);
+        }
+    }
+#endif
 }
 
 /* The current number of executed instructions is based on what we
@@ -710,19 +723,31 @@ static const VMStateDescription vmstate_timers = {
     }
 };
 
+static int cpu_throttle_effective_percentage(CPUState *cpu)
+{
+    return MAX(cpu_throttle_get_percentage(),
+               cpu_throttle_get_vcpu_percentage(cpu));
+}
+
 static void cpu_throttle_thread(CPUState *cpu, run_on_cpu_data opaque)
 {
     double pct;
-    double throttle_ratio;
+    double period_pct;
     long sleeptime_ns;
 
-    if (!cpu_throttle_get_percentage()) {
+    pct = (double)cpu_throttle_effective_percentage(cpu)/100;
+    period_pct = (double)opaque.host_int/100;
+    if (!pct) {
+        atomic_set(&cpu->throttle_thread_scheduled, 0);
         return;
     }
 
-    pct = (double)cpu_throttle_get_percentage()/100;
-    throttle_ratio = pct / (1 - pct);
-    sleeptime_ns = (long)(throttle_ratio * CPU_THROTTLE_TIMESLICE_NS);
+    /* The timer period is sized for the most throttled vcpu; sleep
+     * for our share of it.  With a single percentage this is
+     * pct / (1 - pct) timeslices, as before.
+     */
+    period_pct = MAX(period_pct, pct);
+    sleeptime_ns = (long)(pct * CPU_THROTTLE_TIMESLICE_NS / (1 - period_pct));
 
     qemu_mutex_unlock_iothread();
     g_usleep(sleeptime_ns / 1000); /* Convert ns to us for usleep call */
@@ -733,20 +758,28 @@ static void cpu_throttle_thread(CPUState *cpu, run_on_cpu_data opaque)
 static void cpu_throttle_timer_tick(void *opaque)
 {
     CPUState *cpu;
+    int max_pct = 0;
     double pct;
 
+    CPU_FOREACH(cpu) {
+        max_pct = MAX(max_pct, cpu_throttle_effective_percentage(cpu));
+    }
+
     /* Stop the timer if needed */
-    if (!cpu_throttle_get_percentage()) {
+    if (!max_pct) {
         return;
     }
     CPU_FOREACH(cpu) {
+        if (!cpu_throttle_effective_percentage(cpu)) {
+            continue;
+        }
         if (!atomic_xchg(&cpu->throttle_thread_scheduled, 1)) {
             async_run_on_cpu(cpu, cpu_throttle_thread,
-                             RUN_ON_CPU_NULL);
+                             RUN_ON_CPU_HOST_INT(max_pct));
         }
     }
 
-    pct = (double)cpu_throttle_get_percentage()/100;
+    pct = (double)max_pct/100;
     timer_mod(throttle_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
                                    CPU_THROTTLE_TIMESLICE_NS / (1-pct));
 }
@@ -778,6 +811,34 @@ int cpu_throttle_get_percentage(void)
     return atomic_read(&throttle_percentage);
 }
 
+void cpu_throttle_set_vcpu(CPUState *cpu, int new_throttle_pct)
+{
+    if (new_throttle_pct) {
+        new_throttle_pct = MIN(new_throttle_pct, CPU_THROTTLE_PCT_MAX);
+        new_throttle_pct = MAX(new_throttle_pct, CPU_THROTTLE_PCT_MIN);
+    }
+
+    atomic_set(&cpu->throttle_percentage, new_throttle_pct);
+
+    if (new_throttle_pct && !timer_pending(throttle_timer)) {
+        timer_mod(throttle_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL_RT) +
+                                           CPU_THROTTLE_TIMESLICE_NS);
+    }
+}
+
+int cpu_throttle_get_vcpu_percentage(CPUState *cpu)
+{
+    return atomic_read(&cpu->throttle_percentage);
+}
+
+bool cpu_dirty_accounting_enabled(void)
+{
+    /* TCG sees the first write to each clean page in notdirty_mem_write,
+     * KVM reports dirty pages in per-vcpu rings.
+     */
+    return tcg_enabled() || kvm_dirty_ring_enabled();
+}
+
 void cpu_ticks_init(void)
 {
     seqlock_init(&timers_state.vm_clock_seqlock);
@@ -188,6 +188,8 @@ typedef struct PhysPageMap {
 
 struct AddressSpaceDispatch {
     MemoryRegionSection *mru_section;
+    /* Unique for the lifetime of QEMU, tags the section cache entries */
+    uint64_t generation;
     /* This is a multi-level map on the physical address space.
      * The bottom level has pointers to MemoryRegionSections.
      */
@@ -214,6 +216,28 @@ static void tcg_commit(MemoryListener *listener);
 
 static MemoryRegion io_mem_watch;
 
+/* Each thread keeps a small direct-mapped cache of phys_page_find results,
+ * so that devices polling a handful of MMIO or PIO pages do not walk the
+ * radix tree on every access.  Entries are tagged with the generation of
+ * the AddressSpaceDispatch they came from.  Generations are never reused,
+ * so publishing a new FlatView invalidates every entry that points into
+ * the old one without touching the other threads' caches.
+ */
+#define PHYS_SECTION_CACHE_BITS 4
+#define PHYS_SECTION_CACHE_SIZE (1 << PHYS_SECTION_CACHE_BITS)
+
+typedef struct PhysSectionCacheEntry {
+    uint64_t generation;
+    hwaddr index;
+    MemoryRegionSection *section;
+} PhysSectionCacheEntry;
+
+static __thread PhysSectionCacheEntry
+    phys_section_cache[PHYS_SECTION_CACHE_SIZE];
+
+/* Protected by the BQL; 0 is never used, so empty entries never match */
+static uint64_t dispatch_generation;
+
 /**
  * CPUAddressSpace: all the information a CPU needs about an AddressSpace
  * @cpu: the CPU whose AddressSpace this is
@@ -405,6 +429,25 @@ bool memory_region_is_unassigned(MemoryRegion *mr)
         && mr != &io_mem_watch;
 }
 
+/* Called from RCU critical section */
+static MemoryRegionSection *phys_page_find_cached(AddressSpaceDispatch *d,
+                                                  hwaddr addr)
+{
+    hwaddr index = addr >> TARGET_PAGE_BITS;
+    PhysSectionCacheEntry *e =
+        &phys_section_cache[index & (PHYS_SECTION_CACHE_SIZE - 1)];
+
+    if (e->generation == d->generation && e->index == index &&
+        section_covers_addr(e->section, addr)) {
+        return e->section;
+    }
+
+    e->generation = d->generation;
+    e->index = index;
+    e->section = phys_page_find(d, addr);
+    return e->section;
+}
+
 /* Called from RCU critical section */
 static MemoryRegionSection *address_space_lookup_region(AddressSpaceDispatch *d,
                                                         hwaddr addr,
@@ -415,7 +458,7 @@ static MemoryRegionSection *address_space_lookup_region(AddressSpaceDispatch *d,
 
     if (!section || section == &d->map.sections[PHYS_SECTION_UNASSIGNED] ||
         !section_covers_addr(section, addr)) {
-        section = phys_page_find(d, addr);
+        section = phys_page_find_cached(d, addr);
         atomic_set(&d->mru_section, section);
     }
     if (resolve_subpage && section->mr->subpage) {
@@ -2449,6 +2492,15 @@ void memory_notdirty_write_complete(NotDirtyInfo *ndi)
         tb_unlock();
     }
 
+    /* Charge the vcpu for pages it dirties under migration, so that
+     * only the vcpus that prevent convergence need to be throttled.
+     */
+    if (ndi->cpu &&
+        !cpu_physical_memory_get_dirty_flag(ndi->ram_addr,
+                                            DIRTY_MEMORY_MIGRATION)) {
+        cpu_dirty_pages_add(ndi->cpu, 1);
+    }
+
     /* Set both VGA and migration bits for simplicity and to remove
      * the notdirty callback faster.
      */
@@ -2863,6 +2915,7 @@ AddressSpaceDispatch *address_space_dispatch_new(FlatView *fv)
     assert(n == PHYS_SECTION_WATCH);
 
     d->phys_map  = (PhysPageEntry) { .ptr = PHYS_MAP_NODE_NIL, .skip = 1 };
+    d->generation = ++dispatch_generation;
 
     return d;
 }
@@ -3240,6 +3293,31 @@ MemTxResult address_space_write(AddressSpace *as, hwaddr addr,
     return result;
 }
 
+MemTxResult address_space_write_coalesced(AddressSpace *as, hwaddr addr,
+                                          const uint8_t *buf, int len)
+{
+    MemTxAttrs attrs = MEMTXATTRS_UNSPECIFIED;
+    MemTxResult result = MEMTX_OK;
+    FlatView *fv;
+    hwaddr l;
+    hwaddr addr1;
+    MemoryRegion *mr;
+
+    if (len > 0) {
+        rcu_read_lock();
+        fv = address_space_to_flatview(as);
+        l = len;
+        mr = flatview_translate(fv, addr, &addr1, &l, true);
+        /* Charge the region before the write can remap it */
+        mr->coalesced_writes++;
+        result = flatview_write_continue(fv, addr, attrs, buf, len,
+                                         addr1, l, mr);
+        rcu_read_unlock();
+    }
+
+    return result;
+}
+
 MemTxResult address_space_rw(AddressSpace *as, hwaddr addr, MemTxAttrs attrs,
                              uint8_t *buf, int len, bool is_write)
 {
@@ -83,6 +83,8 @@ this code that are retained.
  * target-dependent and needs the TARGET_* macros.
  */
 #include "qemu/osdep.h"
+#include <float.h>
+#include <math.h>
 #include "qemu/bitops.h"
 #include "fpu/softfloat.h"
 
@@ -738,8 +740,8 @@ float16  __attribute__((flatten)) float16_add(float16 a, float16 b,
     return float16_round_pack_canonical(pr, status);
 }
 
-float32 __attribute__((flatten)) float32_add(float32 a, float32 b,
-                                             float_status *status)
+static float32 __attribute__((flatten, noinline))
+soft_float32_add(float32 a, float32 b, float_status *status)
 {
     FloatParts pa = float32_unpack_canonical(a, status);
     FloatParts pb = float32_unpack_canonical(b, status);
@@ -748,8 +750,8 @@ float32 __attribute__((flatten)) float32_add(float32 a, float32 b,
     return float32_round_pack_canonical(pr, status);
 }
 
-float64 __attribute__((flatten)) float64_add(float64 a, float64 b,
-                                             float_status *status)
+static float64 __attribute__((flatten, noinline))
+soft_float64_add(float64 a, float64 b, float_status *status)
 {
     FloatParts pa = float64_unpack_canonical(a, status);
     FloatParts pb = float64_unpack_canonical(b, status);
@@ -768,8 +770,8 @@ float16 __attribute__((flatten)) float16_sub(float16 a, float16 b,
     return float16_round_pack_canonical(pr, status);
 }
 
-float32 __attribute__((flatten)) float32_sub(float32 a, float32 b,
-                                             float_status *status)
+static float32 __attribute__((flatten, noinline))
+soft_float32_sub(float32 a, float32 b, float_status *status)
 {
     FloatParts pa = float32_unpack_canonical(a, status);
     FloatParts pb = float32_unpack_canonical(b, status);
@@ -778,8 +780,8 @@ float32 __attribute__((flatten)) float32_sub(float32 a, float32 b,
     return float32_round_pack_canonical(pr, status);
 }
 
-float64 __attribute__((flatten)) float64_sub(float64 a, float64 b,
-                                             float_status *status)
+static float64 __attribute__((flatten, noinline))
+soft_float64_sub(float64 a, float64 b, float_status *status)
 {
     FloatParts pa = float64_unpack_canonical(a, status);
     FloatParts pb = float64_unpack_canonical(b, status);
@@ -849,8 +851,8 @@ float16 __attribute__((flatten)) float16_mul(float16 a, float16 b,
     return float16_round_pack_canonical(pr, status);
 }
 
-float32 __attribute__((flatten)) float32_mul(float32 a, float32 b,
-                                             float_status *status)
+static float32 __attribute__((flatten, noinline))
+soft_float32_mul(float32 a, float32 b, float_status *status)
 {
     FloatParts pa = float32_unpack_canonical(a, status);
     FloatParts pb = float32_unpack_canonical(b, status);
@@ -859,8 +861,8 @@ float32 __attribute__((flatten)) float32_mul(float32 a, float32 b,
     return float32_round_pack_canonical(pr, status);
 }
 
-float64 __attribute__((flatten)) float64_mul(float64 a, float64 b,
-                                             float_status *status)
+static float64 __attribute__((flatten, noinline))
+soft_float64_mul(float64 a, float64 b, float_status *status)
 {
     FloatParts pa = float64_unpack_canonical(a, status);
     FloatParts pb = float64_unpack_canonical(b, status);
@@ -1176,7 +1178,8 @@ float16 float16_div(float16 a, float16 b, float_status *status)
     return float16_round_pack_canonical(pr, status);
 }
 
-float32 float32_div(float32 a, float32 b, float_status *status)
+static float32 __attribute__((flatten, noinline))
+soft_float32_div(float32 a, float32 b, float_status *status)
 {
     FloatParts pa = float32_unpack_canonical(a, status);
     FloatParts pb = float32_unpack_canonical(b, status);
@@ -1185,7 +1188,8 @@ float32 float32_div(float32 a, float32 b, float_status *status)
     return float32_round_pack_canonical(pr, status);
 }
 
-float64 float64_div(float64 a, float64 b, float_status *status)
+static float64 __attribute__((flatten, noinline))
+soft_float64_div(float64 a, float64 b, float_status *status)
 {
     FloatParts pa = float64_unpack_canonical(a, status);
     FloatParts pb = float64_unpack_canonical(b, status);
@@ -1981,20 +1985,218 @@ float16 __attribute__((flatten)) float16_sqrt(float16 a, float_status *status)
     return float16_round_pack_canonical(pr, status);
 }
 
-float32 __attribute__((flatten)) float32_sqrt(float32 a, float_status *status)
+static float32 __attribute__((flatten, noinline))
+soft_float32_sqrt(float32 a, float_status *status)
 {
     FloatParts pa = float32_unpack_canonical(a, status);
     FloatParts pr = sqrt_float(pa, status, &float32_params);
     return float32_round_pack_canonical(pr, status);
 }
 
-float64 __attribute__((flatten)) float64_sqrt(float64 a, float_status *status)
+static float64 __attribute__((flatten, noinline))
+soft_float64_sqrt(float64 a, float_status *status)
 {
     FloatParts pa = float64_unpack_canonical(a, status);
     FloatParts pr = sqrt_float(pa, status, &float64_params);
     return float64_round_pack_canonical(pr, status);
 }
 
+/*
+ * Hardfloat
+ *
+ * The basic float32 and float64 operations first try to compute their
+ * result with the host FPU, which is much faster than the softfloat
+ * code above.  This is only done when the host result is known to be
+ * identical to softfloat's, exception flags included:
+ *
+ *  - the rounding mode is round-to-nearest-even, which is the mode the
+ *    host FPU runs in (QEMU never changes it);
+ *  - float_flag_inexact is already set, so we do not need to know
+ *    whether the operation was exact.  Targets accumulate flags in
+ *    float_status, so this quickly becomes true for most guests;
+ *  - the inputs are zero or normal, so no NaN propagation, input
+ *    flushing or invalid operation can be involved;
+ *  - the result is not tiny, so no underflow detection or output
+ *    flushing is involved.  Overflow is detected from an infinite
+ *    result, which cannot otherwise be produced from finite inputs.
+ *
+ * Everything else falls back to softfloat.  Hosts that evaluate
+ * floating-point expressions in a wider format (e.g. x87) would round
+ * twice, so the fast path is disabled there.
+ */
+
+#if defined(__FAST_MATH__) || !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD != 0
+# define QEMU_NO_HARDFLOAT 1
+#else
+# define QEMU_NO_HARDFLOAT 0
+#endif
+
+typedef union {
+    uint32_t s;
+    float h;
+} union_float32;
+
+typedef union {
+    uint64_t s;
+    double h;
+} union_float64;
+
+static inline float float32_to_host(float32 a)
+{
+    union_float32 u = { .s = float32_val(a) };
+    return u.h;
+}
+
+static inline float32 host_to_float32(float h)
+{
+    union_float32 u = { .h = h };
+    return make_float32(u.s);
+}
+
+static inline double float64_to_host(float64 a)
+{
+    union_float64 u = { .s = float64_val(a) };
+    return u.h;
+}
+
+static inline float64 host_to_float64(double h)
+{
+    union_float64 u = { .h = h };
+    return make_float64(u.s);
+}
+
+static inline bool can_use_fpu(const float_status *s)
+{
+    if (QEMU_NO_HARDFLOAT) {
+        return false;
+    }
+    return likely(s->float_exception_flags & float_flag_inexact &&
+                  s->float_rounding_mode == float_round_nearest_even);
+}
+
+static inline bool float32_is_zero_or_normal(float32 a)
+{
+    uint32_t exp = extract32(float32_val(a), 23, 8);
+
+    return exp != 0xff && (exp != 0 || float32_is_zero(a));
+}
+
+static inline bool float64_is_zero_or_normal(float64 a)
+{
+    uint64_t exp = extract64(float64_val(a), 52, 11);
+
+    return exp != 0x7ff && (exp != 0 || float64_is_zero(a));
+}
+
+/*
+ * A zero result is exact if it comes from an addition or subtraction
+ * (subnormals are representable, so a non-zero sum cannot round to zero)
+ * or from a zero input; otherwise the host may have underflowed to zero.
+ */
+static inline bool float32_hard_result_ok(float r, bool zero_exact)
+{
+    return likely(fabsf(r) > FLT_MIN) || (r == 0 && zero_exact);
+}
+
+static inline bool float64_hard_result_ok(double r, bool zero_exact)
+{
+    return likely(fabs(r) > DBL_MIN) || (r == 0 && zero_exact);
+}
+
+#define GEN_HARDFLOAT_OP(bits, op, hostop, zero_exact)                      \
+float##bits float##bits##_##op(float##bits a, float##bits b,                \
+                               float_status *s)                             \
+{                                                                           \
+    if (can_use_fpu(s) &&                                                   \
+        float##bits##_is_zero_or_normal(a) &&                               \
+        float##bits##_is_zero_or_normal(b)) {                               \
+        __typeof__(float##bits##_to_host(a)) ha, hb, hr;                    \
+                                                                            \
+        ha = float##bits##_to_host(a);                                      \
+        hb = float##bits##_to_host(b);                                      \
+        hr = ha hostop hb;                                                  \
+        if (unlikely(isinf(hr))) {                                          \
+            s->float_exception_flags |= float_flag_overflow;                \
+            return host_to_float##bits(hr);                                 \
+        }                                                                   \
+        if (float##bits##_hard_result_ok(hr, zero_exact)) {                 \
+            return host_to_float##bits(hr);                                 \
+        }                                                                   \
+    }                                                                       \
+    return soft_float##bits##_##op(a, b, s);                                \
+}
+
+GEN_HARDFLOAT_OP(32, add, +, true)
+GEN_HARDFLOAT_OP(64, add, +, true)
+GEN_HARDFLOAT_OP(32, sub, -, true)
+GEN_HARDFLOAT_OP(64, sub, -, true)
+GEN_HARDFLOAT_OP(32, mul, *, float32_is_zero(a) || float32_is_zero(b))
+GEN_HARDFLOAT_OP(64, mul, *, float64_is_zero(a) || float64_is_zero(b))
+
+#undef GEN_HARDFLOAT_OP
+
+/*
+ * Division by zero must raise float_flag_divbyzero, so the divisor
+ * has to be normal.
+ */
+float32 float32_div(float32 a, float32 b, float_status *s)
+{
+    if (can_use_fpu(s) &&
+        float32_is_zero_or_normal(a) &&
+        float32_is_zero_or_normal(b) && !float32_is_zero(b)) {
+        float hr = float32_to_host(a) / float32_to_host(b);
+
+        if (unlikely(isinf(hr))) {
+            s->float_exception_flags |= float_flag_overflow;
+            return host_to_float32(hr);
+        }
+        if (float32_hard_result_ok(hr, float32_is_zero(a))) {
+            return host_to_float32(hr);
+        }
+    }
+    return soft_float32_div(a, b, s);
+}
+
+float64 float64_div(float64 a, float64 b, float_status *s)
+{
+    if (can_use_fpu(s) &&
+        float64_is_zero_or_normal(a) &&
+        float64_is_zero_or_normal(b) && !float64_is_zero(b)) {
+        double hr = float64_to_host(a) / float64_to_host(b);
+
+        if (unlikely(isinf(hr))) {
+            s->float_exception_flags |= float_flag_overflow;
+            return host_to_float64(hr);
+        }
+        if (float64_hard_result_ok(hr, float64_is_zero(a))) {
+            return host_to_float64(hr);
+        }
+    }
+    return soft_float64_div(a, b, s);
+}
+
+/*
+ * The square root of a non-negative normal is always normal, and
+ * sqrt(-0) is -0, so only negative inputs need the soft path.
+ */
+float32 float32_sqrt(float32 a, float_status *s)
+{
+    if (can_use_fpu(s) && float32_is_zero_or_normal(a) &&
+        (!float32_is_neg(a) || float32_is_zero(a))) {
+        return host_to_float32(sqrtf(float32_to_host(a)));
+    }
+    return soft_float32_sqrt(a, s);
+}
+
+float64 float64_sqrt(float64 a, float_status *s)
+{
+    if (can_use_fpu(s) && float64_is_zero_or_normal(a) &&
+        (!float64_is_neg(a) || float64_is_zero(a))) {
+        return host_to_float64(sqrt(float64_to_host(a)));
+    }
+    return soft_float64_sqrt(a, s);
+}
+
 
 /*----------------------------------------------------------------------------
 | Takes a 64-bit fixed-point value `absZ' with binary point between bits 6
@@ -705,6 +705,36 @@ STEXI
 @item info iothreads
 @findex info iothreads
 Show iothread's identifiers.
+ETEXI
+
+    {
+        .name       = "rcu",
+        .args_type  = "",
+        .params     = "",
+        .help       = "show RCU grace period statistics",
+        .cmd        = hmp_info_rcu,
+    },
+
+STEXI
+@item info rcu
+@findex info rcu
+Show RCU grace period and callback statistics.
+ETEXI
+
+    {
+        .name       = "coroutines",
+        .args_type  = "",
+        .params     = "",
+        .help       = "show coroutine stack and pool statistics",
+        .cmd        = hmp_info_coroutines,
+    },
+
+STEXI
+@item info coroutines
+@findex info coroutines
+Show how many coroutine stacks were allocated and freed, how much address
+space the live ones take, and how often pooled coroutines moved between
+threads.
 ETEXI
 
     {
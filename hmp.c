@@ -49,6 +49,8 @@
 #include "qemu-io.h"
 #include "qemu/cutils.h"
 #include "qemu/error-report.h"
+#include "qemu/rcu.h"
+#include "qemu/coroutine.h"
 #include "exec/ramlist.h"
 #include "hw/intc/intc.h"
 #include "migration/snapshot.h"
@@ -203,6 +205,10 @@ void hmp_info_migrate(Monitor *mon, const QDict *qdict)
             monitor_printf(mon, "expected downtime: %" PRIu64 " milliseconds\n",
                            info->expected_downtime);
         }
+        if (info->has_expected_converge_time) {
+            monitor_printf(mon, "expected converge time: %" PRIu64
+                           " milliseconds\n", info->expected_converge_time);
+        }
         if (info->has_downtime) {
             monitor_printf(mon, "downtime: %" PRIu64 " milliseconds\n",
                            info->downtime);
@@ -243,6 +249,12 @@ void hmp_info_migrate(Monitor *mon, const QDict *qdict)
             monitor_printf(mon, "postcopy request count: %" PRIu64 "\n",
                            info->ram->postcopy_requests);
         }
+        if (info->ram->zero_copy_bytes) {
+            monitor_printf(mon, "zero copy: %" PRIu64 " kbytes\n",
+                           info->ram->zero_copy_bytes >> 10);
+            monitor_printf(mon, "zero copy fallbacks: %" PRIu64 "\n",
+                           info->ram->zero_copy_fallbacks);
+        }
     }
 
     if (info->has_disk) {
@@ -355,6 +367,10 @@ void hmp_info_migrate_parameters(Monitor *mon, const QDict *qdict)
         monitor_printf(mon, "%s: %" PRIu64 "\n",
             MigrationParameter_str(MIGRATION_PARAMETER_XBZRLE_CACHE_SIZE),
             params->xbzrle_cache_size);
+        assert(params->has_vcpu_dirty_limit);
+        monitor_printf(mon, "%s: %" PRIu64 " MB/s\n",
+            MigrationParameter_str(MIGRATION_PARAMETER_VCPU_DIRTY_LIMIT),
+            params->vcpu_dirty_limit);
     }
 
     qapi_free_MigrationParameters(params);
@@ -1642,6 +1658,10 @@ void hmp_migrate_set_parameter(Monitor *mon, const QDict *qdict)
         }
         p->xbzrle_cache_size = cache_size;
         break;
+    case MIGRATION_PARAMETER_VCPU_DIRTY_LIMIT:
+        p->has_vcpu_dirty_limit = true;
+        visit_type_int(v, param, &p->vcpu_dirty_limit, &err);
+        break;
     default:
         assert(0);
     }
@@ -2468,11 +2488,60 @@ void hmp_info_iothreads(Monitor *mon, const QDict *qdict)
         monitor_printf(mon, "  poll-max-ns=%" PRId64 "\n", value->poll_max_ns);
         monitor_printf(mon, "  poll-grow=%" PRId64 "\n", value->poll_grow);
         monitor_printf(mon, "  poll-shrink=%" PRId64 "\n", value->poll_shrink);
+        monitor_printf(mon, "  poll-hits=%" PRId64 "\n", value->poll_hits);
+        monitor_printf(mon, "  poll-misses=%" PRId64 "\n", value->poll_misses);
+        monitor_printf(mon, "  poll-time-ns=%" PRId64 "\n",
+                       value->poll_time_ns);
+        if (value->has_thread_pool) {
+            ThreadPoolInfo *pool = value->thread_pool;
+
+            monitor_printf(mon, "  thread-pool: threads=%" PRId64
+                           " (min %" PRId64 ", max %" PRId64 ")\n",
+                           pool->threads, pool->min_threads,
+                           pool->max_threads);
+            monitor_printf(mon, "    requests=%" PRId64 " steals=%" PRId64
+                           " queue-depth=%" PRId64 " max-queue-depth=%"
+                           PRId64 "\n", pool->requests, pool->steals,
+                           pool->queue_depth, pool->max_queue_depth);
+            monitor_printf(mon, "    queue-time-ns=%" PRId64
+                           " run-time-ns=%" PRId64 "\n",
+                           pool->queue_time_ns, pool->run_time_ns);
+        }
     }
 
     qapi_free_IOThreadInfoList(info_list);
 }
 
+void hmp_info_rcu(Monitor *mon, const QDict *qdict)
+{
+    RCUStats stats;
+
+    rcu_get_stats(&stats);
+    monitor_printf(mon, "expedited=%s\n", stats.expedited ? "on" : "off");
+    monitor_printf(mon, "grace-periods=%" PRIu64 "\n", stats.grace_periods);
+    monitor_printf(mon, "shared-grace-periods=%" PRIu64 "\n",
+                   stats.shared_grace_periods);
+    monitor_printf(mon, "callbacks=%" PRIu64 "\n", stats.callbacks);
+    monitor_printf(mon, "callback-backlog=%" PRId64 "\n", stats.backlog);
+    monitor_printf(mon, "wait-time-ns=%" PRIu64 "\n", stats.wait_ns);
+    monitor_printf(mon, "max-wait-time-ns=%" PRIu64 "\n", stats.max_wait_ns);
+}
+
+void hmp_info_coroutines(Monitor *mon, const QDict *qdict)
+{
+    CoroutinePoolStats stats;
+
+    qemu_coroutine_get_pool_stats(&stats);
+    monitor_printf(mon, "stacks-allocated=%" PRIu64 "\n",
+                   stats.stacks_allocated);
+    monitor_printf(mon, "stacks-freed=%" PRIu64 "\n", stats.stacks_freed);
+    monitor_printf(mon, "stack-bytes=%" PRIu64 "\n", stats.stack_bytes);
+    monitor_printf(mon, "batches-released=%" PRIu64 "\n",
+                   stats.batches_released);
+    monitor_printf(mon, "batches-acquired=%" PRIu64 "\n",
+                   stats.batches_acquired);
+}
+
 void hmp_qom_list(Monitor *mon, const QDict *qdict)
 {
     const char *path = qdict_get_try_str(qdict, "path");
@@ -24,6 +24,7 @@
 #include "hw/qdev-core.h"
 #include "hw/virtio/vhost.h"
 #include "hw/virtio/vhost-user-blk.h"
+#include "hw/virtio/virtio-blk.h"
 #include "hw/virtio/virtio.h"
 #include "hw/virtio/virtio-bus.h"
 #include "hw/virtio/virtio-access.h"
@@ -49,7 +50,7 @@ static void vhost_user_blk_update_config(VirtIODevice *vdev, uint8_t *config)
 {
     VHostUserBlk *s = VHOST_USER_BLK(vdev);
 
-    memcpy(config, &s->blkcfg, sizeof(struct virtio_blk_config));
+    memcpy(config, &s->blkcfg, VIRTIO_BLK_CFG_SIZE);
 }
 
 static void vhost_user_blk_set_config(VirtIODevice *vdev, const uint8_t *config)
@@ -80,8 +81,7 @@ static int vhost_user_blk_handle_config_change(struct vhost_dev *dev)
     struct virtio_blk_config blkcfg;
     VHostUserBlk *s = VHOST_USER_BLK(dev->vdev);
 
-    ret = vhost_dev_get_config(dev, (uint8_t *)&blkcfg,
-                               sizeof(struct virtio_blk_config));
+    ret = vhost_dev_get_config(dev, (uint8_t *)&blkcfg, VIRTIO_BLK_CFG_SIZE);
     if (ret < 0) {
         error_report("get config space failed");
         return -1;
@@ -90,7 +90,7 @@ static int vhost_user_blk_handle_config_change(struct vhost_dev *dev)
     /* valid for resize only */
     if (blkcfg.capacity != s->blkcfg.capacity) {
         s->blkcfg.capacity = blkcfg.capacity;
-        memcpy(dev->vdev->config, &s->blkcfg, sizeof(struct virtio_blk_config));
+        memcpy(dev->vdev->config, &s->blkcfg, VIRTIO_BLK_CFG_SIZE);
         virtio_notify_config(dev->vdev);
     }
 
@@ -246,8 +246,7 @@ static void vhost_user_blk_device_realize(DeviceState *dev, Error **errp)
         return;
     }
 
-    virtio_init(vdev, "virtio-blk", VIRTIO_ID_BLOCK,
-                sizeof(struct virtio_blk_config));
+    virtio_init(vdev, "virtio-blk", VIRTIO_ID_BLOCK, VIRTIO_BLK_CFG_SIZE);
 
     for (i = 0; i < s->num_queues; i++) {
         virtio_add_queue(vdev, s->queue_size,
@@ -267,7 +266,7 @@ static void vhost_user_blk_device_realize(DeviceState *dev, Error **errp)
     }
 
     ret = vhost_dev_get_config(&s->dev, (uint8_t *)&s->blkcfg,
-                              sizeof(struct virtio_blk_config));
+                               VIRTIO_BLK_CFG_SIZE);
     if (ret < 0) {
         error_setg(errp, "vhost-user-blk: get block config failed");
         goto vhost_err;
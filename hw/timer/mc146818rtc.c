@@ -801,6 +801,8 @@ static int rtc_pre_save(void *opaque)
 {
     RTCState *s = opaque;
 
+    /* Apply any index port write that is still queued */
+    qemu_flush_coalesced_mmio_buffer();
     rtc_update_time(s);
 
     return 0;
@@ -988,6 +990,10 @@ static void rtc_realizefn(DeviceState *dev, Error **errp)
     qemu_register_suspend_notifier(&s->suspend_notifier);
 
     memory_region_init_io(&s->io, OBJECT(s), &cmos_ops, s, "rtc", 2);
+    /* Guests write the index port before every CMOS access; only the
+     * following access to the data port needs to see it.
+     */
+    memory_region_add_coalescing(&s->io, 0, 1);
     isa_register_ioport(isadev, &s->io, base);
 
     qdev_set_legacy_instance_id(dev, base, 3);
@@ -51,6 +51,14 @@ struct Coroutine;
 struct ThreadPool;
 struct LinuxAioState;
 
+typedef QSLIST_HEAD(, QEMUBH) BHList;
+
+typedef struct BHListSlice BHListSlice;
+struct BHListSlice {
+    BHList bh_list;
+    QSIMPLEQ_ENTRY(BHListSlice) next;
+};
+
 struct AioContext {
     GSource source;
 
@@ -85,14 +93,19 @@ struct AioContext {
      */
     uint32_t notify_me;
 
-    /* A lock to protect between QEMUBH and AioHandler adders and deleter,
-     * and to ensure that no callbacks are removed while we're walking and
+    /* A lock to protect between AioHandler adders and deleter, and to
+     * ensure that no callbacks are removed while we're walking and
      * dispatching them.
      */
     QemuLockCnt list_lock;
 
-    /* Anchor of the list of Bottom Halves belonging to the context */
-    struct QEMUBH *first_bh;
+    /* Bottom Halves pending aio_bh_poll() processing.  BHs are pushed
+     * with atomic operations and only removed by aio_bh_poll().
+     */
+    BHList bh_list;
+
+    /* Slices of bh_list taken by aio_bh_poll(), one per nested call */
+    QSIMPLEQ_HEAD(, BHListSlice) bh_slice_list;
 
     /* Used by aio_notify.
      *
@@ -135,11 +148,25 @@ struct AioContext {
     int poll_disable_cnt;
 
     /* Polling mode parameters */
-    int64_t poll_ns;        /* current polling time in nanoseconds */
+    int64_t poll_ns;        /* largest polling time of the AioHandlers */
     int64_t poll_max_ns;    /* maximum polling time in nanoseconds */
     int64_t poll_grow;      /* polling time growth factor */
     int64_t poll_shrink;    /* polling time shrink factor */
 
+    /* Thread pool parameters, see aio_context_set_thread_pool_params().
+     * Set from the main loop and read when the pool is created in the
+     * AioContext's own thread, so protected by thread_pool_params_lock.
+     */
+    QemuMutex thread_pool_params_lock;
+    int64_t thread_pool_min;
+    int64_t thread_pool_max;
+    unsigned long *thread_pool_cpus;    /* NULL means no CPU affinity */
+
+    /* Polling statistics, written only by the thread running aio_poll() */
+    uint64_t poll_hits;     /* busy polls that made progress */
+    uint64_t poll_misses;   /* busy polls that timed out */
+    int64_t poll_time_ns;   /* total time spent busy polling */
+
     /* Are we in polling mode or monitoring file descriptors? */
     bool poll_started;
 
@@ -249,7 +276,8 @@ void aio_bh_call(QEMUBH *bh);
  *
  * These are internal functions used by the QEMU main loop.
  * And notice that multiple occurrences of aio_bh_poll cannot
- * be called concurrently
+ * be called concurrently.  Only scheduled or deleted bottom halves
+ * are visited, in the order they were scheduled.
  */
 int aio_bh_poll(AioContext *ctx);
 
@@ -567,4 +595,20 @@ void aio_context_set_poll_params(AioContext *ctx, int64_t max_ns,
                                  int64_t grow, int64_t shrink,
                                  Error **errp);
 
+/**
+ * aio_context_set_thread_pool_params:
+ * @ctx: the aio context
+ * @min: number of worker threads that are kept even when idle
+ * @max: maximum number of worker threads
+ * @cpus: bitmap of THREAD_POOL_MAX_CPUS host CPUs the worker threads may
+ *        run on, or NULL to keep the affinity they inherit
+ *
+ * The parameters are applied to the thread pool when it is created, or
+ * immediately if it already exists.
+ */
+void aio_context_set_thread_pool_params(AioContext *ctx, int64_t min,
+                                        int64_t max,
+                                        const unsigned long *cpus,
+                                        Error **errp);
+
 #endif
@@ -20,13 +20,47 @@
 
 #include "block/block.h"
 
+#define THREAD_POOL_MAX_THREADS 256
+#define THREAD_POOL_MAX_CPUS 1024
+
 typedef int ThreadPoolFunc(void *opaque);
 
 typedef struct ThreadPool ThreadPool;
 
+typedef struct ThreadPoolStats {
+    int min_threads;
+    int max_threads;
+    int threads;                    /* worker threads currently running */
+    unsigned int queue_depth;       /* requests waiting for a thread */
+    unsigned int max_queue_depth;   /* deepest per-thread queue so far */
+    uint64_t requests;              /* requests completed */
+    uint64_t steals;                /* requests taken from another queue */
+    int64_t queue_ns;               /* total time spent waiting */
+    int64_t run_ns;                 /* total time spent running */
+} ThreadPoolStats;
+
 ThreadPool *thread_pool_new(struct AioContext *ctx);
 void thread_pool_free(ThreadPool *pool);
 
+/**
+ * thread_pool_update_params:
+ * @pool: the thread pool
+ * @ctx: the AioContext whose thread pool parameters are applied
+ *
+ * Apply the parameters set with aio_context_set_thread_pool_params().
+ * Threads above the new maximum exit once they are idle.
+ */
+void thread_pool_update_params(ThreadPool *pool, struct AioContext *ctx);
+
+/**
+ * thread_pool_get_stats:
+ * @pool: the thread pool
+ * @stats: filled in with the current configuration and statistics
+ *
+ * Can be called from any thread.
+ */
+void thread_pool_get_stats(ThreadPool *pool, ThreadPoolStats *stats);
+
 BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
         ThreadPoolFunc *func, void *arg,
         BlockCompletionFunc *cb, void *opaque);
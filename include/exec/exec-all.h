@@ -343,6 +343,7 @@ struct TranslationBlock {
 #define CF_USE_ICOUNT  0x00020000
 #define CF_INVALID     0x00040000 /* TB is stale. Setters need tb_lock */
 #define CF_PARALLEL    0x00080000 /* Generate code for a parallel context */
+#define CF_NOPERSIST   0x00100000 /* Embeds host pointers; not for tb-cache */
 /* cflags' mask for hashing/comparison */
 #define CF_HASH_MASK   \
     (CF_COUNT_MASK | CF_LAST_IO | CF_USE_ICOUNT | CF_PARALLEL)
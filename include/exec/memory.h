@@ -259,6 +259,7 @@ struct MemoryRegion {
     QTAILQ_HEAD(subregions, MemoryRegion) subregions;
     QTAILQ_ENTRY(MemoryRegion) subregions_link;
     QTAILQ_HEAD(coalesced_ranges, CoalescedMemoryRange) coalesced;
+    uint64_t coalesced_writes; /* Writes replayed from the accelerator */
     const char *name;
     unsigned ioeventfd_nb;
     MemoryRegionIoeventfd *ioeventfds;
@@ -291,16 +292,21 @@ struct MemoryListener {
     void (*log_stop)(MemoryListener *listener, MemoryRegionSection *section,
                      int old, int new);
     void (*log_sync)(MemoryListener *listener, MemoryRegionSection *section);
+    /* Sync the whole dirty log at once; if set, log_sync is not used.
+     * @flush is true for memory_global_dirty_log_sync(), which must see
+     * every page dirtied before the call even if that is expensive.
+     */
+    void (*log_sync_global)(MemoryListener *listener, bool flush);
     void (*log_global_start)(MemoryListener *listener);
     void (*log_global_stop)(MemoryListener *listener);
     void (*eventfd_add)(MemoryListener *listener, MemoryRegionSection *section,
                         bool match_data, uint64_t data, EventNotifier *e);
     void (*eventfd_del)(MemoryListener *listener, MemoryRegionSection *section,
                         bool match_data, uint64_t data, EventNotifier *e);
-    void (*coalesced_mmio_add)(MemoryListener *listener, MemoryRegionSection *section,
-                               hwaddr addr, hwaddr len);
-    void (*coalesced_mmio_del)(MemoryListener *listener, MemoryRegionSection *section,
-                               hwaddr addr, hwaddr len);
+    void (*coalesced_io_add)(MemoryListener *listener, MemoryRegionSection *section,
+                             hwaddr addr, hwaddr len);
+    void (*coalesced_io_del)(MemoryListener *listener, MemoryRegionSection *section,
+                             hwaddr addr, hwaddr len);
     /* Lower = earlier (during add), later (during del) */
     unsigned priority;
     AddressSpace *address_space;
@@ -1224,6 +1230,11 @@ void memory_region_rom_device_set_romd(MemoryRegion *mr, bool romd_mode);
  * Enabled writes to a region to be queued for later processing. MMIO ->write
  * callbacks may be delayed until a non-coalesced MMIO is issued.
  * Only useful for IO regions.  Roughly similar to write-combining hardware.
+ * Works for both memory and port I/O regions, if the accelerator supports
+ * it; KVM queues the writes in a ring shared with userspace and saves a
+ * VM exit for each of them.  Any other access to the region replays the
+ * queued writes first, so this suits write-only registers whose writes
+ * have no immediate side effects, such as index registers.
  *
  * @mr: the memory region to be write coalesced
  */
@@ -1656,6 +1667,23 @@ MemTxResult address_space_write(AddressSpace *as, hwaddr addr,
                                 MemTxAttrs attrs,
                                 const uint8_t *buf, int len);
 
+/**
+ * address_space_write_coalesced: replay a write from a coalesced I/O buffer.
+ *
+ * Like address_space_write() with unspecified attributes, but also counts
+ * the write against the region it goes to, so that "info mtree" can show
+ * how many exits coalescing saved.  The region is the one the write is
+ * dispatched to, looked up before the write can change the memory map.
+ * Must be called with the iothread mutex held.
+ *
+ * @as: #AddressSpace to be accessed
+ * @addr: address within that address space
+ * @buf: buffer with the data transferred
+ * @len: the number of bytes to write
+ */
+MemTxResult address_space_write_coalesced(AddressSpace *as, hwaddr addr,
+                                          const uint8_t *buf, int len);
+
 /* address_space_ld*: load from an address space
  * address_space_st*: store to an address space
  *
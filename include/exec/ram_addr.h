@@ -49,6 +49,11 @@ struct RAMBlock {
     unsigned long *unsentmap;
     /* bitmap of already received pages in postcopy */
     unsigned long *receivedmap;
+    /* mapped-ram: location of this block's regions in the migration file */
+    uint64_t bitmap_offset;
+    uint64_t pages_offset;
+    /* mapped-ram: bitmap of pages present in the file */
+    unsigned long *file_bmap;
 };
 
 static inline bool offset_in_ramblock(RAMBlock *b, ram_addr_t offset)
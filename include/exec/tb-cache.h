@@ -0,0 +1,40 @@
+/*
+ * Persistent translation cache for user-mode emulation
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+#ifndef EXEC_TB_CACHE_H
+#define EXEC_TB_CACHE_H
+
+#include "exec/exec-all.h"
+
+#ifdef CONFIG_USER_ONLY
+void tb_cache_init(const char *dir, const char *exec_path,
+                   const char *cpu_model, abi_ulong load_addr);
+TranslationBlock *tb_cache_lookup(CPUState *cpu, target_ulong pc,
+                                  target_ulong cs_base, uint32_t flags,
+                                  uint32_t cflags);
+void tb_cache_flush(void);
+void tb_cache_checkpoint(void);
+void tb_cache_save(void);
+#else
+static inline TranslationBlock *tb_cache_lookup(CPUState *cpu,
+                                                target_ulong pc,
+                                                target_ulong cs_base,
+                                                uint32_t flags,
+                                                uint32_t cflags)
+{
+    return NULL;
+}
+
+static inline void tb_cache_flush(void)
+{
+}
+
+static inline void tb_cache_checkpoint(void)
+{
+}
+#endif
+
+#endif /* EXEC_TB_CACHE_H */
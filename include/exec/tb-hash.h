@@ -57,6 +57,12 @@ static inline unsigned int tb_jmp_cache_hash_func(target_ulong pc)
 
 #endif /* CONFIG_SOFTMMU */
 
+/* The indirect branch cache is indexed by the host address of the branch */
+static inline unsigned int tb_ibtc_hash_func(uintptr_t site)
+{
+    return (site ^ (site >> TB_IBTC_BITS)) & (TB_IBTC_SIZE - 1);
+}
+
 static inline
 uint32_t tb_hash_func(tb_page_addr_t phys_pc, target_ulong pc, uint32_t flags,
                       uint32_t cf_mask, uint32_t trace_vcpu_dstate)
@@ -16,27 +16,30 @@
 #include "exec/exec-all.h"
 #include "exec/tb-hash.h"
 
-/* Might cause an exception, so have a longjmp destination ready */
+static inline bool tb_lookup_cmp(CPUState *cpu, TranslationBlock *tb,
+                                 target_ulong pc, target_ulong cs_base,
+                                 uint32_t flags, uint32_t cf_mask)
+{
+    return tb->pc == pc &&
+           tb->cs_base == cs_base &&
+           tb->flags == flags &&
+           tb->trace_vcpu_dstate == *cpu->trace_dstate &&
+           (tb_cflags(tb) & (CF_HASH_MASK | CF_INVALID)) == cf_mask;
+}
+
 static inline TranslationBlock *
-tb_lookup__cpu_state(CPUState *cpu, target_ulong *pc, target_ulong *cs_base,
-                     uint32_t *flags, uint32_t cf_mask)
+tb_lookup(CPUState *cpu, target_ulong pc, target_ulong cs_base,
+          uint32_t flags, uint32_t cf_mask)
 {
-    CPUArchState *env = (CPUArchState *)cpu->env_ptr;
     TranslationBlock *tb;
     uint32_t hash;
 
-    cpu_get_tb_cpu_state(env, pc, cs_base, flags);
-    hash = tb_jmp_cache_hash_func(*pc);
+    hash = tb_jmp_cache_hash_func(pc);
     tb = atomic_rcu_read(&cpu->tb_jmp_cache[hash]);
-    if (likely(tb &&
-               tb->pc == *pc &&
-               tb->cs_base == *cs_base &&
-               tb->flags == *flags &&
-               tb->trace_vcpu_dstate == *cpu->trace_dstate &&
-               (tb_cflags(tb) & (CF_HASH_MASK | CF_INVALID)) == cf_mask)) {
+    if (likely(tb && tb_lookup_cmp(cpu, tb, pc, cs_base, flags, cf_mask))) {
         return tb;
     }
-    tb = tb_htable_lookup(cpu, *pc, *cs_base, *flags, cf_mask);
+    tb = tb_htable_lookup(cpu, pc, cs_base, flags, cf_mask);
     if (tb == NULL) {
         return NULL;
     }
@@ -44,4 +47,15 @@ tb_lookup__cpu_state(CPUState *cpu, target_ulong *pc, target_ulong *cs_base,
     return tb;
 }
 
+/* Might cause an exception, so have a longjmp destination ready */
+static inline TranslationBlock *
+tb_lookup__cpu_state(CPUState *cpu, target_ulong *pc, target_ulong *cs_base,
+                     uint32_t *flags, uint32_t cf_mask)
+{
+    CPUArchState *env = (CPUArchState *)cpu->env_ptr;
+
+    cpu_get_tb_cpu_state(env, pc, cs_base, flags);
+    return tb_lookup(cpu, *pc, *cs_base, *flags, cf_mask);
+}
+
 #endif /* EXEC_TB_LOOKUP_H */
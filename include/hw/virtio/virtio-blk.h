@@ -21,6 +21,10 @@
 #include "sysemu/block-backend.h"
 
 #define TYPE_VIRTIO_BLK "virtio-blk-device"
+
+/* Fields after num_queues are not implemented; keep the guest ABI stable */
+#define VIRTIO_BLK_CFG_SIZE \
+    (offsetof(struct virtio_blk_config, num_queues) + sizeof(uint16_t))
 #define VIRTIO_BLK(obj) \
         OBJECT_CHECK(VirtIOBlock, (obj), TYPE_VIRTIO_BLK)
 
@@ -25,6 +25,13 @@
 #include "io/task.h"
 #include "qemu/sockets.h"
 
+#ifdef CONFIG_LINUX
+#include <linux/errqueue.h>
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+#define QEMU_MSG_ZEROCOPY
+#endif
+#endif
+
 #define TYPE_QIO_CHANNEL_SOCKET "qio-channel-socket"
 #define QIO_CHANNEL_SOCKET(obj)                                     \
     OBJECT_CHECK(QIOChannelSocket, (obj), TYPE_QIO_CHANNEL_SOCKET)
@@ -48,6 +55,8 @@ struct QIOChannelSocket {
     socklen_t localAddrLen;
     struct sockaddr_storage remoteAddr;
     socklen_t remoteAddrLen;
+    size_t zero_copy_queued; /* sendmsg() calls issued with MSG_ZEROCOPY */
+    size_t zero_copy_sent;   /* ... and completed on the error queue */
 };
 
 
@@ -45,6 +45,7 @@ enum QIOChannelFeature {
     QIO_CHANNEL_FEATURE_FD_PASS,
     QIO_CHANNEL_FEATURE_SHUTDOWN,
     QIO_CHANNEL_FEATURE_LISTEN,
+    QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY,
 };
 
 
@@ -142,6 +143,22 @@ struct QIOChannelClass {
                                   IOHandler *io_read,
                                   IOHandler *io_write,
                                   void *opaque);
+    ssize_t (*io_writev_zero_copy)(QIOChannel *ioc,
+                                   const struct iovec *iov,
+                                   size_t niov,
+                                   Error **errp);
+    int (*io_flush)(QIOChannel *ioc,
+                    Error **errp);
+    ssize_t (*io_pwrite)(QIOChannel *ioc,
+                         const char *buf,
+                         size_t buflen,
+                         off_t offset,
+                         Error **errp);
+    ssize_t (*io_pread)(QIOChannel *ioc,
+                        char *buf,
+                        size_t buflen,
+                        off_t offset,
+                        Error **errp);
 };
 
 /* General I/O handling functions */
@@ -268,6 +285,58 @@ ssize_t qio_channel_writev_full(QIOChannel *ioc,
                                 size_t nfds,
                                 Error **errp);
 
+/**
+ * qio_channel_writev_zero_copy:
+ * @ioc: the channel object
+ * @iov: the array of memory regions to write data from
+ * @niov: the length of the @iov array
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Behaves as qio_channel_writev() but asks the channel
+ * to transmit the data directly from the memory regions
+ * referenced by @iov, rather than copying it into a
+ * kernel buffer first.
+ *
+ * Since the data is read asynchronously, the caller must
+ * not modify or release the memory referenced by @iov
+ * until a subsequent call to qio_channel_flush() has
+ * returned. Modifications made before then may or may
+ * not be seen by the peer.
+ *
+ * It is an error to call this method unless
+ * qio_channel_has_feature() returns a true value for
+ * the QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY constant.
+ *
+ * Returns: the number of bytes queued, or -1 on error,
+ * or QIO_CHANNEL_ERR_BLOCK if no data is can be sent
+ * and the channel is non-blocking
+ */
+ssize_t qio_channel_writev_zero_copy(QIOChannel *ioc,
+                                     const struct iovec *iov,
+                                     size_t niov,
+                                     Error **errp);
+
+/**
+ * qio_channel_flush:
+ * @ioc: the channel object
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Wait until all data previously queued with
+ * qio_channel_writev_zero_copy() has been released
+ * by the channel, after which the memory it referenced
+ * may be reused.
+ *
+ * Channels without the QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY
+ * feature never hold references to caller memory, so
+ * this is a no-op for them.
+ *
+ * Returns: 0 if all data was sent without copying,
+ * 1 if the channel had to fall back to copying some
+ * of it, or -1 on error
+ */
+int qio_channel_flush(QIOChannel *ioc,
+                      Error **errp);
+
 /**
  * qio_channel_readv_all_eof:
  * @ioc: the channel object
@@ -602,6 +671,53 @@ off_t qio_channel_io_seek(QIOChannel *ioc,
                           int whence,
                           Error **errp);
 
+/**
+ * qio_channel_pwrite:
+ * @ioc: the channel object
+ * @buf: the memory region to write data from
+ * @buflen: the number of bytes to write
+ * @offset: the position in the channel to write at
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Write up to @buflen bytes from @buf at position @offset
+ * of the channel, without changing the current I/O position.
+ * The data is written in full unless an error occurs, retrying
+ * after short writes as needed.
+ *
+ * Not all implementations will support this facility,
+ * so may report an error.
+ *
+ * Returns: the number of bytes written, or -1 on error
+ */
+ssize_t qio_channel_pwrite(QIOChannel *ioc,
+                           const char *buf,
+                           size_t buflen,
+                           off_t offset,
+                           Error **errp);
+
+/**
+ * qio_channel_pread:
+ * @ioc: the channel object
+ * @buf: the memory region to read data into
+ * @buflen: the number of bytes to read
+ * @offset: the position in the channel to read from
+ * @errp: pointer to a NULL-initialized error object
+ *
+ * Read up to @buflen bytes into @buf from position @offset
+ * of the channel, without changing the current I/O position.
+ * Fewer bytes are only returned if end-of-file is reached.
+ *
+ * Not all implementations will support this facility,
+ * so may report an error.
+ *
+ * Returns: the number of bytes read, or -1 on error
+ */
+ssize_t qio_channel_pread(QIOChannel *ioc,
+                          char *buf,
+                          size_t buflen,
+                          off_t offset,
+                          Error **errp);
+
 
 /**
  * qio_channel_create_watch:
@@ -65,6 +65,33 @@ typedef void coroutine_fn CoroutineEntry(void *opaque);
  */
 Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque);
 
+/**
+ * Create a new coroutine with a stack of at least @stack_size bytes
+ *
+ * Like qemu_coroutine_create(), but the stack size is rounded up to the
+ * next power of two between 64 KiB and 1 MiB, the size used by
+ * qemu_coroutine_create().  Coroutines that are known not to recurse
+ * deeply can use this to keep their memory footprint small.
+ */
+Coroutine *qemu_coroutine_create_with_stack(CoroutineEntry *entry,
+                                            void *opaque, size_t stack_size);
+
+typedef struct CoroutinePoolStats {
+    /* Coroutine stacks allocated and freed since startup.  */
+    uint64_t stacks_allocated;
+    uint64_t stacks_freed;
+    /* Virtual size of the stacks currently allocated.  */
+    uint64_t stack_bytes;
+    /* Batches moved from a thread's pool to the shared pool and back.  */
+    uint64_t batches_released;
+    uint64_t batches_acquired;
+} CoroutinePoolStats;
+
+/**
+ * Return statistics about coroutine stacks and pools
+ */
+void qemu_coroutine_get_pool_stats(CoroutinePoolStats *stats);
+
 /**
  * Transfer control to a coroutine
  */
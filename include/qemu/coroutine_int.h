@@ -30,6 +30,12 @@
 
 #define COROUTINE_STACK_SIZE (1 << 20)
 
+/* Stacks come in power-of-two size classes from COROUTINE_STACK_SIZE_MIN
+ * to COROUTINE_STACK_SIZE, each with its own pool.
+ */
+#define COROUTINE_STACK_SIZE_MIN (1 << 16)
+#define COROUTINE_STACK_CLASSES 5
+
 typedef enum {
     COROUTINE_YIELD = 1,
     COROUTINE_TERMINATE = 2,
@@ -43,6 +49,10 @@ struct Coroutine {
 
     /* Only used when the coroutine has terminated.  */
     QSLIST_ENTRY(Coroutine) pool_next;
+    QSLIST_ENTRY(Coroutine) pool_batch_next;
+
+    /* Index of the stack size class, fixed at creation.  */
+    unsigned int stack_class;
 
     size_t locks_held;
 
@@ -64,7 +74,7 @@ struct Coroutine {
     QSLIST_ENTRY(Coroutine) co_scheduled_next;
 };
 
-Coroutine *qemu_coroutine_new(void);
+Coroutine *qemu_coroutine_new(size_t stack_size);
 void qemu_coroutine_delete(Coroutine *co);
 CoroutineAction qemu_coroutine_switch(Coroutine *from, Coroutine *to,
                                       CoroutineAction action);
@@ -27,6 +27,7 @@
 #include "qemu/thread.h"
 #include "qemu/queue.h"
 #include "qemu/atomic.h"
+#include "qemu/sys_membarrier.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,7 +80,10 @@ static inline void rcu_read_lock(void)
     }
 
     ctr = atomic_read(&rcu_gp_ctr);
-    atomic_xchg(&p_rcu_reader->ctr, ctr);
+    atomic_set(&p_rcu_reader->ctr, ctr);
+
+    /* Write p_rcu_reader->ctr before reading RCU-protected pointers.  */
+    smp_mb_placeholder();
 }
 
 static inline void rcu_read_unlock(void)
@@ -91,7 +95,15 @@ static inline void rcu_read_unlock(void)
         return;
     }
 
-    atomic_xchg(&p_rcu_reader->ctr, 0);
+    /* Ensure that the critical section is seen to precede the
+     * store to p_rcu_reader->ctr.  Together with the following
+     * smp_mb_placeholder(), this ensures writes to p_rcu_reader->ctr
+     * are sequentially consistent.
+     */
+    atomic_store_release(&p_rcu_reader->ctr, 0);
+
+    /* Write p_rcu_reader->ctr before reading p_rcu_reader->waiting.  */
+    smp_mb_placeholder();
     if (unlikely(atomic_read(&p_rcu_reader->waiting))) {
         atomic_set(&p_rcu_reader->waiting, false);
         qemu_event_set(&rcu_gp_event);
@@ -100,6 +112,24 @@ static inline void rcu_read_unlock(void)
 
 extern void synchronize_rcu(void);
 
+typedef struct RCUStats {
+    /* Grace periods that waited for readers.  */
+    uint64_t grace_periods;
+    /* synchronize_rcu calls satisfied by another thread's grace period.  */
+    uint64_t shared_grace_periods;
+    /* Callbacks run by the call_rcu thread.  */
+    uint64_t callbacks;
+    /* Callbacks queued but not yet picked up by the call_rcu thread.  */
+    int64_t backlog;
+    /* Time spent waiting for readers, in nanoseconds.  */
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+    /* Whether readers rely on membarrier(2) instead of memory barriers.  */
+    bool expedited;
+} RCUStats;
+
+extern void rcu_get_stats(RCUStats *stats);
+
 /*
  * Reader thread registration.
  */
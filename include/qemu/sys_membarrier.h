@@ -0,0 +1,44 @@
+/*
+ * Process-global memory barriers
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_SYS_MEMBARRIER_H
+#define QEMU_SYS_MEMBARRIER_H
+
+#include "qemu/atomic.h"
+
+#ifdef CONFIG_MEMBARRIER
+/* When the kernel supports it, only block reordering at the compiler
+ * level on the performance-critical side.  The slow side then forces
+ * processor-level ordering on all other threads of the process through
+ * the membarrier system call.  smp_mb_global_available is only written
+ * by smp_mb_global_init, before any other thread can run.
+ */
+extern bool smp_mb_global_available;
+
+void smp_mb_global_init(void);
+void smp_mb_global(void);
+
+#define smp_mb_placeholder()                    \
+    do {                                        \
+        if (likely(smp_mb_global_available)) {  \
+            barrier();                          \
+        } else {                                \
+            smp_mb();                           \
+        }                                       \
+    } while (0)
+#else
+/* Keep it simple, execute a real memory barrier on both sides.  */
+static inline void smp_mb_global_init(void)
+{
+}
+
+#define smp_mb_global_available    false
+#define smp_mb_global()            smp_mb()
+#define smp_mb_placeholder()       smp_mb()
+#endif
+
+#endif /* QEMU_SYS_MEMBARRIER_H */
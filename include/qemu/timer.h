@@ -66,7 +66,11 @@ struct QEMUTimer {
     QEMUTimerList *timer_list;
     QEMUTimerCB *cb;
     void *opaque;
-    QEMUTimer *next;
+    /* Pairing heap links, protected by the timer list's lock.  */
+    QEMUTimer *next;            /* next sibling */
+    QEMUTimer *prev;            /* previous sibling, or parent */
+    QEMUTimer *child;           /* first child */
+    uint64_t seq;               /* insertion order, breaks ties */
     int scale;
 };
 
@@ -241,12 +241,20 @@ struct CPUWatchpoint {
 
 struct KVMState;
 struct kvm_run;
+struct kvm_dirty_gfn;
 
 struct hax_vcpu_state;
 
 #define TB_JMP_CACHE_BITS 12
 #define TB_JMP_CACHE_SIZE (1 << TB_JMP_CACHE_BITS)
 
+/* Indirect branch target cache, indexed by the host address of the branch */
+#define TB_IBTC_BITS 8
+#define TB_IBTC_SIZE (1 << TB_IBTC_BITS)
+
+/* Return address stack, used to predict the target of guest returns */
+#define TB_RAS_SIZE 16
+
 /* work queue */
 
 /* The union type allows passing of 64 bit target pointers on 32 bit
@@ -311,6 +319,8 @@ struct qemu_work_item;
  * @mem_io_pc: Host Program Counter at which the memory was accessed.
  * @mem_io_vaddr: Target virtual address at which the memory was accessed.
  * @kvm_fd: vCPU file descriptor for KVM.
+ * @kvm_dirty_gfns: vCPU dirty ring shared with KVM, if enabled.
+ * @kvm_fetch_index: Next entry of @kvm_dirty_gfns to harvest.
  * @work_mutex: Lock to prevent multiple access to queued_work_*.
  * @queued_work_first: First asynchronous work pending.
  * @trace_dstate_delayed: Delayed changes to trace_dstate (includes all changes
@@ -364,6 +374,16 @@ struct CPUState {
 
     /* Accessed in parallel; all accesses must be atomic */
     struct TranslationBlock *tb_jmp_cache[TB_JMP_CACHE_SIZE];
+    struct TranslationBlock *tb_ibtc[TB_IBTC_SIZE];
+    struct TranslationBlock *tb_ras[TB_RAS_SIZE];
+    unsigned int tb_ras_top;
+
+    /* Indirect branch statistics, only updated by the vCPU thread;
+       accesses must be atomic */
+    unsigned long tb_ibtc_hits;
+    unsigned long tb_ibtc_misses;
+    unsigned long tb_ras_hits;
+    unsigned long tb_ras_misses;
 
     struct GDBRegisterState *gdb_regs;
     int gdb_num_regs;
@@ -387,6 +407,8 @@ struct CPUState {
     int kvm_fd;
     struct KVMState *kvm_state;
     struct kvm_run *kvm_run;
+    struct kvm_dirty_gfn *kvm_dirty_gfns;
+    uint32_t kvm_fetch_index;
 
     /* Used for events with 'vcpu' and *without* the 'disabled' properties */
     DECLARE_BITMAP(trace_dstate_delayed, CPU_TRACE_DSTATE_MAX_EVENTS);
@@ -405,6 +427,10 @@ struct CPUState {
      * autoconverge
      */
     bool throttle_thread_scheduled;
+    /* Throttle applied to this vcpu only, on top of cpu_throttle_set() */
+    int throttle_percentage;
+    /* Pages first dirtied by this vcpu since the last harvest */
+    unsigned long dirty_pages;
 
     bool ignore_memory_transaction_failures;
 
@@ -440,6 +466,24 @@ extern struct CPUTailQ cpus;
 
 extern __thread CPUState *current_cpu;
 
+/*
+ * The indirect branch caches are not indexed by guest address, so they
+ * are cleared as a whole whenever the whole jump cache is.  Flushing a
+ * single page only drops the entries for that page, see
+ * tb_flush_jmp_cache().
+ */
+static inline void cpu_tb_ibtc_clear(CPUState *cpu)
+{
+    unsigned int i;
+
+    for (i = 0; i < TB_IBTC_SIZE; i++) {
+        atomic_set(&cpu->tb_ibtc[i], NULL);
+    }
+    for (i = 0; i < TB_RAS_SIZE; i++) {
+        atomic_set(&cpu->tb_ras[i], NULL);
+    }
+}
+
 static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
 {
     unsigned int i;
@@ -447,6 +491,7 @@ static inline void cpu_tb_jmp_cache_clear(CPUState *cpu)
     for (i = 0; i < TB_JMP_CACHE_SIZE; i++) {
         atomic_set(&cpu->tb_jmp_cache[i], NULL);
     }
+    cpu_tb_ibtc_clear(cpu);
 }
 
 /**
@@ -842,6 +887,55 @@ bool cpu_throttle_active(void);
  */
 int cpu_throttle_get_percentage(void);
 
+/**
+ * cpu_throttle_set_vcpu:
+ * @cpu: The vcpu to throttle.
+ * @new_throttle_pct: Percent of sleep time, or 0 to stop throttling @cpu.
+ *
+ * Like cpu_throttle_set, but only throttles @cpu.  If both are active,
+ * the higher of the two percentages applies.
+ */
+void cpu_throttle_set_vcpu(CPUState *cpu, int new_throttle_pct);
+
+/**
+ * cpu_throttle_get_vcpu_percentage:
+ * @cpu: The vcpu to look at.
+ *
+ * Returns: The percentage set with cpu_throttle_set_vcpu, or 0.
+ */
+int cpu_throttle_get_vcpu_percentage(CPUState *cpu);
+
+/**
+ * cpu_dirty_accounting_enabled:
+ *
+ * Returns: %true if the accelerator reports which vcpu dirtied guest
+ * memory through cpu_dirty_pages_add, %false otherwise.
+ */
+bool cpu_dirty_accounting_enabled(void);
+
+/**
+ * cpu_dirty_pages_add:
+ * @cpu: The vcpu that wrote to guest memory.
+ * @pages: Number of target pages it dirtied.
+ *
+ * Account pages that became dirty for migration because of @cpu.
+ */
+static inline void cpu_dirty_pages_add(CPUState *cpu, unsigned long pages)
+{
+    atomic_add(&cpu->dirty_pages, pages);
+}
+
+/**
+ * cpu_dirty_pages_harvest:
+ * @cpu: The vcpu to look at.
+ *
+ * Returns: The number of pages @cpu dirtied since the previous call.
+ */
+static inline unsigned long cpu_dirty_pages_harvest(CPUState *cpu)
+{
+    return atomic_xchg(&cpu->dirty_pages, 0);
+}
+
 #ifndef CONFIG_USER_ONLY
 
 typedef void (*CPUInterruptHandler)(CPUState *, int);
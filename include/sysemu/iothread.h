@@ -15,6 +15,8 @@
 #define IOTHREAD_H
 
 #include "block/aio.h"
+#include "block/thread-pool.h"
+#include "qemu/bitmap.h"
 #include "qemu/thread.h"
 
 #define TYPE_IOTHREAD "iothread"
@@ -37,6 +39,12 @@ typedef struct {
     int64_t poll_max_ns;
     int64_t poll_grow;
     int64_t poll_shrink;
+
+    /* Thread pool parameters */
+    int64_t thread_pool_min;
+    int64_t thread_pool_max;
+    DECLARE_BITMAP(thread_pool_cpus, THREAD_POOL_MAX_CPUS);
+    DECLARE_BITMAP(thread_pool_host_nodes, THREAD_POOL_MAX_CPUS);
 } IOThread;
 
 #define IOTHREAD(obj) \
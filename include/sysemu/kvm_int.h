@@ -20,6 +20,8 @@ typedef struct KVMSlot
     void *ram;
     int slot;
     int flags;
+    /* ram_addr_t of the first page, to feed the dirty ring */
+    ram_addr_t ram_start_offset;
 } KVMSlot;
 
 typedef struct KVMMemoryListener {
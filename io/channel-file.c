@@ -168,6 +168,65 @@ static off_t qio_channel_file_seek(QIOChannel *ioc,
 }
 
 
+#ifndef _WIN32
+static ssize_t qio_channel_file_pwrite(QIOChannel *ioc,
+                                       const char *buf,
+                                       size_t buflen,
+                                       off_t offset,
+                                       Error **errp)
+{
+    QIOChannelFile *fioc = QIO_CHANNEL_FILE(ioc);
+    ssize_t done = 0;
+
+    while (done < buflen) {
+        ssize_t ret = pwrite(fioc->fd, buf + done, buflen - done,
+                             offset + done);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error_setg_errno(errp, errno,
+                             "Unable to write to file at offset %lld",
+                             (long long int)(offset + done));
+            return -1;
+        }
+        done += ret;
+    }
+    return done;
+}
+
+
+static ssize_t qio_channel_file_pread(QIOChannel *ioc,
+                                      char *buf,
+                                      size_t buflen,
+                                      off_t offset,
+                                      Error **errp)
+{
+    QIOChannelFile *fioc = QIO_CHANNEL_FILE(ioc);
+    ssize_t done = 0;
+
+    while (done < buflen) {
+        ssize_t ret = pread(fioc->fd, buf + done, buflen - done,
+                            offset + done);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error_setg_errno(errp, errno,
+                             "Unable to read from file at offset %lld",
+                             (long long int)(offset + done));
+            return -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+        done += ret;
+    }
+    return done;
+}
+#endif /* ! _WIN32 */
+
+
 static int qio_channel_file_close(QIOChannel *ioc,
                                   Error **errp)
 {
@@ -211,6 +270,10 @@ static void qio_channel_file_class_init(ObjectClass *klass,
     ioc_klass->io_readv = qio_channel_file_readv;
     ioc_klass->io_set_blocking = qio_channel_file_set_blocking;
     ioc_klass->io_seek = qio_channel_file_seek;
+#ifndef _WIN32
+    ioc_klass->io_pwrite = qio_channel_file_pwrite;
+    ioc_klass->io_pread = qio_channel_file_pread;
+#endif
     ioc_klass->io_close = qio_channel_file_close;
     ioc_klass->io_create_watch = qio_channel_file_create_watch;
     ioc_klass->io_set_aio_fd_handler = qio_channel_file_set_aio_fd_handler;
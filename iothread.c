@@ -19,11 +19,17 @@
 #include "block/block.h"
 #include "sysemu/iothread.h"
 #include "qapi/error.h"
+#include "qapi/qapi-builtin-visit.h"
 #include "qapi/qapi-commands-misc.h"
+#include "qapi/visitor.h"
 #include "qemu/error-report.h"
 #include "qemu/rcu.h"
 #include "qemu/main-loop.h"
 
+#ifdef CONFIG_NUMA
+#include <numa.h>
+#endif
+
 typedef ObjectClass IOThreadClass;
 
 #define IOTHREAD_GET_CLASS(obj) \
@@ -106,6 +112,7 @@ static void iothread_instance_init(Object *obj)
     IOThread *iothread = IOTHREAD(obj);
 
     iothread->poll_max_ns = IOTHREAD_POLL_MAX_NS_DEFAULT;
+    iothread->thread_pool_max = 64;
 }
 
 static void iothread_instance_finalize(Object *obj)
@@ -125,6 +132,67 @@ static void iothread_instance_finalize(Object *obj)
     aio_context_unref(iothread->ctx);
 }
 
+#ifdef CONFIG_NUMA
+static void iothread_add_host_node_cpus(IOThread *iothread,
+                                        unsigned long *cpus, Error **errp)
+{
+    struct bitmask *mask;
+    unsigned int cpu;
+    long node;
+
+    if (numa_available() < 0) {
+        error_setg(errp, "host NUMA topology is not available");
+        return;
+    }
+
+    mask = numa_allocate_cpumask();
+    for (node = find_first_bit(iothread->thread_pool_host_nodes,
+                               THREAD_POOL_MAX_CPUS);
+         node < THREAD_POOL_MAX_CPUS;
+         node = find_next_bit(iothread->thread_pool_host_nodes,
+                              THREAD_POOL_MAX_CPUS, node + 1)) {
+        if (numa_node_to_cpus(node, mask) < 0) {
+            error_setg_errno(errp, errno, "cannot get CPUs of host node %ld",
+                             node);
+            break;
+        }
+        for (cpu = 0; cpu < mask->size && cpu < THREAD_POOL_MAX_CPUS; cpu++) {
+            if (numa_bitmask_isbitset(mask, cpu)) {
+                set_bit(cpu, cpus);
+            }
+        }
+    }
+    numa_free_cpumask(mask);
+}
+#endif
+
+static void iothread_set_thread_pool_params(IOThread *iothread, Error **errp)
+{
+    Error *local_err = NULL;
+    unsigned long *cpus = NULL;
+
+    if (!bitmap_empty(iothread->thread_pool_cpus, THREAD_POOL_MAX_CPUS) ||
+        !bitmap_empty(iothread->thread_pool_host_nodes,
+                      THREAD_POOL_MAX_CPUS)) {
+        cpus = bitmap_new(THREAD_POOL_MAX_CPUS);
+        bitmap_copy(cpus, iothread->thread_pool_cpus, THREAD_POOL_MAX_CPUS);
+#ifdef CONFIG_NUMA
+        iothread_add_host_node_cpus(iothread, cpus, &local_err);
+        if (local_err) {
+            goto out;
+        }
+#endif
+    }
+
+    aio_context_set_thread_pool_params(iothread->ctx,
+                                       iothread->thread_pool_min,
+                                       iothread->thread_pool_max,
+                                       cpus, &local_err);
+out:
+    g_free(cpus);
+    error_propagate(errp, local_err);
+}
+
 static void iothread_complete(UserCreatable *obj, Error **errp)
 {
     Error *local_error = NULL;
@@ -145,6 +213,9 @@ static void iothread_complete(UserCreatable *obj, Error **errp)
                                 iothread->poll_grow,
                                 iothread->poll_shrink,
                                 &local_error);
+    if (!local_error) {
+        iothread_set_thread_pool_params(iothread, &local_error);
+    }
     if (local_error) {
         error_propagate(errp, local_error);
         aio_context_unref(iothread->ctx);
@@ -234,6 +305,123 @@ out:
     error_propagate(errp, local_err);
 }
 
+static PollParamInfo thread_pool_min_info = {
+    "thread-pool-min", offsetof(IOThread, thread_pool_min),
+};
+static PollParamInfo thread_pool_max_info = {
+    "thread-pool-max", offsetof(IOThread, thread_pool_max),
+};
+
+static void iothread_set_thread_pool_param(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    PollParamInfo *info = opaque;
+    int64_t *field = (void *)iothread + info->offset;
+    Error *local_err = NULL;
+    int64_t value, old;
+
+    visit_type_int64(v, name, &value, &local_err);
+    if (local_err) {
+        goto out;
+    }
+
+    old = *field;
+    *field = value;
+
+    if (iothread->ctx) {
+        iothread_set_thread_pool_params(iothread, &local_err);
+        if (local_err) {
+            *field = old;
+        }
+    }
+
+out:
+    error_propagate(errp, local_err);
+}
+
+typedef struct {
+    const char *name;
+    ptrdiff_t offset; /* bitmap's byte offset in IOThread struct */
+} CPUListParamInfo;
+
+static CPUListParamInfo thread_pool_cpus_info = {
+    "thread-pool-cpus", offsetof(IOThread, thread_pool_cpus),
+};
+static CPUListParamInfo thread_pool_host_nodes_info = {
+    "thread-pool-host-nodes", offsetof(IOThread, thread_pool_host_nodes),
+};
+
+static void iothread_get_cpu_list(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    CPUListParamInfo *info = opaque;
+    unsigned long *bitmap = (void *)iothread + info->offset;
+    uint16List *list = NULL;
+    uint16List **node = &list;
+    long value;
+
+    for (value = find_first_bit(bitmap, THREAD_POOL_MAX_CPUS);
+         value < THREAD_POOL_MAX_CPUS;
+         value = find_next_bit(bitmap, THREAD_POOL_MAX_CPUS, value + 1)) {
+        *node = g_malloc0(sizeof(**node));
+        (*node)->value = value;
+        node = &(*node)->next;
+    }
+
+    visit_type_uint16List(v, name, &list, errp);
+    qapi_free_uint16List(list);
+}
+
+static void iothread_set_cpu_list(Object *obj, Visitor *v,
+        const char *name, void *opaque, Error **errp)
+{
+    IOThread *iothread = IOTHREAD(obj);
+    CPUListParamInfo *info = opaque;
+    unsigned long *bitmap = (void *)iothread + info->offset;
+    DECLARE_BITMAP(old, THREAD_POOL_MAX_CPUS);
+    Error *local_err = NULL;
+    uint16List *list = NULL, *l;
+
+#ifndef CONFIG_NUMA
+    if (info == &thread_pool_host_nodes_info) {
+        error_setg(errp, "NUMA node binding is not supported by this QEMU");
+        return;
+    }
+#endif
+
+    visit_type_uint16List(v, name, &list, &local_err);
+    if (local_err) {
+        goto out;
+    }
+
+    for (l = list; l; l = l->next) {
+        if (l->value >= THREAD_POOL_MAX_CPUS) {
+            error_setg(&local_err, "%s values must be less than %d",
+                       info->name, THREAD_POOL_MAX_CPUS);
+            goto out;
+        }
+    }
+
+    bitmap_copy(old, bitmap, THREAD_POOL_MAX_CPUS);
+    bitmap_zero(bitmap, THREAD_POOL_MAX_CPUS);
+    for (l = list; l; l = l->next) {
+        set_bit(l->value, bitmap);
+    }
+
+    if (iothread->ctx) {
+        iothread_set_thread_pool_params(iothread, &local_err);
+        if (local_err) {
+            bitmap_copy(bitmap, old, THREAD_POOL_MAX_CPUS);
+        }
+    }
+
+out:
+    qapi_free_uint16List(list);
+    error_propagate(errp, local_err);
+}
+
 static void iothread_class_init(ObjectClass *klass, void *class_data)
 {
     UserCreatableClass *ucc = USER_CREATABLE_CLASS(klass);
@@ -251,6 +439,23 @@ static void iothread_class_init(ObjectClass *klass, void *class_data)
                               iothread_get_poll_param,
                               iothread_set_poll_param,
                               NULL, &poll_shrink_info, &error_abort);
+    object_class_property_add(klass, "thread-pool-min", "int",
+                              iothread_get_poll_param,
+                              iothread_set_thread_pool_param,
+                              NULL, &thread_pool_min_info, &error_abort);
+    object_class_property_add(klass, "thread-pool-max", "int",
+                              iothread_get_poll_param,
+                              iothread_set_thread_pool_param,
+                              NULL, &thread_pool_max_info, &error_abort);
+    object_class_property_add(klass, "thread-pool-cpus", "uint16List",
+                              iothread_get_cpu_list,
+                              iothread_set_cpu_list,
+                              NULL, &thread_pool_cpus_info, &error_abort);
+    object_class_property_add(klass, "thread-pool-host-nodes", "uint16List",
+                              iothread_get_cpu_list,
+                              iothread_set_cpu_list,
+                              NULL, &thread_pool_host_nodes_info,
+                              &error_abort);
 }
 
 static const TypeInfo iothread_info = {
@@ -289,6 +494,7 @@ static int query_one_iothread(Object *object, void *opaque)
     IOThreadInfoList *elem;
     IOThreadInfo *info;
     IOThread *iothread;
+    ThreadPool *pool = NULL;
 
     iothread = (IOThread *)object_dynamic_cast(object, TYPE_IOTHREAD);
     if (!iothread) {
@@ -301,6 +507,28 @@ static int query_one_iothread(Object *object, void *opaque)
     info->poll_max_ns = iothread->poll_max_ns;
     info->poll_grow = iothread->poll_grow;
     info->poll_shrink = iothread->poll_shrink;
+    if (iothread->ctx) {
+        info->poll_hits = atomic_read__nocheck(&iothread->ctx->poll_hits);
+        info->poll_misses = atomic_read__nocheck(&iothread->ctx->poll_misses);
+        info->poll_time_ns = atomic_read__nocheck(&iothread->ctx->poll_time_ns);
+        pool = atomic_rcu_read(&iothread->ctx->thread_pool);
+    }
+    if (pool) {
+        ThreadPoolStats stats;
+
+        thread_pool_get_stats(pool, &stats);
+        info->has_thread_pool = true;
+        info->thread_pool = g_new0(ThreadPoolInfo, 1);
+        info->thread_pool->min_threads = stats.min_threads;
+        info->thread_pool->max_threads = stats.max_threads;
+        info->thread_pool->threads = stats.threads;
+        info->thread_pool->queue_depth = stats.queue_depth;
+        info->thread_pool->max_queue_depth = stats.max_queue_depth;
+        info->thread_pool->requests = stats.requests;
+        info->thread_pool->steals = stats.steals;
+        info->thread_pool->queue_time_ns = stats.queue_ns;
+        info->thread_pool->run_time_ns = stats.run_ns;
+    }
 
     elem = g_new0(IOThreadInfoList, 1);
     elem->value = info;
@@ -29,6 +29,7 @@
 #include "qemu/help_option.h"
 #include "cpu.h"
 #include "exec/exec-all.h"
+#include "exec/tb-cache.h"
 #include "tcg.h"
 #include "qemu/timer.h"
 #include "qemu/envlist.h"
@@ -45,6 +46,7 @@ static const char *argv0;
 static int gdbstub_port;
 static envlist_t *envlist;
 static const char *cpu_model;
+static const char *tb_cache_dir;
 unsigned long mmap_min_addr;
 unsigned long guest_base;
 int have_guest_base;
@@ -4168,6 +4170,29 @@ static void handle_arg_version(const char *arg)
     exit(EXIT_SUCCESS);
 }
 
+static void handle_arg_tb_cache(const char *arg)
+{
+#ifdef PIE
+    /* Cached code embeds host addresses, which move with every run */
+    fprintf(stderr, "-tb-cache is not supported by PIE builds of QEMU\n");
+    exit(EXIT_FAILURE);
+#else
+    tb_cache_dir = strdup(arg);
+#endif
+}
+
+static void handle_arg_regalloc(const char *arg)
+{
+    if (strcmp(arg, "greedy") == 0) {
+        tcg_regalloc_mode = TCG_REGALLOC_GREEDY;
+    } else if (strcmp(arg, "spill-cost") == 0) {
+        tcg_regalloc_mode = TCG_REGALLOC_SPILL_COST;
+    } else {
+        fprintf(stderr, "Invalid register allocator: %s\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
 static char *trace_file;
 static void handle_arg_trace(const char *arg)
 {
@@ -4226,6 +4251,10 @@ static const struct qemu_argument arg_table[] = {
      "",           "Seed for pseudo-random number generator"},
     {"trace",      "QEMU_TRACE",       true,  handle_arg_trace,
      "",           "[[enable=]<pattern>][,events=<file>][,file=<file>]"},
+    {"tb-cache",   "QEMU_TB_CACHE",    true,  handle_arg_tb_cache,
+     "dir",        "keep translated code in trusted 'dir' across runs"},
+    {"regalloc",   "QEMU_REGALLOC",    true,  handle_arg_regalloc,
+     "mode",       "TCG register allocator (greedy or spill-cost)"},
     {"version",    "QEMU_VERSION",     false, handle_arg_version,
      "",           "display version information and exit"},
     {NULL, NULL, false, NULL, NULL, NULL}
@@ -4581,6 +4610,7 @@ int main(int argc, char **argv, char **envp)
        the real value of GUEST_BASE into account.  */
     tcg_prologue_init(tcg_ctx);
     tcg_region_init();
+    tb_cache_init(tb_cache_dir, filename, cpu_model, info->load_addr);
 
 #if defined(TARGET_I386)
     env->cr[0] = CR0_PG_MASK | CR0_WP_MASK | CR0_PE_MASK;
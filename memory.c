@@ -36,6 +36,9 @@
 
 //#define DEBUG_UNASSIGNED
 
+/* Compare every incrementally updated FlatView with a full render.  */
+//#define DEBUG_FLATVIEW_UPDATE
+
 static unsigned memory_region_transaction_depth;
 static bool memory_region_update_pending;
 static bool ioeventfd_update_pending;
@@ -100,6 +103,63 @@ static AddrRange addrrange_intersection(AddrRange r1, AddrRange r2)
     return addrrange_make(start, int128_sub(end, start));
 }
 
+/*
+ * Parts of the memory topology that changed in the current transaction.
+ * Each change covers @range in the address space of @frame, i.e. with
+ * @frame's own start at address zero; it is usually the extent of a
+ * subregion within its container.  When the transaction is committed,
+ * only the corresponding parts of the existing FlatViews are rendered
+ * again.  Changes that cannot be described this way, or too many of
+ * them, force a full render.
+ */
+typedef struct MemoryTopologyChange {
+    MemoryRegion *frame;
+    AddrRange range;
+} MemoryTopologyChange;
+
+#define MAX_TOPOLOGY_CHANGES 64
+#define MAX_DIRTY_RANGES     64
+
+static MemoryTopologyChange topology_changes[MAX_TOPOLOGY_CHANGES];
+static unsigned topology_changes_nb;
+static bool topology_full_render;
+
+static unsigned flatview_renders_full;
+static unsigned flatview_renders_incremental;
+static unsigned flatview_renders_unchanged;
+
+static void memory_region_update_pending_all(void)
+{
+    memory_region_update_pending = true;
+    topology_full_render = true;
+}
+
+static void memory_region_update_pending_range(MemoryRegion *frame,
+                                               AddrRange range)
+{
+    memory_region_update_pending = true;
+    if (topology_changes_nb == MAX_TOPOLOGY_CHANGES) {
+        topology_full_render = true;
+        return;
+    }
+    topology_changes[topology_changes_nb].frame = frame;
+    topology_changes[topology_changes_nb].range = range;
+    topology_changes_nb++;
+}
+
+/* Everything that @mr covers is about to change, or has changed.  */
+static void memory_region_update_pending_region(MemoryRegion *mr)
+{
+    if (mr->container) {
+        memory_region_update_pending_range(mr->container,
+            addrrange_make(int128_make64(mr->addr), mr->size));
+    }
+
+    /* Aliases to @mr do not go through its container.  */
+    memory_region_update_pending_range(mr,
+        addrrange_make(int128_zero(), mr->size));
+}
+
 enum ListenerDirection { Forward, Reverse };
 
 #define MEMORY_LISTENER_CALL_GLOBAL(_callback, _direction, _args...)    \
@@ -616,6 +676,23 @@ static AddressSpace *memory_region_to_address_space(MemoryRegion *mr)
     return NULL;
 }
 
+/* Return the index of the first range in @view that ends after @addr.  */
+static unsigned flatview_find_first_after(FlatView *view, Int128 addr)
+{
+    unsigned lo = 0, hi = view->nr;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+
+        if (int128_le(addrrange_end(view->ranges[mid].addr), addr)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 /* Render a memory region into the global view.  Ranges in @view obscure
  * ranges in @mr.
  */
@@ -674,7 +751,8 @@ static void render_memory_region(FlatView *view,
     fr.readonly = readonly;
 
     /* Render the region itself into any gaps left by the current view. */
-    for (i = 0; i < view->nr && int128_nz(remain); ++i) {
+    for (i = flatview_find_first_after(view, base);
+         i < view->nr && int128_nz(remain); ++i) {
         if (int128_ge(base, addrrange_end(view->ranges[i].addr))) {
             continue;
         }
@@ -747,10 +825,26 @@ static MemoryRegion *memory_region_get_flatview_root(MemoryRegion *mr)
     return NULL;
 }
 
+/* Build the dispatch tree of a freshly rendered view and publish it.  */
+static void flatview_finish(FlatView *view)
+{
+    int i;
+
+    flatview_simplify(view);
+
+    view->dispatch = address_space_dispatch_new(view);
+    for (i = 0; i < view->nr; i++) {
+        MemoryRegionSection mrs =
+            section_from_flat_range(&view->ranges[i], view);
+        flatview_add_to_dispatch(view, &mrs);
+    }
+    address_space_dispatch_compact(view->dispatch);
+    g_hash_table_replace(flat_views, view->root, view);
+}
+
 /* Render a memory topology into a list of disjoint absolute ranges. */
 static FlatView *generate_memory_topology(MemoryRegion *mr)
 {
-    int i;
     FlatView *view;
 
     view = flatview_new(mr);
@@ -759,19 +853,227 @@ static FlatView *generate_memory_topology(MemoryRegion *mr)
         render_memory_region(view, mr, int128_zero(),
                              addrrange_make(int128_zero(), int128_2_64()), false);
     }
+    flatview_finish(view);
+    flatview_renders_full++;
+    trace_flatview_render_full(view, mr);
+
+    return view;
+}
+
+/* Find where the frames of the pending topology changes appear below
+ * @mr, walking the tree in the same way as render_memory_region, and
+ * add the changed ranges to @dirty in absolute addresses.
+ */
+static void flatview_collect_dirty(MemoryRegion *mr, Int128 base,
+                                   AddrRange clip, GArray *dirty)
+{
+    MemoryRegion *subregion;
+    AddrRange tmp;
+    unsigned i;
+
+    int128_addto(&base, int128_make64(mr->addr));
+
+    /* Use the clip of the container, so that changes to the size of
+     * @mr itself are covered as well.
+     */
+    for (i = 0; i < topology_changes_nb; i++) {
+        if (topology_changes[i].frame == mr) {
+            tmp = addrrange_shift(topology_changes[i].range, base);
+            if (addrrange_intersects(tmp, clip)) {
+                tmp = addrrange_intersection(tmp, clip);
+                g_array_append_val(dirty, tmp);
+            }
+        }
+    }
+
+    if (!mr->enabled) {
+        return;
+    }
+
+    tmp = addrrange_make(base, mr->size);
+    if (!addrrange_intersects(tmp, clip)) {
+        return;
+    }
+    clip = addrrange_intersection(tmp, clip);
+
+    if (mr->alias) {
+        int128_subfrom(&base, int128_make64(mr->alias->addr));
+        int128_subfrom(&base, int128_make64(mr->alias_offset));
+        flatview_collect_dirty(mr->alias, base, clip, dirty);
+        return;
+    }
+
+    QTAILQ_FOREACH(subregion, &mr->subregions, subregions_link) {
+        flatview_collect_dirty(subregion, base, clip, dirty);
+    }
+}
+
+static gint addrrange_compare_start(gconstpointer a, gconstpointer b)
+{
+    const AddrRange *r1 = a, *r2 = b;
+
+    if (int128_lt(r1->start, r2->start)) {
+        return -1;
+    }
+    return int128_eq(r1->start, r2->start) ? 0 : 1;
+}
+
+/* Sort @dirty and merge overlapping or adjacent ranges.  */
+static void addrrange_array_normalize(GArray *dirty)
+{
+    AddrRange *r;
+    unsigned i, j;
+
+    g_array_sort(dirty, addrrange_compare_start);
+    r = &g_array_index(dirty, AddrRange, 0);
+    for (i = 0, j = 1; j < dirty->len; j++) {
+        if (int128_ge(addrrange_end(r[i]), r[j].start)) {
+            Int128 end = int128_max(addrrange_end(r[i]), addrrange_end(r[j]));
+            r[i].size = int128_sub(end, r[i].start);
+        } else {
+            r[++i] = r[j];
+        }
+    }
+    if (dirty->len) {
+        g_array_set_size(dirty, i + 1);
+    }
+}
+
+/* Append to @view the part of @fr between @start and @end.  */
+static void flatview_append_slice(FlatView *view, FlatRange *fr,
+                                  Int128 start, Int128 end)
+{
+    FlatRange slice = *fr;
+
+    slice.offset_in_region += int128_get64(int128_sub(start,
+                                                      fr->addr.start));
+    slice.addr = addrrange_make(start, int128_sub(end, start));
+    flatview_insert(view, view->nr, &slice);
+}
+
+static bool flatview_equal(FlatView *a, FlatView *b)
+{
+    unsigned i;
+
+    if (a->nr != b->nr) {
+        return false;
+    }
+    for (i = 0; i < a->nr; i++) {
+        if (!flatrange_equal(&a->ranges[i], &b->ranges[i])
+            || a->ranges[i].dirty_log_mask != b->ranges[i].dirty_log_mask) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Bring @old_view up to date with the pending topology changes.  The
+ * ranges of @old_view outside the changed parts are copied, and only
+ * the changed parts are rendered again.  Finding them still walks the
+ * whole tree, because an alias anywhere may map a changed region, and
+ * the dispatch tree of the new view is still built in full.
+ * FlatViews are visible to RCU readers, so this builds a new view (and
+ * dispatch tree) rather than modifying @old_view; if nothing changed,
+ * @old_view is used again.  Returns NULL if the changes are too
+ * scattered to be worth it.
+ */
+static FlatView *update_memory_topology(FlatView *old_view)
+{
+    MemoryRegion *mr = old_view->root;
+    GArray *dirty = g_array_new(false, false, sizeof(AddrRange));
+    AddrRange *d;
+    FlatView *view;
+    FlatRange *fr;
+    Int128 start, end;
+    unsigned i, j;
+
+    flatview_collect_dirty(mr, int128_zero(),
+                           addrrange_make(int128_zero(), int128_2_64()),
+                           dirty);
+    addrrange_array_normalize(dirty);
+    if (dirty->len > MAX_DIRTY_RANGES) {
+        g_array_free(dirty, true);
+        return NULL;
+    }
+
+    if (dirty->len == 0) {
+        view = old_view;
+        goto unchanged;
+    }
+
+    view = flatview_new(mr);
+    d = &g_array_index(dirty, AddrRange, 0);
+
+    /* Copy the old ranges, minus the dirty ones.  */
+    j = 0;
+    FOR_EACH_FLAT_RANGE(fr, old_view) {
+        start = fr->addr.start;
+        end = addrrange_end(fr->addr);
+        while (j < dirty->len && int128_le(addrrange_end(d[j]), start)) {
+            j++;
+        }
+        for (i = j; i < dirty->len && int128_lt(d[i].start, end); i++) {
+            if (int128_lt(start, d[i].start)) {
+                flatview_append_slice(view, fr, start, d[i].start);
+            }
+            start = int128_max(start, addrrange_end(d[i]));
+        }
+        if (int128_lt(start, end)) {
+            flatview_append_slice(view, fr, start, end);
+        }
+    }
+
+    /* The copied ranges do not intersect the dirty ones, so rendering
+     * each dirty range fills it exactly as a full render would.
+     */
+    for (i = 0; i < dirty->len; i++) {
+        render_memory_region(view, mr, int128_zero(), d[i], false);
+    }
     flatview_simplify(view);
 
-    view->dispatch = address_space_dispatch_new(view);
-    for (i = 0; i < view->nr; i++) {
-        MemoryRegionSection mrs =
-            section_from_flat_range(&view->ranges[i], view);
-        flatview_add_to_dispatch(view, &mrs);
+    if (flatview_equal(view, old_view)) {
+        flatview_destroy(view);
+        view = old_view;
+        goto unchanged;
     }
-    address_space_dispatch_compact(view->dispatch);
-    g_hash_table_replace(flat_views, mr, view);
 
+    flatview_finish(view);
+    flatview_renders_incremental++;
+    trace_flatview_render_incremental(view, mr, dirty->len);
+    g_array_free(dirty, true);
     return view;
+
+unchanged:
+    flatview_ref(view);
+    g_hash_table_replace(flat_views, mr, view);
+    flatview_renders_unchanged++;
+    trace_flatview_render_unchanged(view, mr);
+    g_array_free(dirty, true);
+    return view;
+}
+
+#ifdef DEBUG_FLATVIEW_UPDATE
+/* Abort if @view, as returned by update_memory_topology, differs from
+ * what generate_memory_topology would have rendered.
+ */
+static void flatview_check_update(FlatView *view)
+{
+    FlatView *full = flatview_new(view->root);
+    bool equal;
+
+    render_memory_region(full, view->root, int128_zero(),
+                         addrrange_make(int128_zero(), int128_2_64()), false);
+    flatview_simplify(full);
+    equal = flatview_equal(view, full);
+    flatview_destroy(full);
+
+    if (!equal) {
+        error_report("incremental update of the FlatView for %s is wrong",
+                     memory_region_name(view->root));
+        abort();
+    }
 }
+#endif
 
 static void address_space_add_del_ioeventfds(AddressSpace *as,
                                              MemoryRegionIoeventfd *fds_new,
@@ -871,6 +1173,33 @@ static void address_space_update_ioeventfds(AddressSpace *as)
     flatview_unref(view);
 }
 
+static void flat_range_coalesced_io_del(FlatRange *fr, AddressSpace *as)
+{
+    MEMORY_LISTENER_UPDATE_REGION(fr, as, Reverse, coalesced_io_del,
+                                  int128_get64(fr->addr.start),
+                                  int128_get64(fr->addr.size));
+}
+
+static void flat_range_coalesced_io_add(FlatRange *fr, AddressSpace *as)
+{
+    MemoryRegion *mr = fr->mr;
+    CoalescedMemoryRange *cmr;
+    AddrRange tmp;
+
+    QTAILQ_FOREACH(cmr, &mr->coalesced, link) {
+        tmp = addrrange_shift(cmr->addr,
+                              int128_sub(fr->addr.start,
+                                         int128_make64(fr->offset_in_region)));
+        if (!addrrange_intersects(tmp, fr->addr)) {
+            continue;
+        }
+        tmp = addrrange_intersection(tmp, fr->addr);
+        MEMORY_LISTENER_UPDATE_REGION(fr, as, Forward, coalesced_io_add,
+                                      int128_get64(tmp.start),
+                                      int128_get64(tmp.size));
+    }
+}
+
 static void address_space_update_topology_pass(AddressSpace *as,
                                                const FlatView *old_view,
                                                const FlatView *new_view,
@@ -903,6 +1232,9 @@ static void address_space_update_topology_pass(AddressSpace *as,
             /* In old but not in new, or in both but attributes changed. */
 
             if (!adding) {
+                if (!QTAILQ_EMPTY(&frold->mr->coalesced)) {
+                    flat_range_coalesced_io_del(frold, as);
+                }
                 MEMORY_LISTENER_UPDATE_REGION(frold, as, Reverse, region_del);
             }
 
@@ -931,6 +1263,7 @@ static void address_space_update_topology_pass(AddressSpace *as,
 
             if (adding) {
                 MEMORY_LISTENER_UPDATE_REGION(frnew, as, Forward, region_add);
+                flat_range_coalesced_io_add(frnew, as);
             }
 
             ++inew;
@@ -961,23 +1294,42 @@ static void flatviews_init(void)
 static void flatviews_reset(void)
 {
     AddressSpace *as;
+    GHashTable *old_views = flat_views;
 
-    if (flat_views) {
-        g_hash_table_unref(flat_views);
-        flat_views = NULL;
-    }
+    flat_views = NULL;
     flatviews_init();
 
     /* Render unique FVs */
     QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
         MemoryRegion *physmr = memory_region_get_flatview_root(as->root);
+        FlatView *old_view = NULL;
 
         if (g_hash_table_lookup(flat_views, physmr)) {
             continue;
         }
 
+        if (old_views && !topology_full_render) {
+            old_view = g_hash_table_lookup(old_views, physmr);
+        }
+        if (old_view) {
+            FlatView *view = update_memory_topology(old_view);
+
+            if (view) {
+#ifdef DEBUG_FLATVIEW_UPDATE
+                flatview_check_update(view);
+#endif
+                continue;
+            }
+        }
+
         generate_memory_topology(physmr);
     }
+
+    if (old_views) {
+        g_hash_table_unref(old_views);
+    }
+    topology_changes_nb = 0;
+    topology_full_render = false;
 }
 
 static void address_space_set_flatview(AddressSpace *as)
@@ -1930,7 +2282,10 @@ void memory_region_set_log(MemoryRegion *mr, bool log, unsigned client)
 
     memory_region_transaction_begin();
     mr->dirty_log_mask = (mr->dirty_log_mask & ~mask) | (log * mask);
-    memory_region_update_pending |= mr->enabled;
+    if (mr->enabled) {
+        memory_region_update_pending_range(mr,
+            addrrange_make(int128_zero(), mr->size));
+    }
     memory_region_transaction_commit();
 }
 
@@ -1964,6 +2319,11 @@ static void memory_region_sync_dirty_bitmap(MemoryRegion *mr)
      * address space once.
      */
     QTAILQ_FOREACH(listener, &memory_listeners, link) {
+        if (listener->log_sync_global) {
+            /* Only the global sync done by migration needs to be exact */
+            listener->log_sync_global(listener, !mr);
+            continue;
+        }
         if (!listener->log_sync) {
             continue;
         }
@@ -2003,7 +2363,10 @@ void memory_region_set_readonly(MemoryRegion *mr, bool readonly)
     if (mr->readonly != readonly) {
         memory_region_transaction_begin();
         mr->readonly = readonly;
-        memory_region_update_pending |= mr->enabled;
+        if (mr->enabled) {
+            memory_region_update_pending_range(mr,
+                addrrange_make(int128_zero(), mr->size));
+        }
         memory_region_transaction_commit();
     }
 }
@@ -2013,7 +2376,10 @@ void memory_region_rom_device_set_romd(MemoryRegion *mr, bool romd_mode)
     if (mr->romd_mode != romd_mode) {
         memory_region_transaction_begin();
         mr->romd_mode = romd_mode;
-        memory_region_update_pending |= mr->enabled;
+        if (mr->enabled) {
+            memory_region_update_pending_range(mr,
+                addrrange_make(int128_zero(), mr->size));
+        }
         memory_region_transaction_commit();
     }
 }
@@ -2081,49 +2447,21 @@ void memory_region_ram_resize(MemoryRegion *mr, ram_addr_t newsize, Error **errp
     qemu_ram_resize(mr->ram_block, newsize, errp);
 }
 
-static void memory_region_update_coalesced_range_as(MemoryRegion *mr, AddressSpace *as)
+static void memory_region_update_coalesced_range(MemoryRegion *mr)
 {
+    AddressSpace *as;
     FlatView *view;
     FlatRange *fr;
-    CoalescedMemoryRange *cmr;
-    AddrRange tmp;
-    MemoryRegionSection section;
 
-    view = address_space_get_flatview(as);
-    FOR_EACH_FLAT_RANGE(fr, view) {
-        if (fr->mr == mr) {
-            section = (MemoryRegionSection) {
-                .fv = view,
-                .offset_within_address_space = int128_get64(fr->addr.start),
-                .size = fr->addr.size,
-            };
-
-            MEMORY_LISTENER_CALL(as, coalesced_mmio_del, Reverse, &section,
-                                 int128_get64(fr->addr.start),
-                                 int128_get64(fr->addr.size));
-            QTAILQ_FOREACH(cmr, &mr->coalesced, link) {
-                tmp = addrrange_shift(cmr->addr,
-                                      int128_sub(fr->addr.start,
-                                                 int128_make64(fr->offset_in_region)));
-                if (!addrrange_intersects(tmp, fr->addr)) {
-                    continue;
-                }
-                tmp = addrrange_intersection(tmp, fr->addr);
-                MEMORY_LISTENER_CALL(as, coalesced_mmio_add, Forward, &section,
-                                     int128_get64(tmp.start),
-                                     int128_get64(tmp.size));
+    QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
+        view = address_space_get_flatview(as);
+        FOR_EACH_FLAT_RANGE(fr, view) {
+            if (fr->mr == mr) {
+                flat_range_coalesced_io_del(fr, as);
+                flat_range_coalesced_io_add(fr, as);
             }
         }
-    }
-    flatview_unref(view);
-}
-
-static void memory_region_update_coalesced_range(MemoryRegion *mr)
-{
-    AddressSpace *as;
-
-    QTAILQ_FOREACH(as, &address_spaces, address_spaces_link) {
-        memory_region_update_coalesced_range_as(mr, as);
+        flatview_unref(view);
     }
 }
 
@@ -2278,7 +2616,9 @@ static void memory_region_update_container_subregions(MemoryRegion *subregion)
     }
     QTAILQ_INSERT_TAIL(&mr->subregions, subregion, subregions_link);
 done:
-    memory_region_update_pending |= mr->enabled && subregion->enabled;
+    if (mr->enabled && subregion->enabled) {
+        memory_region_update_pending_region(subregion);
+    }
     memory_region_transaction_commit();
 }
 
@@ -2314,10 +2654,12 @@ void memory_region_del_subregion(MemoryRegion *mr,
 {
     memory_region_transaction_begin();
     assert(subregion->container == mr);
+    if (mr->enabled && subregion->enabled) {
+        memory_region_update_pending_region(subregion);
+    }
     subregion->container = NULL;
     QTAILQ_REMOVE(&mr->subregions, subregion, subregions_link);
     memory_region_unref(subregion);
-    memory_region_update_pending |= mr->enabled && subregion->enabled;
     memory_region_transaction_commit();
 }
 
@@ -2328,7 +2670,7 @@ void memory_region_set_enabled(MemoryRegion *mr, bool enabled)
     }
     memory_region_transaction_begin();
     mr->enabled = enabled;
-    memory_region_update_pending = true;
+    memory_region_update_pending_region(mr);
     memory_region_transaction_commit();
 }
 
@@ -2343,8 +2685,14 @@ void memory_region_set_size(MemoryRegion *mr, uint64_t size)
         return;
     }
     memory_region_transaction_begin();
-    mr->size = s;
-    memory_region_update_pending = true;
+    /* Cover both the old and the new extent.  */
+    if (int128_lt(mr->size, s)) {
+        mr->size = s;
+        memory_region_update_pending_region(mr);
+    } else {
+        memory_region_update_pending_region(mr);
+        mr->size = s;
+    }
     memory_region_transaction_commit();
 }
 
@@ -2366,8 +2714,14 @@ static void memory_region_readd_subregion(MemoryRegion *mr)
 void memory_region_set_address(MemoryRegion *mr, hwaddr addr)
 {
     if (addr != mr->addr) {
+        memory_region_transaction_begin();
+        /* memory_region_readd_subregion only sees the new address.  */
+        if (mr->container && mr->container->enabled && mr->enabled) {
+            memory_region_update_pending_region(mr);
+        }
         mr->addr = addr;
         memory_region_readd_subregion(mr);
+        memory_region_transaction_commit();
     }
 }
 
@@ -2381,7 +2735,10 @@ void memory_region_set_alias_offset(MemoryRegion *mr, hwaddr offset)
 
     memory_region_transaction_begin();
     mr->alias_offset = offset;
-    memory_region_update_pending |= mr->enabled;
+    if (mr->enabled) {
+        memory_region_update_pending_range(mr,
+            addrrange_make(int128_zero(), mr->size));
+    }
     memory_region_transaction_commit();
 }
 
@@ -2504,7 +2861,7 @@ void memory_global_dirty_log_start(void)
 
     /* Refresh DIRTY_LOG_MIGRATION bit.  */
     memory_region_transaction_begin();
-    memory_region_update_pending = true;
+    memory_region_update_pending_all();
     memory_region_transaction_commit();
 }
 
@@ -2514,7 +2871,7 @@ static void memory_global_dirty_log_do_stop(void)
 
     /* Refresh DIRTY_LOG_MIGRATION bit.  */
     memory_region_transaction_begin();
-    memory_region_update_pending = true;
+    memory_region_update_pending_all();
     memory_region_transaction_commit();
 
     MEMORY_LISTENER_CALL_GLOBAL(log_global_stop, Reverse);
@@ -2879,7 +3236,7 @@ static void mtree_print_mr(fprintf_function mon_printf, void *f,
         }
         mon_printf(f, TARGET_FMT_plx "-" TARGET_FMT_plx
                    " (prio %d, %s): alias %s @%s " TARGET_FMT_plx
-                   "-" TARGET_FMT_plx "%s\n",
+                   "-" TARGET_FMT_plx "%s",
                    cur_start, cur_end,
                    mr->priority,
                    memory_region_type((MemoryRegion *)mr),
@@ -2890,13 +3247,18 @@ static void mtree_print_mr(fprintf_function mon_printf, void *f,
                    mr->enabled ? "" : " [disabled]");
     } else {
         mon_printf(f,
-                   TARGET_FMT_plx "-" TARGET_FMT_plx " (prio %d, %s): %s%s\n",
+                   TARGET_FMT_plx "-" TARGET_FMT_plx " (prio %d, %s): %s%s",
                    cur_start, cur_end,
                    mr->priority,
                    memory_region_type((MemoryRegion *)mr),
                    memory_region_name(mr),
                    mr->enabled ? "" : " [disabled]");
     }
+    if (!QTAILQ_EMPTY(&mr->coalesced)) {
+        mon_printf(f, " [coalesced, %" PRIu64 " exits saved]",
+                   mr->coalesced_writes);
+    }
+    mon_printf(f, "\n");
 
     QTAILQ_INIT(&submr_print_queue);
 
@@ -3050,6 +3412,10 @@ void mtree_info(fprintf_function mon_printf, void *f, bool flatview,
         g_hash_table_foreach_remove(views, mtree_info_flatview_free, 0);
         g_hash_table_unref(views);
 
+        mon_printf(f, "FlatView renders: %u full, %u incremental, "
+                   "%u unchanged\n", flatview_renders_full,
+                   flatview_renders_incremental, flatview_renders_unchanged);
+
         return;
     }
 
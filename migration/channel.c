@@ -15,6 +15,7 @@
 #include "tls.h"
 #include "migration.h"
 #include "qemu-file-channel.h"
+#include "qemu-file.h"
 #include "trace.h"
 #include "qapi/error.h"
 #include "io/channel-tls.h"
@@ -76,6 +77,15 @@ void migration_channel_connect(MigrationState *s,
 
             s->to_dst_file = f;
 
+            if (migrate_use_zero_copy_send()) {
+                if (qio_channel_has_feature(ioc,
+                        QIO_CHANNEL_FEATURE_WRITE_ZERO_COPY)) {
+                    qemu_file_set_zero_copy(f, true);
+                } else {
+                    error_setg(&error, "Migration channel does not "
+                               "support zero copy send");
+                }
+            }
         }
     }
     migrate_fd_connect(s, error);
@@ -0,0 +1,159 @@
+/*
+ * QEMU live migration to and from a regular file
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/bswap.h"
+#include "qapi/error.h"
+#include "channel.h"
+#include "file.h"
+#include "migration.h"
+#include "ram.h"
+#include "io/channel-file.h"
+#include "trace.h"
+
+/*
+ * With the mapped-ram capability the file starts with this header,
+ * followed by the fixed RAMBlock regions laid out by ram_mapped_ram_layout()
+ * and then by the regular migration stream at @stream_offset.
+ */
+#define MAPPED_RAM_FILE_MAGIC   0x514d5246 /* "QMRF" */
+#define MAPPED_RAM_FILE_VERSION 1
+#define MAPPED_RAM_HEADER_SIZE  4096
+
+typedef struct QEMU_PACKED MappedRamFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t stream_offset;
+} MappedRamFileHeader;
+
+/*
+ * Open the channels used for random access to the RAM regions.  The
+ * O_DIRECT one is optional, since not every filesystem supports it.
+ */
+static int file_open_mapped_ram(const char *filename, int flags, Error **errp)
+{
+    QIOChannelFile *fioc, *direct_fioc = NULL;
+
+    fioc = qio_channel_file_new_path(filename, flags, 0, errp);
+    if (!fioc) {
+        return -1;
+    }
+    qio_channel_set_name(QIO_CHANNEL(fioc), "migration-file-mapped-ram");
+
+#ifdef O_DIRECT
+    direct_fioc = qio_channel_file_new_path(filename, flags | O_DIRECT, 0,
+                                            NULL);
+    if (direct_fioc) {
+        qio_channel_set_name(QIO_CHANNEL(direct_fioc),
+                             "migration-file-mapped-ram-direct");
+    }
+#endif
+
+    ram_mapped_ram_set_channels(QIO_CHANNEL(fioc),
+                                direct_fioc ? QIO_CHANNEL(direct_fioc) : NULL);
+    object_unref(OBJECT(fioc));
+    if (direct_fioc) {
+        object_unref(OBJECT(direct_fioc));
+    }
+    return 0;
+}
+
+void file_start_outgoing_migration(MigrationState *s, const char *filename,
+                                   Error **errp)
+{
+    QIOChannelFile *fioc;
+    QIOChannel *ioc;
+
+    trace_migration_file_outgoing(filename);
+    fioc = qio_channel_file_new_path(filename, O_CREAT | O_WRONLY | O_TRUNC,
+                                     0600, errp);
+    if (!fioc) {
+        return;
+    }
+    ioc = QIO_CHANNEL(fioc);
+
+    if (migrate_use_mapped_ram()) {
+        MappedRamFileHeader hdr;
+        uint64_t stream_offset;
+
+        if (file_open_mapped_ram(filename, O_WRONLY, errp) < 0) {
+            goto out;
+        }
+        s->mapped_ram_file = true;
+
+        stream_offset = ram_mapped_ram_layout(MAPPED_RAM_HEADER_SIZE);
+        hdr.magic = cpu_to_be32(MAPPED_RAM_FILE_MAGIC);
+        hdr.version = cpu_to_be32(MAPPED_RAM_FILE_VERSION);
+        hdr.stream_offset = cpu_to_be64(stream_offset);
+
+        if (qio_channel_write_all(ioc, (char *)&hdr, sizeof(hdr), errp) < 0 ||
+            qio_channel_io_seek(ioc, stream_offset, SEEK_SET, errp) < 0) {
+            goto out;
+        }
+    }
+
+    qio_channel_set_name(ioc, "migration-file-outgoing");
+    migration_channel_connect(s, ioc, NULL, NULL);
+ out:
+    object_unref(OBJECT(fioc));
+}
+
+static gboolean file_accept_incoming_migration(QIOChannel *ioc,
+                                               GIOCondition condition,
+                                               gpointer opaque)
+{
+    migration_channel_process_incoming(ioc);
+    object_unref(OBJECT(ioc));
+    return G_SOURCE_REMOVE;
+}
+
+void file_start_incoming_migration(const char *filename, Error **errp)
+{
+    QIOChannelFile *fioc;
+    QIOChannel *ioc;
+
+    trace_migration_file_incoming(filename);
+    fioc = qio_channel_file_new_path(filename, O_RDONLY, 0, errp);
+    if (!fioc) {
+        return;
+    }
+    ioc = QIO_CHANNEL(fioc);
+
+    if (migrate_use_mapped_ram()) {
+        MappedRamFileHeader hdr;
+
+        if (qio_channel_read_all(ioc, (char *)&hdr, sizeof(hdr), errp) < 0) {
+            goto fail;
+        }
+        if (be32_to_cpu(hdr.magic) != MAPPED_RAM_FILE_MAGIC) {
+            error_setg(errp, "%s is not a mapped-ram migration file",
+                       filename);
+            goto fail;
+        }
+        if (be32_to_cpu(hdr.version) != MAPPED_RAM_FILE_VERSION) {
+            error_setg(errp, "Unsupported mapped-ram file version %u",
+                       be32_to_cpu(hdr.version));
+            goto fail;
+        }
+        if (file_open_mapped_ram(filename, O_RDONLY, errp) < 0 ||
+            qio_channel_io_seek(ioc, be64_to_cpu(hdr.stream_offset),
+                                SEEK_SET, errp) < 0) {
+            goto fail;
+        }
+    }
+
+    qio_channel_set_name(ioc, "migration-file-incoming");
+    qio_channel_add_watch(ioc,
+                          G_IO_IN,
+                          file_accept_incoming_migration,
+                          NULL,
+                          NULL);
+    return;
+
+ fail:
+    object_unref(OBJECT(fioc));
+}
@@ -19,6 +19,7 @@
 #include "migration/blocker.h"
 #include "exec.h"
 #include "fd.h"
+#include "file.h"
 #include "socket.h"
 #include "rdma.h"
 #include "ram.h"
@@ -42,6 +43,7 @@
 #include "trace.h"
 #include "exec/target_page.h"
 #include "io/channel-buffer.h"
+#include "io/channel-socket.h"
 #include "migration/colo.h"
 #include "hw/boards.h"
 #include "monitor/monitor.h"
@@ -53,6 +55,12 @@
 #define BUFFER_DELAY     100
 #define XFER_LIMIT_RATIO (1000 / BUFFER_DELAY)
 
+/*
+ * Weight of a new BUFFER_DELAY sample in the smoothed bandwidth; a
+ * single 100ms window is too noisy to size the final stage on.
+ */
+#define BANDWIDTH_SMOOTHING 0.25
+
 /* Time in milliseconds we are allowed to stop the source,
  * for sending the last part */
 #define DEFAULT_MIGRATE_SET_DOWNTIME 300
@@ -72,6 +80,9 @@
 #define DEFAULT_MIGRATE_CPU_THROTTLE_INITIAL 20
 #define DEFAULT_MIGRATE_CPU_THROTTLE_INCREMENT 10
 
+/* Define default vcpu dirty rate limit (MB/s) for dirty-limit */
+#define DEFAULT_MIGRATE_VCPU_DIRTY_LIMIT 1
+
 /* Migration XBZRLE default cache size */
 #define DEFAULT_MIGRATE_XBZRLE_CACHE_SIZE (64 * 1024 * 1024)
 
@@ -293,6 +304,8 @@ void qemu_start_incoming_migration(const char *uri, Error **errp)
         unix_start_incoming_migration(p, errp);
     } else if (strstart(uri, "fd:", &p)) {
         fd_start_incoming_migration(p, errp);
+    } else if (strstart(uri, "file:", &p)) {
+        file_start_incoming_migration(p, errp);
     } else {
         error_setg(errp, "unknown migration protocol: %s", uri);
     }
@@ -551,6 +564,8 @@ MigrationParameters *qmp_query_migrate_parameters(Error **errp)
     params->x_multifd_page_count = s->parameters.x_multifd_page_count;
     params->has_xbzrle_cache_size = true;
     params->xbzrle_cache_size = s->parameters.xbzrle_cache_size;
+    params->has_vcpu_dirty_limit = true;
+    params->vcpu_dirty_limit = s->parameters.vcpu_dirty_limit;
 
     return params;
 }
@@ -591,6 +606,8 @@ static void populate_ram_info(MigrationInfo *info, MigrationState *s)
     info->ram->dirty_sync_count = ram_counters.dirty_sync_count;
     info->ram->postcopy_requests = ram_counters.postcopy_requests;
     info->ram->page_size = qemu_target_page_size();
+    info->ram->zero_copy_bytes = ram_counters.zero_copy_bytes;
+    info->ram->zero_copy_fallbacks = ram_counters.zero_copy_fallbacks;
 
     if (migrate_use_xbzrle()) {
         info->has_xbzrle_cache = true;
@@ -650,6 +667,10 @@ MigrationInfo *qmp_query_migrate(Error **errp)
             - s->start_time;
         info->has_expected_downtime = true;
         info->expected_downtime = s->expected_downtime;
+        if (s->expected_converge_time >= 0) {
+            info->has_expected_converge_time = true;
+            info->expected_converge_time = s->expected_converge_time;
+        }
         info->has_setup_time = true;
         info->setup_time = s->setup_time;
 
@@ -719,6 +740,36 @@ static bool migrate_caps_check(bool *cap_list,
     }
 #endif
 
+#ifndef QEMU_MSG_ZEROCOPY
+    if (cap_list[MIGRATION_CAPABILITY_ZERO_COPY_SEND]) {
+        error_setg(errp, "Zero copy send is not supported on this host");
+        return false;
+    }
+#endif
+
+    if (cap_list[MIGRATION_CAPABILITY_MAPPED_RAM]) {
+        /* Pages bypass the stream, so nothing may transform them */
+        if (cap_list[MIGRATION_CAPABILITY_XBZRLE] ||
+            cap_list[MIGRATION_CAPABILITY_COMPRESS] ||
+            cap_list[MIGRATION_CAPABILITY_POSTCOPY_RAM] ||
+            cap_list[MIGRATION_CAPABILITY_X_COLO] ||
+            cap_list[MIGRATION_CAPABILITY_RELEASE_RAM] ||
+            cap_list[MIGRATION_CAPABILITY_ZERO_COPY_SEND] ||
+            cap_list[MIGRATION_CAPABILITY_X_MULTIFD]) {
+            error_setg(errp, "Mapped RAM is not compatible with xbzrle, "
+                       "compress, postcopy-ram, x-colo, release-ram, "
+                       "zero-copy-send or x-multifd");
+            return false;
+        }
+    }
+
+    if (cap_list[MIGRATION_CAPABILITY_DIRTY_LIMIT] &&
+        cap_list[MIGRATION_CAPABILITY_AUTO_CONVERGE]) {
+        error_setg(errp, "dirty-limit and auto-converge are mutually "
+                   "exclusive");
+        return false;
+    }
+
     if (cap_list[MIGRATION_CAPABILITY_POSTCOPY_RAM]) {
         if (cap_list[MIGRATION_CAPABILITY_COMPRESS]) {
             /* The decompression threads asynchronously write into RAM
@@ -856,6 +907,13 @@ static bool migrate_params_check(MigrationParameters *params, Error **errp)
         return false;
     }
 
+    if (params->has_vcpu_dirty_limit && params->vcpu_dirty_limit < 1) {
+        error_setg(errp, QERR_INVALID_PARAMETER_VALUE,
+                   "vcpu_dirty_limit",
+                   "is invalid, it must be at least 1 MB/s");
+        return false;
+    }
+
     return true;
 }
 
@@ -920,6 +978,9 @@ static void migrate_params_test_apply(MigrateSetParameters *params,
     if (params->has_xbzrle_cache_size) {
         dest->xbzrle_cache_size = params->xbzrle_cache_size;
     }
+    if (params->has_vcpu_dirty_limit) {
+        dest->vcpu_dirty_limit = params->vcpu_dirty_limit;
+    }
 }
 
 static void migrate_params_apply(MigrateSetParameters *params, Error **errp)
@@ -992,6 +1053,9 @@ static void migrate_params_apply(MigrateSetParameters *params, Error **errp)
         s->parameters.xbzrle_cache_size = params->xbzrle_cache_size;
         xbzrle_cache_resize(params->xbzrle_cache_size, errp);
     }
+    if (params->has_vcpu_dirty_limit) {
+        s->parameters.vcpu_dirty_limit = params->vcpu_dirty_limit;
+    }
 }
 
 void qmp_migrate_set_parameters(MigrateSetParameters *params, Error **errp)
@@ -1287,6 +1351,7 @@ void migrate_init(MigrationState *s)
     s->start_postcopy = false;
     s->postcopy_after_devices = false;
     s->migration_thread_running = false;
+    s->mapped_ram_file = false;
     error_free(s->error);
     s->error = NULL;
 
@@ -1297,6 +1362,9 @@ void migrate_init(MigrationState *s)
     s->vm_was_running = false;
     s->iteration_initial_bytes = 0;
     s->threshold_size = 0;
+    s->bandwidth = 0;
+    s->pending_size = 0;
+    s->expected_converge_time = -1;
 }
 
 static GSList *migration_blockers;
@@ -1418,6 +1486,8 @@ void qmp_migrate(const char *uri, bool has_blk, bool blk,
         unix_start_outgoing_migration(s, p, &local_err);
     } else if (strstart(uri, "fd:", &p)) {
         fd_start_outgoing_migration(s, p, &local_err);
+    } else if (strstart(uri, "file:", &p)) {
+        file_start_outgoing_migration(s, p, &local_err);
     } else {
         error_setg(errp, QERR_INVALID_PARAMETER_VALUE, "uri",
                    "a valid migration protocol");
@@ -1526,6 +1596,24 @@ bool migrate_auto_converge(void)
     return s->enabled_capabilities[MIGRATION_CAPABILITY_AUTO_CONVERGE];
 }
 
+bool migrate_dirty_limit(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->enabled_capabilities[MIGRATION_CAPABILITY_DIRTY_LIMIT];
+}
+
+uint64_t migrate_vcpu_dirty_limit(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->parameters.vcpu_dirty_limit;
+}
+
 bool migrate_zero_blocks(void)
 {
     MigrationState *s;
@@ -1599,6 +1687,24 @@ bool migrate_pause_before_switchover(void)
         MIGRATION_CAPABILITY_PAUSE_BEFORE_SWITCHOVER];
 }
 
+bool migrate_use_zero_copy_send(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->enabled_capabilities[MIGRATION_CAPABILITY_ZERO_COPY_SEND];
+}
+
+bool migrate_use_mapped_ram(void)
+{
+    MigrationState *s;
+
+    s = migrate_get_current();
+
+    return s->enabled_capabilities[MIGRATION_CAPABILITY_MAPPED_RAM];
+}
+
 int migrate_multifd_channels(void)
 {
     MigrationState *s;
@@ -2199,6 +2305,35 @@ static void migration_calculate_complete(MigrationState *s)
     }
 }
 
+/*
+ * Predict when and how the migration will complete.  The pending data
+ * shrinks at the difference between the transfer rate and the rate the
+ * guest dirties memory; once it falls below threshold_size the guest is
+ * stopped and the rest is sent at full bandwidth.
+ */
+static void migration_update_prediction(MigrationState *s)
+{
+    double dirty_rate = (double)ram_counters.dirty_pages_rate *
+                        qemu_target_page_size() / 1000;
+    double net_rate = s->bandwidth - dirty_rate;
+    uint64_t final_size;
+
+    if (s->pending_size <= s->threshold_size) {
+        s->expected_converge_time = 0;
+        final_size = s->pending_size;
+    } else if (net_rate > 0) {
+        s->expected_converge_time =
+            (s->pending_size - s->threshold_size) / net_rate;
+        final_size = s->threshold_size;
+    } else {
+        /* Not converging: report what stopping now would cost */
+        s->expected_converge_time = -1;
+        final_size = s->pending_size;
+    }
+
+    s->expected_downtime = final_size / s->bandwidth;
+}
+
 static void migration_update_counters(MigrationState *s,
                                       int64_t current_time)
 {
@@ -2212,7 +2347,12 @@ static void migration_update_counters(MigrationState *s,
     transferred = qemu_ftell(s->to_dst_file) - s->iteration_initial_bytes;
     time_spent = current_time - s->iteration_start_time;
     bandwidth = (double)transferred / time_spent;
-    s->threshold_size = bandwidth * s->parameters.downtime_limit;
+    if (s->bandwidth) {
+        s->bandwidth += BANDWIDTH_SMOOTHING * (bandwidth - s->bandwidth);
+    } else {
+        s->bandwidth = bandwidth;
+    }
+    s->threshold_size = s->bandwidth * s->parameters.downtime_limit;
 
     s->mbps = (((double) transferred * 8.0) /
                ((double) time_spent / 1000.0)) / 1000.0 / 1000.0;
@@ -2221,9 +2361,8 @@ static void migration_update_counters(MigrationState *s,
      * if we haven't sent anything, we don't want to
      * recalculate. 10000 is a small enough number for our purposes
      */
-    if (ram_counters.dirty_pages_rate && transferred > 10000) {
-        s->expected_downtime = ram_counters.dirty_pages_rate *
-            qemu_target_page_size() / bandwidth;
+    if (transferred > 10000) {
+        migration_update_prediction(s);
     }
 
     qemu_file_reset_rate_limit(s->to_dst_file);
@@ -2232,7 +2371,9 @@ static void migration_update_counters(MigrationState *s,
     s->iteration_initial_bytes = qemu_ftell(s->to_dst_file);
 
     trace_migrate_transferred(transferred, time_spent,
-                              bandwidth, s->threshold_size);
+                              s->bandwidth, s->threshold_size);
+    trace_migrate_prediction(s->pending_size, s->expected_converge_time,
+                             s->expected_downtime);
 }
 
 /* Migration thread iteration status */
@@ -2254,6 +2395,7 @@ static MigIterateState migration_iteration_run(MigrationState *s)
     qemu_savevm_state_pending(s->to_dst_file, s->threshold_size,
                               &pend_nonpost, &pend_post);
     pending_size = pend_nonpost + pend_post;
+    s->pending_size = pending_size;
 
     trace_migrate_pending(pending_size, s->threshold_size,
                           pend_post, pend_nonpost);
@@ -2284,6 +2426,7 @@ static void migration_iteration_finish(MigrationState *s)
 {
     /* If we enabled cpu throttling for auto-converge, turn it off. */
     cpu_throttle_stop();
+    mig_throttle_vcpu_stop();
 
     qemu_mutex_lock_iothread();
     switch (s->state) {
@@ -2514,6 +2657,9 @@ static Property migration_properties[] = {
     DEFINE_PROP_SIZE("xbzrle-cache-size", MigrationState,
                       parameters.xbzrle_cache_size,
                       DEFAULT_MIGRATE_XBZRLE_CACHE_SIZE),
+    DEFINE_PROP_UINT64("vcpu-dirty-limit", MigrationState,
+                      parameters.vcpu_dirty_limit,
+                      DEFAULT_MIGRATE_VCPU_DIRTY_LIMIT),
 
     /* Migration capabilities */
     DEFINE_PROP_MIG_CAP("x-xbzrle", MIGRATION_CAPABILITY_XBZRLE),
@@ -2578,6 +2724,7 @@ static void migration_instance_init(Object *obj)
     params->has_x_multifd_channels = true;
     params->has_x_multifd_page_count = true;
     params->has_xbzrle_cache_size = true;
+    params->has_vcpu_dirty_limit = true;
 }
 
 /*
@@ -106,6 +106,15 @@ struct MigrationState
      * measured bandwidth
      */
     int64_t threshold_size;
+    /* Smoothed transfer rate in bytes per ms */
+    double bandwidth;
+    /* Data left to send, as of the last iteration */
+    uint64_t pending_size;
+    /*
+     * Predicted time until the pending data drops below threshold_size,
+     * in ms, or -1 if the guest dirties memory faster than we send it
+     */
+    int64_t expected_converge_time;
 
     /* params from 'migrate-set-parameters' */
     MigrationParameters parameters;
@@ -145,6 +154,9 @@ struct MigrationState
     /* Flag set once the migration thread is running (and needs joining) */
     bool migration_thread_running;
 
+    /* Flag set by file: migration once the mapped-ram channels are open */
+    bool mapped_ram_file;
+
     /* Flag set once the migration thread called bdrv_inactivate_all */
     bool block_inactive;
 
@@ -211,8 +223,12 @@ bool migrate_postcopy_ram(void);
 bool migrate_zero_blocks(void);
 
 bool migrate_auto_converge(void);
+bool migrate_dirty_limit(void);
+uint64_t migrate_vcpu_dirty_limit(void);
 bool migrate_use_multifd(void);
 bool migrate_pause_before_switchover(void);
+bool migrate_use_zero_copy_send(void);
+bool migrate_use_mapped_ram(void);
 int migrate_multifd_channels(void);
 int migrate_multifd_page_count(void);
 
@@ -68,6 +68,58 @@ static ssize_t channel_writev_buffer(void *opaque,
 }
 
 
+static ssize_t channel_writev_zero_copy_buffer(void *opaque,
+                                               struct iovec *iov,
+                                               int iovcnt,
+                                               int64_t pos)
+{
+    QIOChannel *ioc = QIO_CHANNEL(opaque);
+    ssize_t done = 0;
+    struct iovec *local_iov = g_new(struct iovec, iovcnt);
+    struct iovec *local_iov_head = local_iov;
+    unsigned int nlocal_iov = iovcnt;
+
+    nlocal_iov = iov_copy(local_iov, nlocal_iov,
+                          iov, iovcnt,
+                          0, iov_size(iov, iovcnt));
+
+    while (nlocal_iov > 0) {
+        ssize_t len;
+        len = qio_channel_writev_zero_copy(ioc, local_iov, nlocal_iov, NULL);
+        if (len == QIO_CHANNEL_ERR_BLOCK) {
+            qio_channel_wait(ioc, G_IO_OUT);
+            continue;
+        }
+        if (len < 0) {
+            /* XXX handle Error objects */
+            done = -EIO;
+            goto cleanup;
+        }
+
+        iov_discard_front(&local_iov, &nlocal_iov, len);
+        done += len;
+    }
+
+ cleanup:
+    g_free(local_iov_head);
+    return done;
+}
+
+
+static int channel_flush_zero_copy(void *opaque)
+{
+    QIOChannel *ioc = QIO_CHANNEL(opaque);
+    int ret;
+
+    ret = qio_channel_flush(ioc, NULL);
+    if (ret < 0) {
+        /* XXX handle Error objects */
+        return -EIO;
+    }
+    return ret;
+}
+
+
 static ssize_t channel_get_buffer(void *opaque,
                                   uint8_t *buf,
                                   int64_t pos,
@@ -166,6 +218,8 @@ static const QEMUFileOps channel_output_ops = {
     .shut_down = channel_shutdown,
     .set_blocking = channel_set_blocking,
     .get_return_path = channel_get_output_return_path,
+    .writev_zero_copy_buffer = channel_writev_zero_copy_buffer,
+    .flush_zero_copy = channel_flush_zero_copy,
 };
 
 
@@ -48,9 +48,15 @@ struct QEMUFile {
     uint8_t buf[IO_BUF_SIZE];
 
     DECLARE_BITMAP(may_free, MAX_IOV_SIZE);
+    DECLARE_BITMAP(zero_copy_iov, MAX_IOV_SIZE);
     struct iovec iov[MAX_IOV_SIZE];
     unsigned int iovcnt;
 
+    /* Send qemu_put_buffer_async() data without copying it */
+    bool zero_copy;
+    /* Zero copy data was handed to the backend since the last flush */
+    bool zero_copy_pending;
+
     int last_error;
 };
 
@@ -166,6 +172,50 @@ static void qemu_iovec_release_ram(QEMUFile *f)
     memset(f->may_free, 0, sizeof(f->may_free));
 }
 
+/*
+ * Write out the pending iovecs.  With zero copy enabled, runs of guest
+ * memory queued by qemu_put_buffer_async() are handed to the backend by
+ * reference, while data copied into f->buf is written normally since the
+ * buffer is reused as soon as we return.
+ */
+static ssize_t qemu_fflush_iov(QEMUFile *f)
+{
+    unsigned int start = 0, end;
+    ssize_t done = 0;
+
+    if (!f->zero_copy) {
+        return f->ops->writev_buffer(f->opaque, f->iov, f->iovcnt, f->pos);
+    }
+
+    while (start < f->iovcnt) {
+        bool zero_copy = test_bit(start, f->zero_copy_iov);
+        ssize_t ret;
+
+        for (end = start + 1; end < f->iovcnt; end++) {
+            if (test_bit(end, f->zero_copy_iov) != zero_copy) {
+                break;
+            }
+        }
+
+        if (zero_copy) {
+            ret = f->ops->writev_zero_copy_buffer(f->opaque, f->iov + start,
+                                                  end - start, f->pos + done);
+            f->zero_copy_pending = true;
+        } else {
+            ret = f->ops->writev_buffer(f->opaque, f->iov + start,
+                                        end - start, f->pos + done);
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        done += ret;
+        start = end;
+    }
+
+    memset(f->zero_copy_iov, 0, sizeof(f->zero_copy_iov));
+    return done;
+}
+
 /**
  * Flushes QEMUFile buffer
  *
@@ -184,8 +234,12 @@ void qemu_fflush(QEMUFile *f)
 
     if (f->iovcnt > 0) {
         expect = iov_size(f->iov, f->iovcnt);
-        ret = f->ops->writev_buffer(f->opaque, f->iov, f->iovcnt, f->pos);
+        ret = qemu_fflush_iov(f);
 
+        /* Pages must not be released while the backend still reads them */
+        if (!bitmap_empty(f->may_free, f->iovcnt)) {
+            qemu_file_flush_zero_copy(f);
+        }
         qemu_iovec_release_ram(f);
     }
 
@@ -202,6 +256,44 @@ void qemu_fflush(QEMUFile *f)
     f->iovcnt = 0;
 }
 
+/*
+ * Enable or disable zero copy transmission of the buffers passed to
+ * qemu_put_buffer_async().  Only valid on files whose backend
+ * provides the zero copy ops.
+ */
+void qemu_file_set_zero_copy(QEMUFile *f, bool enable)
+{
+    assert(!enable || (f->ops->writev_zero_copy_buffer &&
+                       f->ops->flush_zero_copy));
+    qemu_fflush(f);
+    f->zero_copy = enable;
+}
+
+/*
+ * Wait for the backend to release all memory sent by reference so far.
+ * Callers must do this before the memory is freed, and before relying on
+ * the peer having seen its current contents.
+ *
+ * Returns negative error value on failure, 1 if the backend fell back to
+ * copying some of the data, otherwise 0.
+ */
+int qemu_file_flush_zero_copy(QEMUFile *f)
+{
+    int ret;
+
+    if (!f->zero_copy_pending) {
+        return 0;
+    }
+
+    ret = f->ops->flush_zero_copy(f->opaque);
+    if (ret < 0) {
+        qemu_file_set_error(f, ret);
+    } else {
+        f->zero_copy_pending = false;
+    }
+    return ret;
+}
+
 void ram_control_before_iterate(QEMUFile *f, uint64_t flags)
 {
     int ret = 0;
@@ -341,18 +433,22 @@ int qemu_fclose(QEMUFile *f)
 }
 
 static void add_to_iovec(QEMUFile *f, const uint8_t *buf, size_t size,
-                         bool may_free)
+                         bool may_free, bool zero_copy)
 {
     /* check for adjacent buffer and coalesce them */
     if (f->iovcnt > 0 && buf == f->iov[f->iovcnt - 1].iov_base +
         f->iov[f->iovcnt - 1].iov_len &&
-        may_free == test_bit(f->iovcnt - 1, f->may_free))
+        may_free == test_bit(f->iovcnt - 1, f->may_free) &&
+        zero_copy == test_bit(f->iovcnt - 1, f->zero_copy_iov))
     {
         f->iov[f->iovcnt - 1].iov_len += size;
     } else {
         if (may_free) {
             set_bit(f->iovcnt, f->may_free);
         }
+        if (zero_copy) {
+            set_bit(f->iovcnt, f->zero_copy_iov);
+        }
         f->iov[f->iovcnt].iov_base = (uint8_t *)buf;
         f->iov[f->iovcnt++].iov_len = size;
     }
@@ -370,7 +466,7 @@ void qemu_put_buffer_async(QEMUFile *f, const uint8_t *buf, size_t size,
     }
 
     f->bytes_xfer += size;
-    add_to_iovec(f, buf, size, may_free);
+    add_to_iovec(f, buf, size, may_free, f->zero_copy);
 }
 
 void qemu_put_buffer(QEMUFile *f, const uint8_t *buf, size_t size)
@@ -388,7 +484,7 @@ void qemu_put_buffer(QEMUFile *f, const uint8_t *buf, size_t size)
         }
         memcpy(f->buf + f->buf_index, buf, l);
         f->bytes_xfer += l;
-        add_to_iovec(f, f->buf + f->buf_index, l, false);
+        add_to_iovec(f, f->buf + f->buf_index, l, false, false);
         f->buf_index += l;
         if (f->buf_index == IO_BUF_SIZE) {
             qemu_fflush(f);
@@ -409,7 +505,7 @@ void qemu_put_byte(QEMUFile *f, int v)
 
     f->buf[f->buf_index] = v;
     f->bytes_xfer++;
-    add_to_iovec(f, f->buf + f->buf_index, 1, false);
+    add_to_iovec(f, f->buf + f->buf_index, 1, false, false);
     f->buf_index++;
     if (f->buf_index == IO_BUF_SIZE) {
         qemu_fflush(f);
@@ -690,7 +786,7 @@ ssize_t qemu_put_compression_data(QEMUFile *f, const uint8_t *p, size_t size,
     }
     qemu_put_be32(f, blen);
     if (f->ops->writev_buffer) {
-        add_to_iovec(f, f->buf + f->buf_index, blen, false);
+        add_to_iovec(f, f->buf + f->buf_index, blen, false, false);
     }
     f->buf_index += blen;
     if (f->buf_index == IO_BUF_SIZE) {
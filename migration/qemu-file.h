@@ -56,6 +56,13 @@ typedef int (QEMUFileSetBlocking)(void *opaque, bool enabled);
 typedef ssize_t (QEMUFileWritevBufferFunc)(void *opaque, struct iovec *iov,
                                            int iovcnt, int64_t pos);
 
+/*
+ * Wait until the backend no longer references memory passed to
+ * writev_zero_copy_buffer.  Returns a negative errno value on error,
+ * 1 if the backend had to copy some of the data anyway, else 0.
+ */
+typedef int (QEMUFileFlushZeroCopyFunc)(void *opaque);
+
 /*
  * This function provides hooks around different
  * stages of RAM migration.
@@ -104,6 +111,8 @@ typedef struct QEMUFileOps {
     QEMUFileWritevBufferFunc *writev_buffer;
     QEMURetPathFunc *get_return_path;
     QEMUFileShutdownFunc *shut_down;
+    QEMUFileWritevBufferFunc *writev_zero_copy_buffer;
+    QEMUFileFlushZeroCopyFunc *flush_zero_copy;
 } QEMUFileOps;
 
 typedef struct QEMUFileHooks {
@@ -152,6 +161,8 @@ void qemu_file_set_error(QEMUFile *f, int ret);
 int qemu_file_shutdown(QEMUFile *f);
 QEMUFile *qemu_file_get_return_path(QEMUFile *f);
 void qemu_fflush(QEMUFile *f);
+void qemu_file_set_zero_copy(QEMUFile *f, bool enable);
+int qemu_file_flush_zero_copy(QEMUFile *f);
 void qemu_file_set_blocking(QEMUFile *f, bool block);
 
 size_t qemu_get_counted_string(QEMUFile *f, char buf[256]);
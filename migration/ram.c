@@ -51,6 +51,7 @@
 #include "qemu/rcu_queue.h"
 #include "migration/colo.h"
 #include "migration/block.h"
+#include "io/channel.h"
 
 /***********************************************************/
 /* ram save/restore */
@@ -633,26 +634,108 @@ static size_t save_page_header(RAMState *rs, QEMUFile *f,  RAMBlock *block,
 }
 
 /**
- * mig_throttle_guest_down: throotle down the guest
+ * mig_throttle_guest_update: adjust auto-converge throttling
  *
- * Reduce amount of guest cpu execution to hopefully slow down memory
- * writes. If guest dirty memory rate is reduced below the rate at
- * which we can transfer pages to the destination then we should be
- * able to complete migration. Some workloads dirty memory way too
- * fast and will not effectively converge, even with auto-converge.
+ * Pick the throttle that brings the dirty rate down to half of the
+ * transfer rate, given the rate measured over the last period under
+ * the current throttle.  The first step is at least cpu-throttle-initial
+ * and later increases are capped at cpu-throttle-increment, so that a
+ * burst of dirtying is not overreacted to.  The throttle is lowered
+ * again as soon as the guest no longer needs it.
+ *
+ * @rs: current RAM state
+ * @bytes_dirty: bytes dirtied during the last period
+ * @bytes_xfer: bytes transferred during the last period
  */
-static void mig_throttle_guest_down(void)
+static void mig_throttle_guest_update(RAMState *rs, uint64_t bytes_dirty,
+                                      uint64_t bytes_xfer)
 {
     MigrationState *s = migrate_get_current();
-    uint64_t pct_initial = s->parameters.cpu_throttle_initial;
-    uint64_t pct_icrement = s->parameters.cpu_throttle_increment;
+    int pct_initial = s->parameters.cpu_throttle_initial;
+    int pct_icrement = s->parameters.cpu_throttle_increment;
+    int old_pct = cpu_throttle_active() ? cpu_throttle_get_percentage() : 0;
+    double unthrottled, needed;
+    int new_pct;
+
+    if (!bytes_xfer) {
+        return;
+    }
+
+    /* What the guest would dirty without any throttling */
+    unthrottled = bytes_dirty * 100.0 / (100 - old_pct);
+    needed = unthrottled ? 100.0 * (1.0 - bytes_xfer / 2.0 / unthrottled) : 0;
+    new_pct = needed > 0 ? MIN((int)needed + 1, 99) : 0;
+
+    if (new_pct > old_pct) {
+        /* Two periods in a row, to skip short bursts of dirtying */
+        if (++rs->dirty_rate_high_cnt < 2) {
+            return;
+        }
+        if (!old_pct) {
+            new_pct = MAX(new_pct, pct_initial);
+        } else {
+            new_pct = MIN(new_pct, old_pct + pct_icrement);
+        }
+    } else if (new_pct + pct_icrement / 2 >= old_pct) {
+        /* Close enough, don't oscillate */
+        rs->dirty_rate_high_cnt = 0;
+        return;
+    }
+    rs->dirty_rate_high_cnt = 0;
 
-    /* We have not started throttling yet. Let's start it. */
-    if (!cpu_throttle_active()) {
-        cpu_throttle_set(pct_initial);
+    trace_migration_throttle(old_pct, new_pct);
+    if (new_pct) {
+        cpu_throttle_set(new_pct);
     } else {
-        /* Throttling already on, just increase the rate */
-        cpu_throttle_set(cpu_throttle_get_percentage() + pct_icrement);
+        cpu_throttle_stop();
+    }
+}
+
+/**
+ * mig_throttle_vcpu_update: throttle the vcpus above vcpu-dirty-limit
+ *
+ * Each vcpu that dirtied memory faster than the limit during the last
+ * period gets the throttle that would have kept it at the limit,
+ * raised by at most cpu-throttle-increment at a time; vcpus below the
+ * limit are released.  Idle or read-mostly vcpus are never slowed down.
+ *
+ * @period: length of the last period in milliseconds
+ */
+static void mig_throttle_vcpu_update(int64_t period)
+{
+    MigrationState *s = migrate_get_current();
+    int pct_icrement = s->parameters.cpu_throttle_increment;
+    double limit = migrate_vcpu_dirty_limit() * 1024 * 1024;
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        int old_pct = cpu_throttle_get_vcpu_percentage(cpu);
+        double rate = (double)cpu_dirty_pages_harvest(cpu) *
+                      TARGET_PAGE_SIZE * 1000 / period;
+        double unthrottled = rate * 100.0 / (100 - old_pct);
+        int new_pct = 0;
+
+        if (unthrottled > limit) {
+            new_pct = MIN((int)(100.0 * (1.0 - limit / unthrottled)) + 1, 99);
+            new_pct = MIN(new_pct, old_pct + pct_icrement);
+        }
+        if (new_pct != old_pct) {
+            trace_migration_throttle_vcpu(cpu->cpu_index, rate, old_pct,
+                                          new_pct);
+            cpu_throttle_set_vcpu(cpu, new_pct);
+        }
+    }
+}
+
+/**
+ * mig_throttle_vcpu_stop: release all vcpus throttled by dirty-limit
+ */
+void mig_throttle_vcpu_stop(void)
+{
+    CPUState *cpu;
+
+    CPU_FOREACH(cpu) {
+        cpu_throttle_set_vcpu(cpu, 0);
     }
 }
 
@@ -832,16 +915,47 @@ uint64_t ram_pagesize_summary(void)
     return summary;
 }
 
+/**
+ * ram_flush_zero_copy: wait for pages sent by reference to reach the wire
+ *
+ * With zero-copy-send the kernel reads guest pages after sendmsg()
+ * returns, so a page dirtied in the meantime may be sent with its new
+ * contents.  That is harmless as long as the page is sent again, which
+ * the next bitmap sync guarantees; flush here so that every page has a
+ * well defined state when we look at the dirty log.
+ *
+ * @rs: current RAM state
+ */
+static void ram_flush_zero_copy(RAMState *rs)
+{
+    if (!rs->f || !migrate_use_zero_copy_send()) {
+        return;
+    }
+
+    qemu_fflush(rs->f);
+    if (qemu_file_flush_zero_copy(rs->f) == 1) {
+        ram_counters.zero_copy_fallbacks++;
+    }
+}
+
 static void migration_bitmap_sync(RAMState *rs)
 {
     RAMBlock *block;
     int64_t end_time;
     uint64_t bytes_xfer_now;
 
+    ram_flush_zero_copy(rs);
+
     ram_counters.dirty_sync_count++;
 
     if (!rs->time_last_bitmap_sync) {
+        CPUState *cpu;
+
         rs->time_last_bitmap_sync = qemu_clock_get_ms(QEMU_CLOCK_REALTIME);
+        /* Forget what was dirtied before migration started */
+        CPU_FOREACH(cpu) {
+            cpu_dirty_pages_harvest(cpu);
+        }
     }
 
     trace_migration_bitmap_sync_start();
@@ -869,19 +983,14 @@ static void migration_bitmap_sync(RAMState *rs)
         /* During block migration the auto-converge logic incorrectly detects
          * that ram migration makes no progress. Avoid this by disabling the
          * throttling logic during the bulk phase of block migration. */
-        if (migrate_auto_converge() && !blk_mig_bulk_active()) {
-            /* The following detection logic can be refined later. For now:
-               Check to see if the dirtied bytes is 50% more than the approx.
-               amount of bytes that just got transferred since the last time we
-               were in this routine. If that happens twice, start or increase
-               throttling */
-
-            if ((rs->num_dirty_pages_period * TARGET_PAGE_SIZE >
-                   (bytes_xfer_now - rs->bytes_xfer_prev) / 2) &&
-                (++rs->dirty_rate_high_cnt >= 2)) {
-                    trace_migration_throttle();
-                    rs->dirty_rate_high_cnt = 0;
-                    mig_throttle_guest_down();
+        if (!blk_mig_bulk_active()) {
+            if (migrate_dirty_limit() && cpu_dirty_accounting_enabled()) {
+                mig_throttle_vcpu_update(end_time - rs->time_last_bitmap_sync);
+            } else if (migrate_auto_converge() || migrate_dirty_limit()) {
+                mig_throttle_guest_update(rs,
+                                          rs->num_dirty_pages_period *
+                                          TARGET_PAGE_SIZE,
+                                          bytes_xfer_now - rs->bytes_xfer_prev);
             }
         }
 
@@ -1018,6 +1127,9 @@ static int ram_save_page(RAMState *rs, PageSearchStatus *pss, bool last_stage)
             qemu_put_buffer_async(rs->f, p, TARGET_PAGE_SIZE,
                                   migrate_release_ram() &
                                   migration_in_postcopy());
+            if (migrate_use_zero_copy_send()) {
+                ram_counters.zero_copy_bytes += TARGET_PAGE_SIZE;
+            }
         } else {
             qemu_put_buffer(rs->f, p, TARGET_PAGE_SIZE);
         }
@@ -1632,6 +1744,428 @@ static void xbzrle_cleanup(void)
     XBZRLE_cache_unlock();
 }
 
+/* Mapped RAM */
+
+/*
+ * With the mapped-ram capability every RAMBlock owns a fixed region of
+ * the migration file: a little endian bitmap of the pages present in
+ * the file, followed by the pages themselves at their offset within the
+ * block.  Pages are written there directly rather than through the
+ * migration stream, so saving a page twice simply overwrites it, and
+ * both sides can process the regions with several threads.
+ */
+
+#define MAPPED_RAM_ALIGN        (1ULL << 20)
+/* O_DIRECT needs buffer, offset and length aligned to the block size */
+#define MAPPED_RAM_DIRECT_ALIGN 4096
+/*
+ * Threads work on chunks of this many pages; a multiple of BITS_PER_LONG
+ * so that no two threads ever modify the same bitmap word.
+ */
+#define MAPPED_RAM_CHUNK_PAGES  (BITS_PER_LONG * 256)
+
+static struct {
+    QIOChannel *ioc;
+    QIOChannel *direct_ioc;
+} mapped_ram;
+
+typedef struct MappedRamChunk {
+    RAMBlock *block;
+    unsigned long start;
+    unsigned long end;
+} MappedRamChunk;
+
+typedef struct MappedRamJob MappedRamJob;
+typedef int (MappedRamChunkFunc)(MappedRamJob *job, MappedRamChunk *chunk);
+
+struct MappedRamJob {
+    MappedRamChunkFunc *fn;
+    MappedRamChunk *chunks;
+    unsigned int nr_chunks;
+    /* The fields below are updated atomically by the worker threads */
+    unsigned int next_chunk;
+    int ret;
+    unsigned long dirty;
+    unsigned long normal;
+    unsigned long duplicate;
+};
+
+void ram_mapped_ram_set_channels(QIOChannel *ioc, QIOChannel *direct_ioc)
+{
+    if (mapped_ram.ioc) {
+        object_unref(OBJECT(mapped_ram.ioc));
+    }
+    if (mapped_ram.direct_ioc) {
+        object_unref(OBJECT(mapped_ram.direct_ioc));
+    }
+
+    mapped_ram.ioc = ioc;
+    mapped_ram.direct_ioc = direct_ioc;
+
+    if (ioc) {
+        object_ref(OBJECT(ioc));
+    }
+    if (direct_ioc) {
+        object_ref(OBJECT(direct_ioc));
+    }
+}
+
+/* Size in the file of the bitmap for @pages pages, padded to 64 bits */
+static size_t mapped_ram_bitmap_size(unsigned long pages)
+{
+    return ROUND_UP(pages, 64) / 8;
+}
+
+static unsigned long *mapped_ram_bitmap_new(unsigned long pages)
+{
+    return bitmap_new(ROUND_UP(pages, 64));
+}
+
+/**
+ * ram_mapped_ram_layout: assign file regions to all RAMBlocks
+ *
+ * Returns the end of the last region, where the migration stream
+ * should start.
+ *
+ * @offset: file offset of the first region
+ */
+uint64_t ram_mapped_ram_layout(uint64_t offset)
+{
+    RAMBlock *block;
+
+    rcu_read_lock();
+    RAMBLOCK_FOREACH(block) {
+        unsigned long pages = block->used_length >> TARGET_PAGE_BITS;
+
+        block->bitmap_offset = offset;
+        offset += mapped_ram_bitmap_size(pages);
+        block->pages_offset = ROUND_UP(offset, MAPPED_RAM_ALIGN);
+        offset = ROUND_UP(block->pages_offset + block->used_length,
+                          MAPPED_RAM_ALIGN);
+    }
+    rcu_read_unlock();
+
+    return offset;
+}
+
+static bool mapped_ram_can_use_direct(void *host, size_t len, uint64_t offset)
+{
+    return mapped_ram.direct_ioc &&
+           QEMU_IS_ALIGNED((uintptr_t)host | len | offset,
+                           MAPPED_RAM_DIRECT_ALIGN);
+}
+
+/*
+ * Transfer @npages pages starting at @page between @block and its file
+ * region.  Use O_DIRECT when alignment permits, falling back to the
+ * page cache if the filesystem rejects it.
+ */
+static int mapped_ram_io(RAMBlock *block, unsigned long page,
+                         unsigned long npages, bool write)
+{
+    char *host = (char *)block->host + (page << TARGET_PAGE_BITS);
+    size_t len = npages << TARGET_PAGE_BITS;
+    uint64_t offset = block->pages_offset + (page << TARGET_PAGE_BITS);
+    Error *local_err = NULL;
+    ssize_t ret;
+
+    if (mapped_ram_can_use_direct(host, len, offset)) {
+        ret = write ?
+            qio_channel_pwrite(mapped_ram.direct_ioc, host, len, offset, NULL) :
+            qio_channel_pread(mapped_ram.direct_ioc, host, len, offset, NULL);
+        if (ret == len) {
+            return 0;
+        }
+    }
+
+    ret = write ?
+        qio_channel_pwrite(mapped_ram.ioc, host, len, offset, &local_err) :
+        qio_channel_pread(mapped_ram.ioc, host, len, offset, &local_err);
+    if (ret != len) {
+        if (local_err) {
+            error_report_err(local_err);
+        } else {
+            error_report("Short read of RAM block %s at offset %" PRIu64,
+                         block->idstr, offset);
+        }
+        return -EIO;
+    }
+    return 0;
+}
+
+static void *mapped_ram_thread(void *opaque)
+{
+    MappedRamJob *job = opaque;
+    unsigned int i;
+
+    while ((i = atomic_fetch_inc(&job->next_chunk)) < job->nr_chunks) {
+        int ret = job->fn(job, &job->chunks[i]);
+
+        if (ret < 0) {
+            atomic_cmpxchg(&job->ret, 0, ret);
+            break;
+        }
+        if (atomic_read(&job->ret)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Split every RAMBlock that has a file region into chunks and run @fn
+ * over them from x-multifd-channels threads.  Called within an RCU
+ * critical section, which keeps the blocks alive until all threads are
+ * joined.
+ */
+static int mapped_ram_run(MappedRamJob *job, MappedRamChunkFunc *fn)
+{
+    int nr_threads = MAX(migrate_multifd_channels(), 1);
+    QemuThread *threads;
+    RAMBlock *block;
+    unsigned int n = 0;
+    int i;
+
+    job->fn = fn;
+    RAMBLOCK_FOREACH(block) {
+        unsigned long pages = block->used_length >> TARGET_PAGE_BITS;
+
+        if (block->pages_offset) {
+            n += DIV_ROUND_UP(pages, MAPPED_RAM_CHUNK_PAGES);
+        }
+    }
+
+    job->chunks = g_new(MappedRamChunk, n);
+    RAMBLOCK_FOREACH(block) {
+        unsigned long pages = block->used_length >> TARGET_PAGE_BITS;
+        unsigned long start;
+
+        if (!block->pages_offset) {
+            continue;
+        }
+        for (start = 0; start < pages; start += MAPPED_RAM_CHUNK_PAGES) {
+            MappedRamChunk *chunk = &job->chunks[job->nr_chunks++];
+
+            chunk->block = block;
+            chunk->start = start;
+            chunk->end = MIN(start + MAPPED_RAM_CHUNK_PAGES, pages);
+        }
+    }
+
+    nr_threads = MIN(nr_threads, job->nr_chunks);
+    threads = g_new(QemuThread, nr_threads);
+    for (i = 0; i < nr_threads; i++) {
+        qemu_thread_create(threads + i, "mapped-ram", mapped_ram_thread, job,
+                           QEMU_THREAD_JOINABLE);
+    }
+    for (i = 0; i < nr_threads; i++) {
+        qemu_thread_join(threads + i);
+    }
+
+    g_free(threads);
+    g_free(job->chunks);
+    return job->ret;
+}
+
+/*
+ * Write out the dirty pages of a chunk, one host page at a time so that
+ * runs stay aligned for O_DIRECT.  Zero pages are not written but only
+ * dropped from the file bitmap; the destination RAM starts out zeroed.
+ */
+static int mapped_ram_save_chunk(MappedRamJob *job, MappedRamChunk *chunk)
+{
+    RAMBlock *block = chunk->block;
+    unsigned long hpages = MAX(qemu_host_page_size >> TARGET_PAGE_BITS, 1);
+    unsigned long run_start = 0, run_pages = 0;
+    unsigned long dirty = 0, normal = 0, duplicate = 0;
+    unsigned long page, i;
+    int ret = 0;
+
+    for (page = chunk->start; page < chunk->end; page += hpages) {
+        unsigned long n = MIN(hpages, chunk->end - page);
+        unsigned long ndirty = 0;
+
+        for (i = 0; i < n; i++) {
+            ndirty += test_and_clear_bit(page + i, block->bmap);
+        }
+
+        if (ndirty) {
+            dirty += ndirty;
+
+            if (is_zero_range(block->host + (page << TARGET_PAGE_BITS),
+                              n << TARGET_PAGE_BITS)) {
+                bitmap_clear(block->file_bmap, page, n);
+                duplicate += n;
+            } else {
+                bitmap_set(block->file_bmap, page, n);
+                if (!run_pages) {
+                    run_start = page;
+                }
+                run_pages += n;
+                normal += n;
+                continue;
+            }
+        }
+
+        if (run_pages) {
+            ret = mapped_ram_io(block, run_start, run_pages, true);
+            if (ret < 0) {
+                return ret;
+            }
+            run_pages = 0;
+        }
+    }
+
+    if (run_pages) {
+        ret = mapped_ram_io(block, run_start, run_pages, true);
+    }
+
+    atomic_add(&job->dirty, dirty);
+    atomic_add(&job->normal, normal);
+    atomic_add(&job->duplicate, duplicate);
+    return ret;
+}
+
+/**
+ * ram_save_mapped: write all dirty pages to their file regions
+ *
+ * Returns zero to indicate success and negative for error
+ *
+ * Called within an RCU critical section
+ *
+ * @rs: current RAM state
+ */
+static int ram_save_mapped(RAMState *rs)
+{
+    MappedRamJob job = { 0 };
+    int ret;
+
+    qemu_mutex_lock(&rs->bitmap_mutex);
+    ret = mapped_ram_run(&job, mapped_ram_save_chunk);
+    rs->migration_dirty_pages -= job.dirty;
+    qemu_mutex_unlock(&rs->bitmap_mutex);
+
+    ram_counters.normal += job.normal;
+    ram_counters.duplicate += job.duplicate;
+    ram_counters.transferred += job.normal * TARGET_PAGE_SIZE;
+    /* Account the data for the bandwidth estimate in migration_thread */
+    qemu_update_position(rs->f, job.normal * TARGET_PAGE_SIZE);
+    trace_ram_save_mapped(job.dirty, job.normal, job.duplicate, ret);
+
+    if (ret < 0) {
+        qemu_file_set_error(rs->f, ret);
+    }
+    return ret;
+}
+
+/* Write the file bitmaps; called once all pages are in the file */
+static int ram_save_mapped_bitmaps(void)
+{
+    Error *local_err = NULL;
+    RAMBlock *block;
+
+    RAMBLOCK_FOREACH(block) {
+        unsigned long pages = block->used_length >> TARGET_PAGE_BITS;
+        size_t size = mapped_ram_bitmap_size(pages);
+        unsigned long *le_bmap = mapped_ram_bitmap_new(pages);
+        ssize_t ret;
+
+        bitmap_to_le(le_bmap, block->file_bmap, ROUND_UP(pages, 64));
+        ret = qio_channel_pwrite(mapped_ram.ioc, (char *)le_bmap, size,
+                                 block->bitmap_offset, &local_err);
+        g_free(le_bmap);
+        if (ret < 0) {
+            error_report_err(local_err);
+            return -EIO;
+        }
+    }
+    return 0;
+}
+
+/* Read the present pages of a chunk, in as few requests as possible */
+static int mapped_ram_load_chunk(MappedRamJob *job, MappedRamChunk *chunk)
+{
+    RAMBlock *block = chunk->block;
+    unsigned long page = chunk->start;
+    unsigned long normal = 0;
+    int ret;
+
+    while ((page = find_next_bit(block->file_bmap, chunk->end, page)) <
+           chunk->end) {
+        unsigned long end = find_next_zero_bit(block->file_bmap, chunk->end,
+                                               page);
+
+        ret = mapped_ram_io(block, page, end - page, false);
+        if (ret < 0) {
+            return ret;
+        }
+        ramblock_recv_bitmap_set_range(block,
+                                       block->host + (page << TARGET_PAGE_BITS),
+                                       end - page);
+        normal += end - page;
+        page = end;
+    }
+
+    atomic_add(&job->normal, normal);
+    return 0;
+}
+
+/**
+ * ram_load_mapped: load all RAMBlocks from their file regions
+ *
+ * Returns zero to indicate success and negative for error
+ *
+ * Called within an RCU critical section, after the RAM block list
+ * has been read from the stream.
+ */
+static int ram_load_mapped(void)
+{
+    MappedRamJob job = { 0 };
+    Error *local_err = NULL;
+    RAMBlock *block;
+    int ret = 0;
+
+    if (!mapped_ram.ioc) {
+        error_report("mapped-ram requires a file: migration URI");
+        return -EINVAL;
+    }
+
+    RAMBLOCK_FOREACH(block) {
+        unsigned long pages = block->used_length >> TARGET_PAGE_BITS;
+        size_t size = mapped_ram_bitmap_size(pages);
+
+        if (!block->pages_offset) {
+            continue;
+        }
+        block->file_bmap = mapped_ram_bitmap_new(pages);
+        if (qio_channel_pread(mapped_ram.ioc, (char *)block->file_bmap, size,
+                              block->bitmap_offset, &local_err) != size) {
+            if (local_err) {
+                error_report_err(local_err);
+            } else {
+                error_report("Truncated bitmap for RAM block %s",
+                             block->idstr);
+            }
+            ret = -EIO;
+            goto out;
+        }
+        bitmap_from_le(block->file_bmap, block->file_bmap,
+                       ROUND_UP(pages, 64));
+    }
+
+    ret = mapped_ram_run(&job, mapped_ram_load_chunk);
+    trace_ram_load_mapped(job.normal, ret);
+
+ out:
+    RAMBLOCK_FOREACH(block) {
+        g_free(block->file_bmap);
+        block->file_bmap = NULL;
+        block->pages_offset = 0;
+    }
+    return ret;
+}
+
 static void ram_save_cleanup(void *opaque)
 {
     RAMState **rsp = opaque;
@@ -1647,11 +2181,14 @@ static void ram_save_cleanup(void *opaque)
         block->bmap = NULL;
         g_free(block->unsentmap);
         block->unsentmap = NULL;
+        g_free(block->file_bmap);
+        block->file_bmap = NULL;
     }
 
     xbzrle_cleanup();
     compress_threads_save_cleanup();
     ram_state_cleanup(rsp);
+    ram_mapped_ram_set_channels(NULL, NULL);
 }
 
 static void ram_state_reset(RAMState *rs)
@@ -2158,6 +2695,9 @@ static void ram_list_init_bitmaps(void)
                 block->unsentmap = bitmap_new(pages);
                 bitmap_set(block->unsentmap, 0, pages);
             }
+            if (migrate_use_mapped_ram()) {
+                block->file_bmap = mapped_ram_bitmap_new(pages);
+            }
         }
     }
 }
@@ -2214,6 +2754,11 @@ static int ram_save_setup(QEMUFile *f, void *opaque)
     RAMState **rsp = opaque;
     RAMBlock *block;
 
+    if (migrate_use_mapped_ram() && !migrate_get_current()->mapped_ram_file) {
+        error_report("mapped-ram requires a file: migration URI");
+        return -1;
+    }
+
     /* migration has already setup the bitmap, reuse it. */
     if (!migration_in_colo_state()) {
         if (ram_init_all(rsp) != 0) {
@@ -2233,6 +2778,10 @@ static int ram_save_setup(QEMUFile *f, void *opaque)
         if (migrate_postcopy_ram() && block->page_size != qemu_host_page_size) {
             qemu_put_be64(f, block->page_size);
         }
+        if (migrate_use_mapped_ram()) {
+            qemu_put_be64(f, block->bitmap_offset);
+            qemu_put_be64(f, block->pages_offset);
+        }
     }
 
     rcu_read_unlock();
@@ -2282,7 +2831,12 @@ static int ram_save_iterate(QEMUFile *f, void *opaque)
 
     t0 = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
     i = 0;
-    while ((ret = qemu_file_rate_limit(f)) == 0) {
+    if (migrate_use_mapped_ram()) {
+        /* The file regions absorb a whole pass at disk bandwidth */
+        ram_save_mapped(rs);
+        done = 1;
+    }
+    while (!done && (ret = qemu_file_rate_limit(f)) == 0) {
         int pages;
 
         pages = ram_find_and_save_block(rs, false);
@@ -2354,13 +2908,19 @@ static int ram_save_complete(QEMUFile *f, void *opaque)
     /* try transferring iterative blocks of memory */
 
     /* flush all remaining blocks regardless of rate limiting */
-    while (true) {
-        int pages;
+    if (migrate_use_mapped_ram()) {
+        if (ram_save_mapped(rs) == 0 && ram_save_mapped_bitmaps() < 0) {
+            qemu_file_set_error(f, -EIO);
+        }
+    } else {
+        while (true) {
+            int pages;
 
-        pages = ram_find_and_save_block(rs, !migration_in_colo_state());
-        /* no more blocks to sent */
-        if (pages == 0) {
-            break;
+            pages = ram_find_and_save_block(rs, !migration_in_colo_state());
+            /* no more blocks to sent */
+            if (pages == 0) {
+                break;
+            }
         }
     }
 
@@ -2370,6 +2930,7 @@ static int ram_save_complete(QEMUFile *f, void *opaque)
     rcu_read_unlock();
 
     qemu_put_be64(f, RAM_SAVE_FLAG_EOS);
+    ram_flush_zero_copy(rs);
 
     return 0;
 }
@@ -2662,6 +3223,7 @@ static int ram_load_cleanup(void *opaque)
         g_free(rb->receivedmap);
         rb->receivedmap = NULL;
     }
+    ram_mapped_ram_set_channels(NULL, NULL);
     return 0;
 }
 
@@ -2942,6 +3504,10 @@ static int ram_load(QEMUFile *f, void *opaque, int version_id)
                             ret = -EINVAL;
                         }
                     }
+                    if (migrate_use_mapped_ram()) {
+                        block->bitmap_offset = qemu_get_be64(f);
+                        block->pages_offset = qemu_get_be64(f);
+                    }
                     ram_control_load_hook(f, RAM_CONTROL_BLOCK_REG,
                                           block->idstr);
                 } else {
@@ -2952,6 +3518,9 @@ static int ram_load(QEMUFile *f, void *opaque, int version_id)
 
                 total_ram_bytes -= length;
             }
+            if (!ret && migrate_use_mapped_ram()) {
+                ret = ram_load_mapped();
+            }
             break;
 
         case RAM_SAVE_FLAG_ZERO:
@@ -23,6 +23,7 @@
 #include "disas/disas.h"
 #include "exec/exec-all.h"
 #include "tcg-op.h"
+#include "tcg-op-gvec.h"
 #include "exec/cpu_ldst.h"
 #include "exec/translator.h"
 
@@ -2552,9 +2553,11 @@ static void gen_bnd_jmp(DisasContext *s)
 /* Generate an end of block. Trace exception is also generated if needed.
    If INHIBIT, set HF_INHIBIT_IRQ_MASK if it isn't already set.
    If RECHECK_TF, emit a rechecking helper for #DB, ignoring the state of
-   S->TF.  This is used by the syscall/sysret insns.  */
+   S->TF.  This is used by the syscall/sysret insns.  If JR, look up
+   the next TB directly; RET additionally predicts it as a return.  */
 static void
-do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
+do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr,
+                  bool ret)
 {
     gen_update_cc_op(s);
 
@@ -2575,6 +2578,8 @@ do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
         tcg_gen_exit_tb(0);
     } else if (s->tf) {
         gen_helper_single_step(cpu_env);
+    } else if (jr && ret) {
+        tcg_gen_lookup_and_goto_ptr_ret();
     } else if (jr) {
         tcg_gen_lookup_and_goto_ptr();
     } else {
@@ -2586,7 +2591,7 @@ do_gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf, bool jr)
 static inline void
 gen_eob_worker(DisasContext *s, bool inhibit, bool recheck_tf)
 {
-    do_gen_eob_worker(s, inhibit, recheck_tf, false);
+    do_gen_eob_worker(s, inhibit, recheck_tf, false, false);
 }
 
 /* End of block.
@@ -2605,7 +2610,13 @@ static void gen_eob(DisasContext *s)
 /* Jump to register */
 static void gen_jr(DisasContext *s, TCGv dest)
 {
-    do_gen_eob_worker(s, false, false, true);
+    do_gen_eob_worker(s, false, false, true, false);
+}
+
+/* Return to the address in EIP */
+static void gen_jr_ret(DisasContext *s)
+{
+    do_gen_eob_worker(s, false, false, true, true);
 }
 
 /* generate a jump to eip. No segment change must happen before as a
@@ -2642,6 +2653,13 @@ static inline void gen_stq_env_A0(DisasContext *s, int offset)
 static inline void gen_ldo_env_A0(DisasContext *s, int offset)
 {
     int mem_index = s->mem_index;
+    if (tcg_can_qemu_ldst_v128(MO_LEQ)) {
+        TCGv_vec t = tcg_temp_new_vec(TCG_TYPE_V128);
+        tcg_gen_qemu_ld_v128(t, cpu_A0, mem_index, MO_LEQ);
+        tcg_gen_st_vec(t, cpu_env, offset);
+        tcg_temp_free_vec(t);
+        return;
+    }
     tcg_gen_qemu_ld_i64(cpu_tmp1_i64, cpu_A0, mem_index, MO_LEQ);
     tcg_gen_st_i64(cpu_tmp1_i64, cpu_env, offset + offsetof(ZMMReg, ZMM_Q(0)));
     tcg_gen_addi_tl(cpu_tmp0, cpu_A0, 8);
@@ -2652,6 +2670,13 @@ static inline void gen_ldo_env_A0(DisasContext *s, int offset)
 static inline void gen_sto_env_A0(DisasContext *s, int offset)
 {
     int mem_index = s->mem_index;
+    if (tcg_can_qemu_ldst_v128(MO_LEQ)) {
+        TCGv_vec t = tcg_temp_new_vec(TCG_TYPE_V128);
+        tcg_gen_ld_vec(t, cpu_env, offset);
+        tcg_gen_qemu_st_v128(t, cpu_A0, mem_index, MO_LEQ);
+        tcg_temp_free_vec(t);
+        return;
+    }
     tcg_gen_ld_i64(cpu_tmp1_i64, cpu_env, offset + offsetof(ZMMReg, ZMM_Q(0)));
     tcg_gen_qemu_st_i64(cpu_tmp1_i64, cpu_A0, mem_index, MO_LEQ);
     tcg_gen_addi_tl(cpu_tmp0, cpu_A0, 8);
@@ -2659,12 +2684,53 @@ static inline void gen_sto_env_A0(DisasContext *s, int offset)
     tcg_gen_qemu_st_i64(cpu_tmp1_i64, cpu_tmp0, mem_index, MO_LEQ);
 }
 
+#ifdef TARGET_X86_64
+/* CMPXCHG16B with an inline host compare-and-swap.  The atomic version
+   is also correct without a LOCK prefix: like the real instruction, it
+   writes the destination back when the comparison fails.  */
+static void gen_cmpxchg16b(DisasContext *s)
+{
+    TCGLabel *aligned = gen_new_label();
+    TCGv a0 = tcg_temp_local_new();
+    TCGv_i64 oldl = tcg_temp_new_i64();
+    TCGv_i64 oldh = tcg_temp_new_i64();
+    TCGv_i64 z = tcg_temp_new_i64();
+
+    /* A misaligned operand raises #GP.  */
+    gen_update_cc_op(s);
+    tcg_gen_mov_tl(a0, cpu_A0);
+    tcg_gen_andi_tl(cpu_tmp0, a0, 15);
+    tcg_gen_brcondi_tl(TCG_COND_EQ, cpu_tmp0, 0, aligned);
+    gen_jmp_im(s->pc_start - s->cs_base);
+    gen_helper_raise_exception(cpu_env, tcg_const_i32(EXCP0D_GPF));
+    gen_set_label(aligned);
+
+    gen_compute_eflags(s);
+    tcg_gen_atomic_cmpxchg_i128(oldl, oldh, a0,
+                                cpu_regs[R_EAX], cpu_regs[R_EDX],
+                                cpu_regs[R_EBX], cpu_regs[R_ECX],
+                                s->mem_index, MO_LEQ | MO_ALIGN_16);
+    tcg_temp_free(a0);
+
+    /* ZF is set on success, in which case EDX:EAX already holds the old
+       value; otherwise the old value is loaded into EDX:EAX.  */
+    tcg_gen_xor_i64(z, oldl, cpu_regs[R_EAX]);
+    tcg_gen_xor_i64(cpu_tmp1_i64, oldh, cpu_regs[R_EDX]);
+    tcg_gen_or_i64(z, z, cpu_tmp1_i64);
+    tcg_gen_setcondi_i64(TCG_COND_EQ, z, z, 0);
+    tcg_gen_deposit_tl(cpu_cc_src, cpu_cc_src, z, ctz32(CC_Z), 1);
+    tcg_gen_mov_i64(cpu_regs[R_EAX], oldl);
+    tcg_gen_mov_i64(cpu_regs[R_EDX], oldh);
+
+    tcg_temp_free_i64(oldl);
+    tcg_temp_free_i64(oldh);
+    tcg_temp_free_i64(z);
+}
+#endif
+
 static inline void gen_op_movo(int d_offset, int s_offset)
 {
-    tcg_gen_ld_i64(cpu_tmp1_i64, cpu_env, s_offset + offsetof(ZMMReg, ZMM_Q(0)));
-    tcg_gen_st_i64(cpu_tmp1_i64, cpu_env, d_offset + offsetof(ZMMReg, ZMM_Q(0)));
-    tcg_gen_ld_i64(cpu_tmp1_i64, cpu_env, s_offset + offsetof(ZMMReg, ZMM_Q(1)));
-    tcg_gen_st_i64(cpu_tmp1_i64, cpu_env, d_offset + offsetof(ZMMReg, ZMM_Q(1)));
+    tcg_gen_gvec_mov(MO_64, d_offset, s_offset, 16, 16);
 }
 
 static inline void gen_op_movq(int d_offset, int s_offset)
@@ -2837,6 +2903,128 @@ static const SSEFunc_0_epp sse_op_table1[256][4] = {
     [0xfe] = MMX_OP2(paddl),
 };
 
+/*
+ * Integer and logic operations that have a generic vector equivalent
+ * are expanded inline, using host vector instructions when the backend
+ * has them, rather than calling the sse_op_table1 helper.  Only the low
+ * 8 (MMX) or 16 (SSE) bytes are written, as legacy SSE encodings leave
+ * the upper part of the AVX registers alone.
+ *
+ * Returns true if the operation was expanded.
+ */
+static bool gen_sse_gvec(int b, uint32_t oprsz, int op1_offset,
+                         int op2_offset)
+{
+    if (op1_offset == op2_offset) {
+        /* Zeroing and all-ones idioms do not depend on the input */
+        switch (b) {
+        case 0x57: /* xorps, xorpd */
+        case 0xef: /* pxor */
+        case 0xf8 ... 0xfb: /* psub */
+        case 0x64 ... 0x66: /* pcmpgt */
+            tcg_gen_gvec_dup8i(op1_offset, oprsz, oprsz, 0);
+            return true;
+        case 0x74 ... 0x76: /* pcmpeq */
+            tcg_gen_gvec_dup8i(op1_offset, oprsz, oprsz, 0xff);
+            return true;
+        }
+    }
+
+    switch (b) {
+    case 0x54: /* andps, andpd */
+    case 0xdb: /* pand */
+        tcg_gen_gvec_and(MO_64, op1_offset, op1_offset, op2_offset,
+                         oprsz, oprsz);
+        break;
+    case 0x55: /* andnps, andnpd */
+    case 0xdf: /* pandn */
+        tcg_gen_gvec_andc(MO_64, op1_offset, op2_offset, op1_offset,
+                          oprsz, oprsz);
+        break;
+    case 0x56: /* orps, orpd */
+    case 0xeb: /* por */
+        tcg_gen_gvec_or(MO_64, op1_offset, op1_offset, op2_offset,
+                        oprsz, oprsz);
+        break;
+    case 0x57: /* xorps, xorpd */
+    case 0xef: /* pxor */
+        tcg_gen_gvec_xor(MO_64, op1_offset, op1_offset, op2_offset,
+                         oprsz, oprsz);
+        break;
+    case 0xfc ... 0xfe: /* paddb, paddw, paddl */
+        tcg_gen_gvec_add(b - 0xfc, op1_offset, op1_offset, op2_offset,
+                         oprsz, oprsz);
+        break;
+    case 0xd4: /* paddq */
+        tcg_gen_gvec_add(MO_64, op1_offset, op1_offset, op2_offset,
+                         oprsz, oprsz);
+        break;
+    case 0xf8 ... 0xfb: /* psubb, psubw, psubl, psubq */
+        tcg_gen_gvec_sub(b - 0xf8, op1_offset, op1_offset, op2_offset,
+                         oprsz, oprsz);
+        break;
+    case 0xec ... 0xed: /* paddsb, paddsw */
+        tcg_gen_gvec_ssadd(b - 0xec, op1_offset, op1_offset, op2_offset,
+                           oprsz, oprsz);
+        break;
+    case 0xdc ... 0xdd: /* paddusb, paddusw */
+        tcg_gen_gvec_usadd(b - 0xdc, op1_offset, op1_offset, op2_offset,
+                           oprsz, oprsz);
+        break;
+    case 0xe8 ... 0xe9: /* psubsb, psubsw */
+        tcg_gen_gvec_sssub(b - 0xe8, op1_offset, op1_offset, op2_offset,
+                           oprsz, oprsz);
+        break;
+    case 0xd8 ... 0xd9: /* psubusb, psubusw */
+        tcg_gen_gvec_ussub(b - 0xd8, op1_offset, op1_offset, op2_offset,
+                           oprsz, oprsz);
+        break;
+    case 0x74 ... 0x76: /* pcmpeqb, pcmpeqw, pcmpeql */
+        tcg_gen_gvec_cmp(TCG_COND_EQ, b - 0x74, op1_offset, op1_offset,
+                         op2_offset, oprsz, oprsz);
+        break;
+    case 0x64 ... 0x66: /* pcmpgtb, pcmpgtw, pcmpgtl */
+        tcg_gen_gvec_cmp(TCG_COND_GT, b - 0x64, op1_offset, op1_offset,
+                         op2_offset, oprsz, oprsz);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Shift by immediate, the 0x71...0x73 groups.  Counts beyond the
+ * element width clear the element, or fill it with the sign bit.
+ *
+ * Returns true if the operation was expanded.
+ */
+static bool gen_sse_gvec_shifti(int vece, int op, int ofs, uint32_t oprsz,
+                                int count)
+{
+    int bits = 8 << vece;
+
+    switch (op) {
+    case 2: /* psrl */
+    case 6: /* psll */
+        if (count >= bits) {
+            tcg_gen_gvec_dup8i(ofs, oprsz, oprsz, 0);
+        } else if (op == 2) {
+            tcg_gen_gvec_shri(vece, ofs, ofs, count, oprsz, oprsz);
+        } else {
+            tcg_gen_gvec_shli(vece, ofs, ofs, count, oprsz, oprsz);
+        }
+        break;
+    case 4: /* psra */
+        tcg_gen_gvec_sari(vece, ofs, ofs, MIN(count, bits - 1),
+                          oprsz, oprsz);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
 static const SSEFunc_0_epp sse_op_table2[3 * 8][2] = {
     [0 + 2] = MMX_OP2(psrlw),
     [0 + 4] = MMX_OP2(psraw),
@@ -3424,6 +3612,23 @@ static void gen_sse(CPUX86State *env, DisasContext *s, int b,
 	        goto unknown_op;
             }
             val = x86_ldub_code(env, s);
+            sse_fn_epp = sse_op_table2[((b - 1) & 3) * 8 +
+                                       (((modrm >> 3)) & 7)][b1];
+            if (!sse_fn_epp) {
+                goto unknown_op;
+            }
+            if (is_xmm) {
+                rm = (modrm & 7) | REX_B(s);
+                op2_offset = offsetof(CPUX86State,xmm_regs[rm]);
+            } else {
+                rm = (modrm & 7);
+                op2_offset = offsetof(CPUX86State,fpregs[rm].mmx);
+            }
+            if (gen_sse_gvec_shifti(((b - 1) & 3) + MO_16, (modrm >> 3) & 7,
+                                    op2_offset, is_xmm ? 16 : 8, val)) {
+                break;
+            }
+            /* The helpers take the shift count from memory */
             if (is_xmm) {
                 tcg_gen_movi_tl(cpu_T0, val);
                 tcg_gen_st32_tl(cpu_T0, cpu_env, offsetof(CPUX86State,xmm_t0.ZMM_L(0)));
@@ -3437,18 +3642,6 @@ static void gen_sse(CPUX86State *env, DisasContext *s, int b,
                 tcg_gen_st32_tl(cpu_T0, cpu_env, offsetof(CPUX86State,mmx_t0.MMX_L(1)));
                 op1_offset = offsetof(CPUX86State,mmx_t0);
             }
-            sse_fn_epp = sse_op_table2[((b - 1) & 3) * 8 +
-                                       (((modrm >> 3)) & 7)][b1];
-            if (!sse_fn_epp) {
-                goto unknown_op;
-            }
-            if (is_xmm) {
-                rm = (modrm & 7) | REX_B(s);
-                op2_offset = offsetof(CPUX86State,xmm_regs[rm]);
-            } else {
-                rm = (modrm & 7);
-                op2_offset = offsetof(CPUX86State,fpregs[rm].mmx);
-            }
             tcg_gen_addi_ptr(cpu_ptr0, cpu_env, op2_offset);
             tcg_gen_addi_ptr(cpu_ptr1, cpu_env, op1_offset);
             sse_fn_epp(cpu_env, cpu_ptr0, cpu_ptr1);
@@ -4441,6 +4634,9 @@ static void gen_sse(CPUX86State *env, DisasContext *s, int b,
             sse_fn_eppt(cpu_env, cpu_ptr0, cpu_ptr1, cpu_A0);
             break;
         default:
+            if (gen_sse_gvec(b, is_xmm ? 16 : 8, op1_offset, op2_offset)) {
+                break;
+            }
             tcg_gen_addi_ptr(cpu_ptr0, cpu_env, op1_offset);
             tcg_gen_addi_ptr(cpu_ptr1, cpu_env, op2_offset);
             sse_fn_epp(cpu_env, cpu_ptr0, cpu_ptr1);
@@ -5030,6 +5226,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             next_eip = s->pc - s->cs_base;
             tcg_gen_movi_tl(cpu_T1, next_eip);
             gen_push_v(s, cpu_T1);
+            tcg_gen_push_return_address(s->cs_base + next_eip);
             gen_op_jmp_v(cpu_T0);
             gen_bnd_jmp(s);
             gen_jr(s, cpu_T0);
@@ -5306,7 +5503,10 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             if (!(s->cpuid_ext_features & CPUID_EXT_CX16))
                 goto illegal_op;
             gen_lea_modrm(env, s, modrm);
-            if ((s->prefix & PREFIX_LOCK) && (tb_cflags(s->base.tb) & CF_PARALLEL)) {
+            if (tcg_can_atomic_cmpxchg_i128(MO_LEQ)) {
+                gen_cmpxchg16b(s);
+            } else if ((s->prefix & PREFIX_LOCK)
+                       && (tb_cflags(s->base.tb) & CF_PARALLEL)) {
                 gen_helper_cmpxchg16b(cpu_env, cpu_A0);
             } else {
                 gen_helper_cmpxchg16b_unlocked(cpu_env, cpu_A0);
@@ -6451,7 +6651,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
         /* Note that gen_pop_T0 uses a zero-extending load.  */
         gen_op_jmp_v(cpu_T0);
         gen_bnd_jmp(s);
-        gen_jr(s, cpu_T0);
+        gen_jr_ret(s);
         break;
     case 0xc3: /* ret */
         ot = gen_pop_T0(s);
@@ -6459,7 +6659,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
         /* Note that gen_pop_T0 uses a zero-extending load.  */
         gen_op_jmp_v(cpu_T0);
         gen_bnd_jmp(s);
-        gen_jr(s, cpu_T0);
+        gen_jr_ret(s);
         break;
     case 0xca: /* lret im */
         val = x86_ldsw_code(env, s);
@@ -6524,6 +6724,7 @@ static target_ulong disas_insn(DisasContext *s, CPUState *cpu)
             }
             tcg_gen_movi_tl(cpu_T0, next_eip);
             gen_push_v(s, cpu_T0);
+            tcg_gen_push_return_address(s->cs_base + next_eip);
             gen_bnd_jmp(s);
             gen_jmp(s, tval);
         }
@@ -120,6 +120,7 @@ typedef enum {
 #define TCG_TARGET_HAS_muls2_i64        0
 #define TCG_TARGET_HAS_muluh_i64        1
 #define TCG_TARGET_HAS_mulsh_i64        1
+#define TCG_TARGET_HAS_cmpxchg2_i64     1
 #define TCG_TARGET_HAS_direct_jump      1
 
 #define TCG_TARGET_HAS_v64              1
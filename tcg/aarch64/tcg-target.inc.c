@@ -394,6 +394,10 @@ typedef enum {
     I3305_LDR_v64   = 0x5c000000,
     I3305_LDR_v128  = 0x9c000000,
 
+    /* Load/store exclusive.  */
+    I3306_LDAXP     = 0xc87f8000,
+    I3306_STLXP     = 0xc8208000,
+
     /* Load/store register.  Described here as 3.3.12, but the helper
        that emits them can transform to 3.3.10 or 3.3.13.  */
     I3312_STRB      = 0x38000000 | LDST_ST << 22 | MO_8 << 30,
@@ -568,6 +572,12 @@ static void tcg_out_insn_3305(TCGContext *s, AArch64Insn insn, int imm19, TCGReg
     tcg_out32(s, insn | (imm19 & 0x7ffff) << 5 | rt);
 }
 
+static void tcg_out_insn_3306(TCGContext *s, AArch64Insn insn, TCGReg rs,
+                              TCGReg rt2, TCGReg rn, TCGReg rt)
+{
+    tcg_out32(s, insn | rs << 16 | rt2 << 10 | rn << 5 | rt);
+}
+
 static void tcg_out_insn_3201(TCGContext *s, AArch64Insn insn, TCGType ext,
                               TCGReg rt, int imm19)
 {
@@ -1341,6 +1351,32 @@ static inline void tcg_out_mb(TCGContext *s, TCGArg a0)
     tcg_out32(s, sync[a0 & TCG_MO_ALL]);
 }
 
+/* Compare and swap the 16 bytes at ADDR with an exclusive pair.  When
+   the comparison fails, the old value is stored back so that the value
+   returned in RH:RL was read atomically.  The outputs are early-clobber,
+   since the loop rereads the inputs after writing them.  */
+static void tcg_out_cmpxchg2(TCGContext *s, TCGReg rl, TCGReg rh,
+                             TCGReg addr, TCGReg cl, TCGReg ch,
+                             TCGReg nl, TCGReg nh)
+{
+    tcg_insn_unit *retry = s->code_ptr;
+
+    tcg_out_insn(s, 3306, LDAXP, TCG_REG_XZR, rh, addr, rl);
+    tcg_out_cmp(s, TCG_TYPE_I64, rl, cl, false);
+    tcg_out_insn(s, 3202, B_C, TCG_COND_NE, 6);
+    tcg_out_cmp(s, TCG_TYPE_I64, rh, ch, false);
+    tcg_out_insn(s, 3202, B_C, TCG_COND_NE, 4);
+    tcg_out_insn(s, 3306, STLXP, TCG_REG_TMP, nh, addr, nl);
+    tcg_out_insn(s, 3201, CBNZ, TCG_TYPE_I32, TCG_REG_TMP,
+                 retry - s->code_ptr);
+    tcg_out_insn(s, 3206, B, 3);
+
+    /* Comparison failed: complete the exclusive access.  */
+    tcg_out_insn(s, 3306, STLXP, TCG_REG_TMP, rh, addr, rl);
+    tcg_out_insn(s, 3201, CBNZ, TCG_TYPE_I32, TCG_REG_TMP,
+                 retry - s->code_ptr);
+}
+
 static void tcg_out_cltz(TCGContext *s, TCGType ext, TCGReg d,
                          TCGReg a0, TCGArg b, bool const_b, bool is_ctz)
 {
@@ -2081,6 +2117,10 @@ static void tcg_out_op(TCGContext *s, TCGOpcode opc,
         tcg_out_insn(s, 3508, SMULH, TCG_TYPE_I64, a0, a1, a2);
         break;
 
+    case INDEX_op_cmpxchg2_i64:
+        tcg_out_cmpxchg2(s, a0, a1, a2, args[3], args[4], args[5], args[6]);
+        break;
+
     case INDEX_op_mb:
         tcg_out_mb(s, a0);
         break;
@@ -2268,6 +2308,8 @@ static const TCGTargetOpDef *tcg_target_op_def(TCGOpcode op)
         = { .args_ct_str = { "r", "r", "rA", "rZ", "rZ" } };
     static const TCGTargetOpDef add2
         = { .args_ct_str = { "r", "r", "rZ", "rZ", "rA", "rMZ" } };
+    static const TCGTargetOpDef cmpxchg2
+        = { .args_ct_str = { "&r", "&r", "r", "r", "r", "r", "r" } };
 
     switch (op) {
     case INDEX_op_goto_ptr:
@@ -2400,6 +2442,9 @@ static const TCGTargetOpDef *tcg_target_op_def(TCGOpcode op)
     case INDEX_op_sub2_i64:
         return &add2;
 
+    case INDEX_op_cmpxchg2_i64:
+        return &cmpxchg2;
+
     case INDEX_op_add_vec:
     case INDEX_op_sub_vec:
     case INDEX_op_mul_vec:
@@ -99,6 +99,7 @@ extern bool have_bmi1;
 extern bool have_popcnt;
 extern bool have_avx1;
 extern bool have_avx2;
+extern bool have_cmpxchg16b;
 
 /* optional instructions */
 #define TCG_TARGET_HAS_div2_i32         1
@@ -166,6 +167,7 @@ extern bool have_avx2;
 #define TCG_TARGET_HAS_muls2_i64        1
 #define TCG_TARGET_HAS_muluh_i64        0
 #define TCG_TARGET_HAS_mulsh_i64        0
+#define TCG_TARGET_HAS_cmpxchg2_i64     have_cmpxchg16b
 #endif
 
 /* We do not support older SSE systems, only beginning with AVX1.  */
@@ -154,6 +154,7 @@ bool have_bmi1;
 bool have_popcnt;
 bool have_avx1;
 bool have_avx2;
+bool have_cmpxchg16b;
 
 #ifdef CONFIG_CPUID_H
 static bool have_movbe;
@@ -340,6 +341,7 @@ static inline int tcg_target_const_match(tcg_target_long val, TCGType type,
 #define OPC_BSWAP	(0xc8 | P_EXT)
 #define OPC_CALL_Jz	(0xe8)
 #define OPC_CMOVCC      (0x40 | P_EXT)  /* ... plus condition code */
+#define OPC_CMPXCHG16B  (0xc7 | P_EXT | P_REXW)
 #define OPC_CMP_GvEv	(OPC_ARITH_GvEv | (ARITH_CMP << 3))
 #define OPC_DEC_r32	(0x48)
 #define OPC_IMUL_GvEv	(0xaf | P_EXT)
@@ -2554,6 +2556,13 @@ static inline void tcg_out_op(TCGContext *s, TCGOpcode opc,
     case INDEX_op_ext32s_i64:
         tcg_out_ext32s(s, a0, a1);
         break;
+
+    case INDEX_op_cmpxchg2_i64:
+        /* The constraints place the comparison value and the result in
+           RDX:RAX, and the new value in RCX:RBX.  */
+        tcg_out8(s, 0xf0); /* lock */
+        tcg_out_modrm_offset(s, OPC_CMPXCHG16B, 1, a2, 0);
+        break;
 #endif
 
     OP_32_64(deposit):
@@ -2972,6 +2981,12 @@ static const TCGTargetOpDef *tcg_target_op_def(TCGOpcode op)
                 = { .args_ct_str = { "a", "d", "a", "r" } };
             return &mul2;
         }
+    case INDEX_op_cmpxchg2_i64:
+        {
+            static const TCGTargetOpDef cmpxchg2
+                = { .args_ct_str = { "a", "d", "r", "0", "1", "b", "c" } };
+            return &cmpxchg2;
+        }
     case INDEX_op_add2_i32:
     case INDEX_op_add2_i64:
     case INDEX_op_sub2_i32:
@@ -3487,6 +3502,9 @@ static void tcg_target_init(TCGContext *s)
            need to probe for it.  */
         have_movbe = (c & bit_MOVBE) != 0;
         have_popcnt = (c & bit_POPCNT) != 0;
+        /* CMPXCHG16B needs REX.W, so it is only usable on x86_64.  */
+        have_cmpxchg16b = (TCG_TARGET_REG_BITS == 64
+                           && (c & bit_CMPXCHG16B) != 0);
 
         /* There are a number of things we must check before we can be
            sure of not hitting invalid opcode.  */
@@ -1493,8 +1493,13 @@ void tcg_optimize(TCGContext *s)
             case INDEX_op_qemu_ld_i64:
             case INDEX_op_qemu_st_i32:
             case INDEX_op_qemu_st_i64:
+            case INDEX_op_ld_vec:
+            case INDEX_op_st_vec:
+            case INDEX_op_cmpxchg2_i64:
             case INDEX_op_call:
-                /* Opcodes that touch guest memory stop the optimization.  */
+                /* Opcodes that touch guest memory stop the optimization.
+                   In user mode, that includes the host memory operations
+                   that tcg_gen_qemu_ld_v128 and friends emit.  */
                 prev_mb = NULL;
                 break;
             }
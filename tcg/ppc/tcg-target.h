@@ -122,6 +122,7 @@ extern bool have_isa_3_00;
 #define TCG_TARGET_HAS_muls2_i64        0
 #define TCG_TARGET_HAS_muluh_i64        1
 #define TCG_TARGET_HAS_mulsh_i64        1
+#define TCG_TARGET_HAS_cmpxchg2_i64     0
 #endif
 
 void flush_icache_range(uintptr_t start, uintptr_t stop);
@@ -128,6 +128,7 @@ extern uint64_t s390_facilities;
 #define TCG_TARGET_HAS_muls2_i64      0
 #define TCG_TARGET_HAS_muluh_i64      0
 #define TCG_TARGET_HAS_mulsh_i64      0
+#define TCG_TARGET_HAS_cmpxchg2_i64   0
 
 /* used for function call generation */
 #define TCG_REG_CALL_STACK		TCG_REG_R15
@@ -2546,6 +2546,27 @@ void tcg_gen_lookup_and_goto_ptr(void)
     }
 }
 
+void tcg_gen_lookup_and_goto_ptr_ret(void)
+{
+    if (TCG_TARGET_HAS_goto_ptr && !qemu_loglevel_mask(CPU_LOG_TB_NOCHAIN)) {
+        TCGv_ptr ptr = tcg_temp_new_ptr();
+        gen_helper_lookup_tb_ptr_ret(ptr, cpu_env);
+        tcg_gen_op1i(INDEX_op_goto_ptr, tcgv_ptr_arg(ptr));
+        tcg_temp_free_ptr(ptr);
+    } else {
+        tcg_gen_exit_tb(0);
+    }
+}
+
+void tcg_gen_push_return_address(target_ulong pc)
+{
+    if (TCG_TARGET_HAS_goto_ptr && !qemu_loglevel_mask(CPU_LOG_TB_NOCHAIN)) {
+        TCGv t = tcg_const_tl(pc);
+        gen_helper_ras_push(cpu_env, t);
+        tcg_temp_free(t);
+    }
+}
+
 static inline TCGMemOp tcg_canonicalize_memop(TCGMemOp op, bool is64, bool st)
 {
     /* Trigger the asserts within as early as possible.  */
@@ -2671,6 +2692,73 @@ void tcg_gen_qemu_st_i64(TCGv_i64 val, TCGv addr, TCGArg idx, TCGMemOp memop)
     gen_ldst_i64(INDEX_op_qemu_st_i64, val, addr, memop, idx);
 }
 
+/* In user mode on a 64-bit little-endian host, guest memory is mapped
+   directly at guest_base.  A 16-byte access can then be emitted as one
+   host vector load or store, or one host compare-and-swap, instead of
+   a pair of 64-bit accesses or a helper call.  A fault in that code is
+   handled by the host signal handler exactly like one in qemu_ld.  */
+#if defined(CONFIG_USER_ONLY) && TCG_TARGET_REG_BITS == 64 \
+    && !defined(HOST_WORDS_BIGENDIAN)
+# define TCG_DIRECT_GUEST_ACCESS 1
+
+static TCGv_ptr tcg_gen_guest_host_addr(TCGv addr)
+{
+    TCGv_ptr ptr = tcg_temp_new_ptr();
+
+#if TARGET_LONG_BITS == 32
+    tcg_gen_extu_i32_i64(TCGV_PTR_TO_NAT(ptr), addr);
+#else
+    tcg_gen_mov_i64(TCGV_PTR_TO_NAT(ptr), addr);
+#endif
+    tcg_gen_addi_ptr(ptr, ptr, guest_base);
+    return ptr;
+}
+#else
+# define TCG_DIRECT_GUEST_ACCESS 0
+#endif
+
+bool tcg_can_qemu_ldst_v128(TCGMemOp memop)
+{
+    return TCG_DIRECT_GUEST_ACCESS && TCG_TARGET_HAS_v128
+           && !(memop & MO_BSWAP);
+}
+
+void tcg_gen_qemu_ld_v128(TCGv_vec val, TCGv addr, TCGArg idx,
+                          TCGMemOp memop)
+{
+#if TCG_DIRECT_GUEST_ACCESS
+    TCGv_ptr ptr;
+
+    tcg_debug_assert(tcg_can_qemu_ldst_v128(memop));
+    tcg_gen_req_mo(TCG_MO_LD_LD | TCG_MO_ST_LD);
+    trace_guest_mem_before_tcg(tcg_ctx->cpu, cpu_env,
+                               addr, trace_mem_get_info(memop, 0));
+    ptr = tcg_gen_guest_host_addr(addr);
+    tcg_gen_ld_vec(val, ptr, 0);
+    tcg_temp_free_ptr(ptr);
+#else
+    g_assert_not_reached();
+#endif
+}
+
+void tcg_gen_qemu_st_v128(TCGv_vec val, TCGv addr, TCGArg idx,
+                          TCGMemOp memop)
+{
+#if TCG_DIRECT_GUEST_ACCESS
+    TCGv_ptr ptr;
+
+    tcg_debug_assert(tcg_can_qemu_ldst_v128(memop));
+    tcg_gen_req_mo(TCG_MO_LD_ST | TCG_MO_ST_ST);
+    trace_guest_mem_before_tcg(tcg_ctx->cpu, cpu_env,
+                               addr, trace_mem_get_info(memop, 1));
+    ptr = tcg_gen_guest_host_addr(addr);
+    tcg_gen_st_vec(val, ptr, 0);
+    tcg_temp_free_ptr(ptr);
+#else
+    g_assert_not_reached();
+#endif
+}
+
 static void tcg_gen_ext_i32(TCGv_i32 ret, TCGv_i32 val, TCGMemOp opc)
 {
     switch (opc & MO_SSIZE) {
@@ -2859,6 +2947,44 @@ void tcg_gen_atomic_cmpxchg_i64(TCGv_i64 retv, TCGv addr, TCGv_i64 cmpv,
     }
 }
 
+bool tcg_can_atomic_cmpxchg_i128(TCGMemOp memop)
+{
+    return TCG_DIRECT_GUEST_ACCESS && TCG_TARGET_HAS_cmpxchg2_i64
+           && !(memop & MO_BSWAP);
+}
+
+/* Compare the 16 bytes at ADDR with CMPH:CMPL and, if equal, replace
+   them with NEWH:NEWL.  The old contents are returned in RETH:RETL.
+   The caller is responsible for any alignment check.  */
+void tcg_gen_atomic_cmpxchg_i128(TCGv_i64 retl, TCGv_i64 reth, TCGv addr,
+                                 TCGv_i64 cmpl, TCGv_i64 cmph,
+                                 TCGv_i64 newl, TCGv_i64 newh,
+                                 TCGArg idx, TCGMemOp memop)
+{
+#if TCG_DIRECT_GUEST_ACCESS
+    TCGv_ptr ptr;
+    TCGOp *op;
+
+    tcg_debug_assert(tcg_can_atomic_cmpxchg_i128(memop));
+    trace_guest_mem_before_tcg(tcg_ctx->cpu, cpu_env,
+                               addr, trace_mem_get_info(memop, 1));
+    ptr = tcg_gen_guest_host_addr(addr);
+
+    op = tcg_emit_op(INDEX_op_cmpxchg2_i64);
+    op->args[0] = tcgv_i64_arg(retl);
+    op->args[1] = tcgv_i64_arg(reth);
+    op->args[2] = tcgv_ptr_arg(ptr);
+    op->args[3] = tcgv_i64_arg(cmpl);
+    op->args[4] = tcgv_i64_arg(cmph);
+    op->args[5] = tcgv_i64_arg(newl);
+    op->args[6] = tcgv_i64_arg(newh);
+
+    tcg_temp_free_ptr(ptr);
+#else
+    g_assert_not_reached();
+#endif
+}
+
 static void do_nonatomic_op_i32(TCGv_i32 ret, TCGv addr, TCGv_i32 val,
                                 TCGArg idx, TCGMemOp memop, bool new_val,
                                 void (*gen)(TCGv_i32, TCGv_i32, TCGv_i32))
@@ -805,6 +805,23 @@ void tcg_gen_goto_tb(unsigned idx);
  */
 void tcg_gen_lookup_and_goto_ptr(void);
 
+/**
+ * tcg_gen_lookup_and_goto_ptr_ret() - as tcg_gen_lookup_and_goto_ptr(),
+ * for guest return instructions
+ *
+ * The target TB is predicted with the return addresses recorded by
+ * tcg_gen_push_return_address().
+ */
+void tcg_gen_lookup_and_goto_ptr_ret(void);
+
+/**
+ * tcg_gen_push_return_address() - record the return address of a guest call
+ * @pc: Guest pc of the return address, as computed by cpu_get_tb_cpu_state()
+ *
+ * This is only a hint; it is fine for returns not to match the calls.
+ */
+void tcg_gen_push_return_address(target_ulong pc);
+
 #if TARGET_LONG_BITS == 32
 #define tcg_temp_new() tcg_temp_new_i32()
 #define tcg_global_reg_new tcg_global_reg_new_i32
@@ -888,6 +905,16 @@ void tcg_gen_atomic_cmpxchg_i32(TCGv_i32, TCGv, TCGv_i32, TCGv_i32,
 void tcg_gen_atomic_cmpxchg_i64(TCGv_i64, TCGv, TCGv_i64, TCGv_i64,
                                 TCGArg, TCGMemOp);
 
+/* 16-byte guest accesses that are emitted inline when the guest memory
+   is directly addressable (user mode on a 64-bit little-endian host).
+   Only valid when the matching tcg_can_* function returns true.  */
+bool tcg_can_qemu_ldst_v128(TCGMemOp);
+void tcg_gen_qemu_ld_v128(TCGv_vec, TCGv, TCGArg, TCGMemOp);
+void tcg_gen_qemu_st_v128(TCGv_vec, TCGv, TCGArg, TCGMemOp);
+bool tcg_can_atomic_cmpxchg_i128(TCGMemOp);
+void tcg_gen_atomic_cmpxchg_i128(TCGv_i64, TCGv_i64, TCGv, TCGv_i64, TCGv_i64,
+                                 TCGv_i64, TCGv_i64, TCGArg, TCGMemOp);
+
 void tcg_gen_atomic_xchg_i32(TCGv_i32, TCGv, TCGv_i32, TCGArg, TCGMemOp);
 void tcg_gen_atomic_xchg_i64(TCGv_i64, TCGv, TCGv_i64, TCGArg, TCGMemOp);
 void tcg_gen_atomic_fetch_add_i32(TCGv_i32, TCGv, TCGv_i32, TCGArg, TCGMemOp);
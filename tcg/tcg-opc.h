@@ -185,6 +185,10 @@ DEF(muls2_i64, 2, 2, 0, IMPL64 | IMPL(TCG_TARGET_HAS_muls2_i64))
 DEF(muluh_i64, 1, 2, 0, IMPL(TCG_TARGET_HAS_muluh_i64))
 DEF(mulsh_i64, 1, 2, 0, IMPL(TCG_TARGET_HAS_mulsh_i64))
 
+/* 16-byte compare-and-swap on host memory.  */
+DEF(cmpxchg2_i64, 2, 5, 0,
+    IMPL64 | TCG_OPF_SIDE_EFFECTS | IMPL(TCG_TARGET_HAS_cmpxchg2_i64))
+
 #define TLADDR_ARGS  (TARGET_LONG_BITS <= TCG_TARGET_REG_BITS ? 1 : 2)
 #define DATA64_ARGS  (TCG_TARGET_REG_BITS == 64 ? 1 : 2)
 
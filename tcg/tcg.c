@@ -134,6 +134,7 @@ static bool tcg_out_ldst_finalize(TCGContext *s);
 static TCGContext **tcg_ctxs;
 static unsigned int n_tcg_ctxs;
 TCGv_env cpu_env = 0;
+TCGRegAllocMode tcg_regalloc_mode;
 
 /*
  * We divide code_gen_buffer into equally-sized "regions" that TCG threads
@@ -869,6 +870,8 @@ void tcg_func_start(TCGContext *s)
     s->nb_labels = 0;
     s->current_frame_offset = s->frame_start;
 
+    s->tb_nopersist = false;
+
 #ifdef CONFIG_DEBUG_TCG
     s->goto_tb_issue_mask = 0;
 #endif
@@ -877,6 +880,19 @@ void tcg_func_start(TCGContext *s)
     QTAILQ_INIT(&s->free_ops);
 }
 
+#ifdef CONFIG_USER_ONLY
+/* Bounds of the QEMU image, provided by the linker */
+extern const char __executable_start[], _end[];
+
+intptr_t tcg_ptr_value(const void *p)
+{
+    if ((const char *)p < __executable_start || (const char *)p >= _end) {
+        tcg_ctx->tb_nopersist = true;
+    }
+    return (intptr_t)p;
+}
+#endif
+
 static inline TCGTemp *tcg_temp_alloc(TCGContext *s)
 {
     int n = s->nb_temps++;
@@ -1380,6 +1396,8 @@ bool tcg_op_supported(TCGOpcode op)
         return TCG_TARGET_HAS_muluh_i64;
     case INDEX_op_mulsh_i64:
         return TCG_TARGET_HAS_mulsh_i64;
+    case INDEX_op_cmpxchg2_i64:
+        return TCG_TARGET_HAS_cmpxchg2_i64;
 
     case INDEX_op_mov_vec:
     case INDEX_op_dup_vec:
@@ -1558,7 +1576,7 @@ void tcg_gen_callN(void *func, TCGTemp *ret, int nargs, TCGTemp **args)
         op->args[pi++] = temp_arg(args[i]);
         real_args++;
     }
-    op->args[pi++] = (uintptr_t)func;
+    op->args[pi++] = tcg_ptr_value(func);
     op->args[pi++] = flags;
     TCGOP_CALLI(op) = real_args;
 
@@ -2521,20 +2539,34 @@ static void check_regs(TCGContext *s)
 
 static void temp_allocate_frame(TCGContext *s, TCGTemp *ts)
 {
+    tcg_target_long size, align;
+
+    /* Vector temps need a slot as wide as the vector; the frame is only
+       guaranteed 16-byte alignment, so do not ask for more than that.  */
+    switch (ts->type) {
+    case TCG_TYPE_V64:
+    case TCG_TYPE_V128:
+    case TCG_TYPE_V256:
+        size = 8 << (ts->type - TCG_TYPE_V64);
+        align = MIN(size, 16);
+        break;
+    default:
+        size = align = sizeof(tcg_target_long);
+        break;
+    }
+
 #if !(defined(__sparc__) && TCG_TARGET_REG_BITS == 64)
     /* Sparc64 stack is accessed with offset of 2047 */
-    s->current_frame_offset = (s->current_frame_offset +
-                               (tcg_target_long)sizeof(tcg_target_long) - 1) &
-        ~(sizeof(tcg_target_long) - 1);
+    s->current_frame_offset = (s->current_frame_offset + align - 1) &
+        ~(align - 1);
 #endif
-    if (s->current_frame_offset + (tcg_target_long)sizeof(tcg_target_long) >
-        s->frame_end) {
+    if (s->current_frame_offset + size > s->frame_end) {
         tcg_abort();
     }
     ts->mem_offset = s->current_frame_offset;
     ts->mem_base = s->frame_temp;
     ts->mem_allocated = 1;
-    s->current_frame_offset += sizeof(tcg_target_long);
+    s->current_frame_offset += size;
 }
 
 static void temp_load(TCGContext *, TCGTemp *, TCGRegSet, TCGRegSet);
@@ -2617,35 +2649,241 @@ static void tcg_reg_free(TCGContext *s, TCGReg reg, TCGRegSet allocated_regs)
     }
 }
 
+/*
+ * Live ranges for TCG_REGALLOC_SPILL_COST.  Ops are numbered in order,
+ * and each reference to a temp is recorded as (position << 1) | write,
+ * where write is set if the op writes the temp without reading it.
+ * Calls are recorded as (position << 1) | save, where save is set if
+ * the call saves globals to memory.
+ */
+typedef struct TCGLiveRanges {
+    int pos;            /* position of the op being allocated */
+    int *refs;          /* references, grouped by temp and sorted */
+    int *ref_next;      /* per temp, next entry of refs to look at */
+    int *ref_end;       /* per temp, end of its entries in refs */
+    int *calls;
+    int nb_calls;
+    int call_next;
+} TCGLiveRanges;
+
+#define LR_NONE  INT_MAX
+
+static void tcg_op_nb_args(const TCGOp *op, int *nb_oargs, int *nb_iargs)
+{
+    if (op->opc == INDEX_op_call) {
+        *nb_oargs = TCGOP_CALLO(op);
+        *nb_iargs = TCGOP_CALLI(op);
+    } else {
+        *nb_oargs = tcg_op_defs[op->opc].nb_oargs;
+        *nb_iargs = tcg_op_defs[op->opc].nb_iargs;
+    }
+}
+
+/* Called after liveness analysis, once the op list is final.  */
+static void tcg_live_ranges_init(TCGContext *s)
+{
+    TCGLiveRanges *lr = tcg_malloc(sizeof(*lr));
+    int nb_temps = s->nb_temps;
+    int nb_refs, nb_oargs, nb_iargs, pos, i;
+    TCGOp *op;
+
+    lr->ref_next = tcg_malloc(nb_temps * sizeof(int));
+    lr->ref_end = tcg_malloc(nb_temps * sizeof(int));
+    memset(lr->ref_end, 0, nb_temps * sizeof(int));
+
+    /* Count the references to each temp, and the calls */
+    lr->nb_calls = 0;
+    QTAILQ_FOREACH(op, &s->ops, link) {
+        tcg_op_nb_args(op, &nb_oargs, &nb_iargs);
+        for (i = 0; i < nb_oargs + nb_iargs; i++) {
+            if (op->args[i] != TCG_CALL_DUMMY_ARG) {
+                lr->ref_end[temp_idx(arg_temp(op->args[i]))]++;
+            }
+        }
+        lr->nb_calls += op->opc == INDEX_op_call;
+    }
+
+    nb_refs = 0;
+    for (i = 0; i < nb_temps; i++) {
+        int n = lr->ref_end[i];
+
+        lr->ref_next[i] = lr->ref_end[i] = nb_refs;
+        nb_refs += n;
+    }
+    lr->refs = tcg_malloc(nb_refs * sizeof(int) + 1);
+    lr->calls = tcg_malloc(lr->nb_calls * sizeof(int) + 1);
+
+    /* Record them; ref_end moves to the end of each temp's entries */
+    pos = 0;
+    lr->nb_calls = 0;
+    QTAILQ_FOREACH(op, &s->ops, link) {
+        tcg_op_nb_args(op, &nb_oargs, &nb_iargs);
+        for (i = 0; i < nb_oargs + nb_iargs; i++) {
+            if (op->args[i] != TCG_CALL_DUMMY_ARG) {
+                size_t idx = temp_idx(arg_temp(op->args[i]));
+
+                lr->refs[lr->ref_end[idx]++] = (pos << 1) | (i < nb_oargs);
+            }
+        }
+        if (op->opc == INDEX_op_call) {
+            int flags = op->args[nb_oargs + nb_iargs + 1];
+            bool save = !(flags & (TCG_CALL_NO_READ_GLOBALS |
+                                   TCG_CALL_NO_WRITE_GLOBALS));
+
+            lr->calls[lr->nb_calls++] = (pos << 1) | save;
+        }
+        pos++;
+    }
+
+    lr->pos = 0;
+    lr->call_next = 0;
+    s->live_ranges = lr;
+}
+
+/* Return the next reference to @ts after the current op, or LR_NONE.  */
+static int tcg_next_ref(TCGContext *s, TCGTemp *ts)
+{
+    TCGLiveRanges *lr = s->live_ranges;
+    size_t idx = temp_idx(ts);
+    int i = lr->ref_next[idx];
+
+    while (i < lr->ref_end[idx] && (lr->refs[i] >> 1) <= lr->pos) {
+        i++;
+    }
+    lr->ref_next[idx] = i;
+    return i < lr->ref_end[idx] ? lr->refs[i] : LR_NONE;
+}
+
+/* Return the next call after the current op, or LR_NONE.  */
+static int tcg_next_call(TCGContext *s)
+{
+    TCGLiveRanges *lr = s->live_ranges;
+
+    while (lr->call_next < lr->nb_calls &&
+           (lr->calls[lr->call_next] >> 1) <= lr->pos) {
+        lr->call_next++;
+    }
+    return lr->call_next < lr->nb_calls ? lr->calls[lr->call_next] : LR_NONE;
+}
+
+/*
+ * Registers in which to prefer keeping @ts: callee-saved ones if its
+ * value is read again after a call that leaves it in a register,
+ * call-clobbered ones otherwise, to keep the callee-saved ones free.
+ */
+static TCGRegSet tcg_reg_pref(TCGContext *s, TCGTemp *ts)
+{
+    int next = tcg_next_ref(s, ts);
+    int call = tcg_next_call(s);
+
+    if (next != LR_NONE && !(next & 1) && (call >> 1) < (next >> 1) &&
+        !(ts->temp_global && (call & 1))) {
+        return ~tcg_target_call_clobber_regs;
+    }
+    return tcg_target_call_clobber_regs;
+}
+
+/*
+ * Cost of evicting @ts, whose next reference is @next: one store if
+ * memory is not up to date, and one load if the value is read again.
+ */
+static int tcg_spill_cost(TCGTemp *ts, int next)
+{
+    int cost = 0;
+
+    if (!ts->mem_coherent) {
+        cost++;
+    }
+    if (next != LR_NONE && !(next & 1)) {
+        cost++;
+    }
+    return cost;
+}
+
 /* Allocate a register belonging to reg1 & ~reg2 */
 static TCGReg tcg_reg_alloc(TCGContext *s, TCGRegSet desired_regs,
-                            TCGRegSet allocated_regs, bool rev)
+                            TCGRegSet allocated_regs, TCGTemp *ts)
 {
     int i, n = ARRAY_SIZE(tcg_target_reg_alloc_order);
     const int *order;
     TCGReg reg;
-    TCGRegSet reg_ct;
+    TCGRegSet reg_ct, pref_ct;
+    int best_reg, best_cost, best_next;
+#ifdef CONFIG_PROFILER
+    TCGProfile *prof = &s->prof;
+#endif
 
     reg_ct = desired_regs & ~allocated_regs;
-    order = rev ? indirect_reg_alloc_order : tcg_target_reg_alloc_order;
+    order = ts->indirect_base ? indirect_reg_alloc_order
+                              : tcg_target_reg_alloc_order;
+
+    if (!s->live_ranges) {
+        /* first try free registers */
+        for (i = 0; i < n; i++) {
+            reg = order[i];
+            if (tcg_regset_test_reg(reg_ct, reg) &&
+                s->reg_to_temp[reg] == NULL) {
+                return reg;
+            }
+        }
 
-    /* first try free registers */
-    for(i = 0; i < n; i++) {
+        for (i = 0; i < n; i++) {
+            reg = order[i];
+            if (tcg_regset_test_reg(reg_ct, reg)) {
+                goto evict;
+            }
+        }
+        tcg_abort();
+    }
+
+    /* first try free registers, in the preferred class if possible */
+    pref_ct = reg_ct & tcg_reg_pref(s, ts);
+    for (i = 0; i < n; i++) {
         reg = order[i];
-        if (tcg_regset_test_reg(reg_ct, reg) && s->reg_to_temp[reg] == NULL)
+        if (tcg_regset_test_reg(pref_ct, reg) && s->reg_to_temp[reg] == NULL) {
             return reg;
+        }
     }
-
-    /* XXX: do better spill choice */
-    for(i = 0; i < n; i++) {
+    for (i = 0; i < n; i++) {
         reg = order[i];
-        if (tcg_regset_test_reg(reg_ct, reg)) {
-            tcg_reg_free(s, reg, allocated_regs);
+        if (tcg_regset_test_reg(reg_ct, reg) && s->reg_to_temp[reg] == NULL) {
             return reg;
         }
     }
 
-    tcg_abort();
+    /* evict the cheapest temp, and among those the one used last */
+    best_reg = -1;
+    best_cost = INT_MAX;
+    best_next = 0;
+    for (i = 0; i < n; i++) {
+        int cost, next;
+
+        reg = order[i];
+        if (!tcg_regset_test_reg(reg_ct, reg)) {
+            continue;
+        }
+        next = tcg_next_ref(s, s->reg_to_temp[reg]);
+        cost = tcg_spill_cost(s->reg_to_temp[reg], next);
+        if (cost < best_cost || (cost == best_cost && next > best_next)) {
+            best_reg = reg;
+            best_cost = cost;
+            best_next = next;
+        }
+    }
+    if (best_reg < 0) {
+        tcg_abort();
+    }
+    reg = best_reg;
+
+ evict:
+#ifdef CONFIG_PROFILER
+    atomic_set(&prof->reg_evict_count, prof->reg_evict_count + 1);
+    if (!s->reg_to_temp[reg]->mem_coherent) {
+        atomic_set(&prof->reg_spill_count, prof->reg_spill_count + 1);
+    }
+#endif
+    tcg_reg_free(s, reg, allocated_regs);
+    return reg;
 }
 
 /* Make sure the temporary is in a register.  If needed, allocate the register
@@ -2659,14 +2897,17 @@ static void temp_load(TCGContext *s, TCGTemp *ts, TCGRegSet desired_regs,
     case TEMP_VAL_REG:
         return;
     case TEMP_VAL_CONST:
-        reg = tcg_reg_alloc(s, desired_regs, allocated_regs, ts->indirect_base);
+        reg = tcg_reg_alloc(s, desired_regs, allocated_regs, ts);
         tcg_out_movi(s, ts->type, reg, ts->val);
         ts->mem_coherent = 0;
         break;
     case TEMP_VAL_MEM:
-        reg = tcg_reg_alloc(s, desired_regs, allocated_regs, ts->indirect_base);
+        reg = tcg_reg_alloc(s, desired_regs, allocated_regs, ts);
         tcg_out_ld(s, ts->type, reg, ts->mem_base->reg, ts->mem_offset);
         ts->mem_coherent = 1;
+#ifdef CONFIG_PROFILER
+        atomic_set(&s->prof.reg_load_count, s->prof.reg_load_count + 1);
+#endif
         break;
     case TEMP_VAL_DEAD:
     default:
@@ -2824,7 +3065,7 @@ static void tcg_reg_alloc_mov(TCGContext *s, const TCGOp *op)
                    input one. */
                 tcg_regset_set_reg(allocated_regs, ts->reg);
                 ots->reg = tcg_reg_alloc(s, tcg_target_available_regs[otype],
-                                         allocated_regs, ots->indirect_base);
+                                         allocated_regs, ots);
             }
             tcg_out_mov(s, otype, ots->reg, ts->reg);
         }
@@ -2911,8 +3152,7 @@ static void tcg_reg_alloc_op(TCGContext *s, const TCGOp *op)
         allocate_in_reg:
             /* allocate a new register matching the constraint 
                and move the temporary register into it */
-            reg = tcg_reg_alloc(s, arg_ct->u.regs, i_allocated_regs,
-                                ts->indirect_base);
+            reg = tcg_reg_alloc(s, arg_ct->u.regs, i_allocated_regs, ts);
             tcg_out_mov(s, ts->type, reg, ts->reg);
         }
         new_args[i] = reg;
@@ -2956,8 +3196,7 @@ static void tcg_reg_alloc_op(TCGContext *s, const TCGOp *op)
                 reg = new_args[arg_ct->alias_index];
             } else if (arg_ct->ct & TCG_CT_NEWREG) {
                 reg = tcg_reg_alloc(s, arg_ct->u.regs,
-                                    i_allocated_regs | o_allocated_regs,
-                                    ts->indirect_base);
+                                    i_allocated_regs | o_allocated_regs, ts);
             } else {
                 /* if fixed register, we try to use it */
                 reg = ts->reg;
@@ -2965,8 +3204,7 @@ static void tcg_reg_alloc_op(TCGContext *s, const TCGOp *op)
                     tcg_regset_test_reg(arg_ct->u.regs, reg)) {
                     goto oarg_end;
                 }
-                reg = tcg_reg_alloc(s, arg_ct->u.regs, o_allocated_regs,
-                                    ts->indirect_base);
+                reg = tcg_reg_alloc(s, arg_ct->u.regs, o_allocated_regs, ts);
             }
             tcg_regset_set_reg(o_allocated_regs, reg);
             /* if a fixed register is used, then a move will be done afterwards */
@@ -3188,6 +3426,9 @@ void tcg_profile_snapshot(TCGProfile *prof, bool counters, bool table)
             PROF_ADD(prof, orig, opt_time);
             PROF_ADD(prof, orig, restore_count);
             PROF_ADD(prof, orig, restore_time);
+            PROF_ADD(prof, orig, reg_evict_count);
+            PROF_ADD(prof, orig, reg_spill_count);
+            PROF_ADD(prof, orig, reg_load_count);
         }
         if (table) {
             int i;
@@ -3236,7 +3477,7 @@ int tcg_gen_code(TCGContext *s, TranslationBlock *tb)
 #ifdef CONFIG_PROFILER
     TCGProfile *prof = &s->prof;
 #endif
-    int i, num_insns;
+    int i, num_insns, pos = 0;
     TCGOp *op;
 
 #ifdef CONFIG_PROFILER
@@ -3303,6 +3544,11 @@ int tcg_gen_code(TCGContext *s, TranslationBlock *tb)
         }
     }
 
+    s->live_ranges = NULL;
+    if (tcg_regalloc_mode == TCG_REGALLOC_SPILL_COST) {
+        tcg_live_ranges_init(s);
+    }
+
 #ifdef CONFIG_PROFILER
     atomic_set(&prof->la_time, prof->la_time + profile_getclock());
 #endif
@@ -3334,6 +3580,10 @@ int tcg_gen_code(TCGContext *s, TranslationBlock *tb)
     QTAILQ_FOREACH(op, &s->ops, link) {
         TCGOpcode opc = op->opc;
 
+        if (s->live_ranges) {
+            s->live_ranges->pos = pos++;
+        }
+
 #ifdef CONFIG_PROFILER
         atomic_set(&prof->table_op_count[opc], prof->table_op_count[opc] + 1);
 #endif
@@ -3446,6 +3696,14 @@ void tcg_dump_info(FILE *f, fprintf_function cpu_fprintf)
                 (double)s->code_out_len / tb_div_count);
     cpu_fprintf(f, "avg search data/TB  %0.1f\n",
                 (double)s->search_out_len / tb_div_count);
+    cpu_fprintf(f, "register allocator  %s\n",
+                tcg_regalloc_mode == TCG_REGALLOC_SPILL_COST ?
+                "spill-cost" : "greedy");
+    cpu_fprintf(f, "avg evictions/TB    %0.2f (%0.2f with a store)\n",
+                (double)s->reg_evict_count / tb_div_count,
+                (double)s->reg_spill_count / tb_div_count);
+    cpu_fprintf(f, "avg reg loads/TB    %0.2f\n",
+                (double)s->reg_load_count / tb_div_count);
     
     cpu_fprintf(f, "cycles/op           %0.1f\n", 
                 s->op_count ? (double)tot / s->op_count : 0);
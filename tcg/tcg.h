@@ -131,6 +131,7 @@ typedef uint64_t TCGRegSet;
 #define TCG_TARGET_HAS_muls2_i64        0
 #define TCG_TARGET_HAS_muluh_i64        0
 #define TCG_TARGET_HAS_mulsh_i64        0
+#define TCG_TARGET_HAS_cmpxchg2_i64     0
 /* Turn some undef macros into true macros.  */
 #define TCG_TARGET_HAS_add2_i32         1
 #define TCG_TARGET_HAS_sub2_i32         1
@@ -645,9 +646,21 @@ typedef struct TCGProfile {
     int64_t opt_time;
     int64_t restore_count;
     int64_t restore_time;
+    int64_t reg_evict_count; /* registers taken from a live temp */
+    int64_t reg_spill_count; /* evictions that stored the temp */
+    int64_t reg_load_count;  /* temps loaded from memory */
     int64_t table_op_count[NB_OPS];
 } TCGProfile;
 
+typedef enum TCGRegAllocMode {
+    /* Take the first free register; evict the first one otherwise.  */
+    TCG_REGALLOC_GREEDY,
+    /* Use the live ranges of the TB to pick and evict registers.  */
+    TCG_REGALLOC_SPILL_COST,
+} TCGRegAllocMode;
+
+extern TCGRegAllocMode tcg_regalloc_mode;
+
 struct TCGContext {
     uint8_t *pool_cur, *pool_end;
     TCGPool *pool_first, *pool_current, *pool_first_large;
@@ -664,6 +677,7 @@ struct TCGContext {
 
     TCGRegSet reserved_regs;
     uint32_t tb_cflags; /* cflags of the current TB */
+    bool tb_nopersist; /* current TB embeds a non-image host pointer */
     intptr_t current_frame_offset;
     intptr_t frame_start;
     intptr_t frame_end;
@@ -716,6 +730,9 @@ struct TCGContext {
        It does not take into account fixed registers */
     TCGTemp *reg_to_temp[TCG_TARGET_NB_REGS];
 
+    /* Live ranges for TCG_REGALLOC_SPILL_COST, NULL otherwise */
+    struct TCGLiveRanges *live_ranges;
+
     uint16_t gen_insn_end_off[TCG_MAX_INSNS];
     target_ulong gen_insn_data[TCG_MAX_INSNS][TARGET_INSN_START_WORDS];
 };
@@ -999,11 +1016,23 @@ do {\
     abort();\
 } while (0)
 
+/* Host pointers embedded in generated code.  Translated code may outlive
+   the process in user mode (see tb-cache.c), so pointers to anything but
+   the QEMU image itself make the current TB unsuitable for persisting.  */
+#ifdef CONFIG_USER_ONLY
+intptr_t tcg_ptr_value(const void *p);
+#else
+static inline intptr_t tcg_ptr_value(const void *p)
+{
+    return (intptr_t)p;
+}
+#endif
+
 #if UINTPTR_MAX == UINT32_MAX
 static inline TCGv_ptr TCGV_NAT_TO_PTR(TCGv_i32 n) { return (TCGv_ptr)n; }
 static inline TCGv_i32 TCGV_PTR_TO_NAT(TCGv_ptr n) { return (TCGv_i32)n; }
 
-#define tcg_const_ptr(V) TCGV_NAT_TO_PTR(tcg_const_i32((intptr_t)(V)))
+#define tcg_const_ptr(V) TCGV_NAT_TO_PTR(tcg_const_i32(tcg_ptr_value(V)))
 #define tcg_global_mem_new_ptr(R, O, N) \
     TCGV_NAT_TO_PTR(tcg_global_mem_new_i32((R), (O), (N)))
 #define tcg_temp_new_ptr() TCGV_NAT_TO_PTR(tcg_temp_new_i32())
@@ -1012,7 +1041,7 @@ static inline TCGv_i32 TCGV_PTR_TO_NAT(TCGv_ptr n) { return (TCGv_i32)n; }
 static inline TCGv_ptr TCGV_NAT_TO_PTR(TCGv_i64 n) { return (TCGv_ptr)n; }
 static inline TCGv_i64 TCGV_PTR_TO_NAT(TCGv_ptr n) { return (TCGv_i64)n; }
 
-#define tcg_const_ptr(V) TCGV_NAT_TO_PTR(tcg_const_i64((intptr_t)(V)))
+#define tcg_const_ptr(V) TCGV_NAT_TO_PTR(tcg_const_i64(tcg_ptr_value(V)))
 #define tcg_global_mem_new_ptr(R, O, N) \
     TCGV_NAT_TO_PTR(tcg_global_mem_new_i64((R), (O), (N)))
 #define tcg_temp_new_ptr() TCGV_NAT_TO_PTR(tcg_temp_new_i64())
@@ -0,0 +1,219 @@
+/*
+ * fp-bench.c - A collection of simple floating point microbenchmarks.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qemu/timer.h"
+#include "fpu/softfloat.h"
+
+enum op {
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_SQRT,
+};
+
+static const char * const op_names[] = {
+    [OP_ADD] = "add",
+    [OP_SUB] = "sub",
+    [OP_MUL] = "mul",
+    [OP_DIV] = "div",
+    [OP_SQRT] = "sqrt",
+};
+
+#define N_INPUTS 1024
+#define OPS_PER_ITER 64
+
+static enum op op = OP_ADD;
+static bool use_double;
+static bool force_soft;
+static unsigned int duration = 1;
+static uint64_t n_ops;
+static float32 f32_in[N_INPUTS];
+static float64 f64_in[N_INPUTS];
+
+static const char commands_string[] =
+    " -o = floating point operation (add, sub, mul, div, sqrt). Default: add\n"
+    " -p = precision (single, double). Default: single\n"
+    " -d = duration in seconds. Default: 1\n"
+    " -s = clear the inexact flag before each operation, which forces\n"
+    "      the softfloat slow path";
+
+static void usage_complete(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [options]\n", argv[0]);
+    fprintf(stderr, "options:\n%s\n", commands_string);
+}
+
+/*
+ * From: https://en.wikipedia.org/wiki/Xorshift
+ * This is faster than rand_r(), and gives us a wider range (RAND_MAX is only
+ * guaranteed to be >= INT_MAX).
+ */
+static uint64_t xorshift64star(uint64_t x)
+{
+    x ^= x >> 12; /* a */
+    x ^= x << 25; /* b */
+    x ^= x >> 27; /* c */
+    return x * UINT64_C(2685821657736338717);
+}
+
+/*
+ * Fill the inputs with positive normal numbers of moderate magnitude, so
+ * that no operation overflows, underflows or takes a square root of a
+ * negative number: the point is to measure the common case.
+ */
+static void init_inputs(void)
+{
+    uint64_t r = 1;
+    int i;
+
+    for (i = 0; i < N_INPUTS; i++) {
+        r = xorshift64star(r);
+        f32_in[i] = make_float32((127U << 23) | (r & 0x7fffff));
+        f64_in[i] = make_float64((1023ULL << 52) | (r & 0xfffffffffffffULL));
+    }
+}
+
+static float32 f32_op(float32 a, float32 b, float_status *s)
+{
+    switch (op) {
+    case OP_ADD:
+        return float32_add(a, b, s);
+    case OP_SUB:
+        return float32_sub(a, b, s);
+    case OP_MUL:
+        return float32_mul(a, b, s);
+    case OP_DIV:
+        return float32_div(a, b, s);
+    case OP_SQRT:
+        return float32_sqrt(a, s);
+    }
+    g_assert_not_reached();
+}
+
+static float64 f64_op(float64 a, float64 b, float_status *s)
+{
+    switch (op) {
+    case OP_ADD:
+        return float64_add(a, b, s);
+    case OP_SUB:
+        return float64_sub(a, b, s);
+    case OP_MUL:
+        return float64_mul(a, b, s);
+    case OP_DIV:
+        return float64_div(a, b, s);
+    case OP_SQRT:
+        return float64_sqrt(a, s);
+    }
+    g_assert_not_reached();
+}
+
+static void run_bench(void)
+{
+    float_status status = { 0 };
+    int64_t deadline = get_clock() + duration * NANOSECONDS_PER_SECOND;
+    unsigned int idx = 0;
+    volatile uint64_t sink;
+
+    set_float_rounding_mode(float_round_nearest_even, &status);
+    do {
+        int i;
+
+        for (i = 0; i < OPS_PER_ITER; i++) {
+            unsigned int j = (idx + 1) & (N_INPUTS - 1);
+
+            if (force_soft) {
+                status.float_exception_flags = 0;
+            } else {
+                status.float_exception_flags = float_flag_inexact;
+            }
+            if (use_double) {
+                sink = float64_val(f64_op(f64_in[idx], f64_in[j], &status));
+            } else {
+                sink = float32_val(f32_op(f32_in[idx], f32_in[j], &status));
+            }
+            idx = j;
+        }
+        n_ops += OPS_PER_ITER;
+    } while (get_clock() < deadline);
+    (void)sink;
+}
+
+static void pr_params(void)
+{
+    printf("Parameters:\n");
+    printf(" operation:         %s\n", op_names[op]);
+    printf(" precision:         %s\n", use_double ? "double" : "single");
+    printf(" path:              %s\n", force_soft ? "soft" : "default");
+    printf(" duration:          %u\n", duration);
+}
+
+static void pr_stats(void)
+{
+    printf("Results:\n");
+    printf(" Throughput:         %.2f MFlops\n",
+           (double)n_ops / duration / 1e6);
+}
+
+static void parse_args(int argc, char *argv[])
+{
+    int c;
+    int i;
+
+    for (;;) {
+        c = getopt(argc, argv, "hd:o:p:s");
+        if (c < 0) {
+            break;
+        }
+        switch (c) {
+        case 'h':
+            usage_complete(argv);
+            exit(0);
+        case 'd':
+            duration = atoi(optarg);
+            break;
+        case 'o':
+            for (i = 0; i < ARRAY_SIZE(op_names); i++) {
+                if (!strcmp(optarg, op_names[i])) {
+                    op = i;
+                    break;
+                }
+            }
+            if (i == ARRAY_SIZE(op_names)) {
+                fprintf(stderr, "Unsupported operation '%s'\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'p':
+            if (!strcmp(optarg, "single")) {
+                use_double = false;
+            } else if (!strcmp(optarg, "double")) {
+                use_double = true;
+            } else {
+                fprintf(stderr, "Unsupported precision '%s'\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 's':
+            force_soft = true;
+            break;
+        default:
+            usage_complete(argv);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    parse_args(argc, argv);
+    pr_params();
+    init_inputs();
+    run_bench();
+    pr_stats();
+    return 0;
+}
@@ -278,6 +278,95 @@ static void test_i440fx_pam(gconstpointer opaque)
     qtest_end();
 }
 
+#define I440FX_SMRAM    0x72
+#define SMRAM_D_OPEN    0x40
+#define SMRAM_G_SMRAME  0x08
+
+/* Each change below makes memory_region_transaction_commit update the
+ * FlatViews incrementally, and the guest must see the result.
+ */
+static void test_i440fx_smram(gconstpointer opaque)
+{
+    const TestData *s = opaque;
+    QPCIBus *bus;
+    QPCIDevice *dev;
+    uint8_t smram;
+    int i;
+
+    bus = test_start_get_bus(s);
+    dev = qpci_device_find(bus, QPCI_DEVFN(0, 0));
+    g_assert(dev != NULL);
+
+    smram = qpci_config_readb(dev, I440FX_SMRAM);
+
+    /* With SMRAM open, the RAM below the VGA window is visible */
+    qpci_config_writeb(dev, I440FX_SMRAM, smram | SMRAM_D_OPEN);
+    write_area(0xA0000, 0xBFFFF, 0x5a);
+    g_assert(verify_area(0xA0000, 0xBFFFF, 0x5a));
+
+    for (i = 0; i < 4; i++) {
+        /* Closed, the window shows VGA memory again */
+        qpci_config_writeb(dev, I440FX_SMRAM, smram);
+        g_assert(!verify_area(0xA0000, 0xBFFFF, 0x5a));
+
+        qpci_config_writeb(dev, I440FX_SMRAM,
+                           smram | SMRAM_D_OPEN | SMRAM_G_SMRAME);
+        g_assert(verify_area(0xA0000, 0xBFFFF, 0x5a));
+
+        qpci_config_writeb(dev, I440FX_SMRAM, smram | SMRAM_G_SMRAME);
+        g_assert(!verify_area(0xA0000, 0xBFFFF, 0x5a));
+
+        qpci_config_writeb(dev, I440FX_SMRAM, smram | SMRAM_D_OPEN);
+        g_assert(verify_area(0xA0000, 0xBFFFF, 0x5a));
+    }
+
+    qpci_config_writeb(dev, I440FX_SMRAM, smram);
+    g_free(dev);
+    qpci_free_pc(bus);
+    qtest_end();
+}
+
+/* Offset of the name in the header that pci-testdev shows in BAR 0 */
+#define PCI_TESTDEV_NAME 16
+
+static void test_i440fx_bar_remap(gconstpointer opaque)
+{
+    QPCIBus *bus;
+    QPCIDevice *dev;
+    uint64_t bar, old_bar = 0;
+    int i;
+
+    qtest_start("-nodefaults -device pci-testdev,addr=04.0");
+    bus = qpci_init_pc(global_qtest, NULL);
+    dev = qpci_device_find(bus, QPCI_DEVFN(4, 0));
+    g_assert(dev != NULL);
+
+    for (i = 0; i < 16; i++) {
+        /* Move BAR 0 around, sometimes with decoding disabled */
+        bar = 0xE0000000 + (i % 5) * 0x100000 + (i % 3) * 0x1000;
+        if (i & 1) {
+            qpci_config_writew(dev, PCI_COMMAND, 0);
+        }
+        qpci_config_writel(dev, PCI_BASE_ADDRESS_0, bar);
+        qpci_config_writew(dev, PCI_COMMAND, PCI_COMMAND_MEMORY);
+
+        /* Select the first test, then read back its name */
+        writeb(bar, 0);
+        g_assert_cmpint(readb(bar + PCI_TESTDEV_NAME), ==, 'm');
+        if (old_bar && old_bar != bar) {
+            g_assert_cmpint(readb(old_bar + PCI_TESTDEV_NAME), ==, 0);
+        }
+        old_bar = bar;
+    }
+
+    qpci_config_writew(dev, PCI_COMMAND, 0);
+    g_assert_cmpint(readb(old_bar + PCI_TESTDEV_NAME), ==, 0);
+
+    g_free(dev);
+    qpci_free_pc(bus);
+    qtest_end();
+}
+
 #define BLOB_SIZE ((size_t)65536)
 #define ISA_BIOS_MAXSZ ((size_t)(128 * 1024))
 
@@ -406,6 +495,8 @@ int main(int argc, char **argv)
 
     qtest_add_data_func("i440fx/defaults", &data, test_i440fx_defaults);
     qtest_add_data_func("i440fx/pam", &data, test_i440fx_pam);
+    qtest_add_data_func("i440fx/smram", &data, test_i440fx_smram);
+    qtest_add_data_func("i440fx/bar-remap", &data, test_i440fx_bar_remap);
     add_firmware_test("i440fx/firmware/bios", request_bios);
     add_firmware_test("i440fx/firmware/pflash", request_pflash);
 
@@ -0,0 +1,135 @@
+/*
+ * memop-bench.c - x86_64 guest memory access microbenchmark.
+ *
+ * Measures the throughput of 8-byte and 16-byte loads and stores, and of
+ * LOCK CMPXCHG16B, over a small buffer that stays in the host cache.  Run
+ * it natively and under qemu-x86_64 to compare.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum op {
+    OP_LD64,
+    OP_ST64,
+    OP_LD128,
+    OP_ST128,
+    OP_CMPXCHG128,
+    OP_NR,
+};
+
+static const char * const op_names[] = {
+    [OP_LD64] = "ld64",
+    [OP_ST64] = "st64",
+    [OP_LD128] = "ld128",
+    [OP_ST128] = "st128",
+    [OP_CMPXCHG128] = "cmpxchg128",
+};
+
+#define BUF_SIZE 4096
+#define OPS_PER_ITER 256
+
+static uint64_t buf[BUF_SIZE / 8] __attribute__((aligned(64)));
+static unsigned int duration = 1;
+
+static uint64_t get_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void do_ops(enum op op)
+{
+    uint64_t *p = buf;
+    unsigned int i;
+
+    for (i = 0; i < OPS_PER_ITER; i++) {
+        switch (op) {
+        case OP_LD64:
+            asm volatile("mov (%0), %%rax" : : "r"(p) : "rax", "memory");
+            break;
+        case OP_ST64:
+            asm volatile("mov %%rax, (%0)" : : "r"(p) : "memory");
+            break;
+        case OP_LD128:
+            asm volatile("movdqu (%0), %%xmm0" : : "r"(p) : "xmm0", "memory");
+            break;
+        case OP_ST128:
+            asm volatile("movdqu %%xmm0, (%0)" : : "r"(p) : "memory");
+            break;
+        case OP_CMPXCHG128:
+            asm volatile("lock cmpxchg16b (%0)"
+                         : : "r"(p), "a"(0), "d"(0), "b"(1), "c"(1)
+                         : "cc", "memory");
+            break;
+        default:
+            abort();
+        }
+        p += 2;
+        if (p == buf + BUF_SIZE / 8) {
+            p = buf;
+        }
+    }
+}
+
+static void run_bench(enum op op)
+{
+    uint64_t start = get_ns();
+    uint64_t deadline = start + duration * 1000000000ULL;
+    uint64_t n_ops = 0;
+    uint64_t now;
+
+    do {
+        do_ops(op);
+        n_ops += OPS_PER_ITER;
+        now = get_ns();
+    } while (now < deadline);
+
+    printf(" %-12s %10.2f Mops/s\n", op_names[op],
+           (double)n_ops * 1e3 / (now - start));
+}
+
+int main(int argc, char *argv[])
+{
+    int only = -1;
+    int c, i;
+
+    while ((c = getopt(argc, argv, "hd:o:")) != -1) {
+        switch (c) {
+        case 'd':
+            duration = atoi(optarg);
+            break;
+        case 'o':
+            for (i = 0; i < OP_NR; i++) {
+                if (!strcmp(optarg, op_names[i])) {
+                    only = i;
+                    break;
+                }
+            }
+            if (i == OP_NR) {
+                fprintf(stderr, "Unsupported operation '%s'\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d seconds] [-o operation]\n",
+                    argv[0]);
+            return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    for (i = 0; i < OP_NR; i++) {
+        if (only < 0 || only == i) {
+            run_bench(i);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -317,6 +317,77 @@ static void test_bh_flush(void)
     qemu_bh_delete(data.bh);
 }
 
+typedef struct {
+    QEMUBH *bh;
+    int id;
+    int *order;
+    int *n;
+} BHOrderTestData;
+
+static void bh_order_cb(void *opaque)
+{
+    BHOrderTestData *data = opaque;
+    data->order[(*data->n)++] = data->id;
+}
+
+static void test_bh_fifo(void)
+{
+    BHOrderTestData data[8];
+    int order[ARRAY_SIZE(data)];
+    int i, n = 0;
+
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        data[i] = (BHOrderTestData) { .id = i, .order = order, .n = &n };
+        data[i].bh = aio_bh_new(ctx, bh_order_cb, &data[i]);
+    }
+
+    /* Schedule in an order unrelated to creation order.  */
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        qemu_bh_schedule(data[(i * 3) % ARRAY_SIZE(data)].bh);
+    }
+    /* Scheduling twice does not change the position in the queue.  */
+    qemu_bh_schedule(data[0].bh);
+
+    g_assert(aio_poll(ctx, false));
+    g_assert_cmpint(n, ==, ARRAY_SIZE(data));
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        g_assert_cmpint(order[i], ==, (i * 3) % ARRAY_SIZE(data));
+        qemu_bh_delete(data[i].bh);
+    }
+    g_assert(!aio_poll(ctx, false));
+}
+
+static void test_bh_schedule_many_idle(void)
+{
+    BHTestData data = { .n = 0, .max = INT_MAX };
+    QEMUBH *idle[10000];
+    double elapsed;
+    int i;
+
+    /* Idle bottom halves should not slow down the ones that are scheduled.  */
+    for (i = 0; i < ARRAY_SIZE(idle); i++) {
+        idle[i] = aio_bh_new(ctx, bh_test_cb, NULL);
+    }
+    data.bh = aio_bh_new(ctx, bh_test_cb, &data);
+
+    qemu_bh_schedule(data.bh);
+    g_test_timer_start();
+    do {
+        for (i = 0; i < 1000; i++) {
+            aio_poll(ctx, false);
+        }
+    } while (g_test_timer_elapsed() < 1.0);
+    elapsed = g_test_timer_last();
+    g_print("%d bottom halves in %.2f secs with %d idle: %.2f Mbh/sec\n",
+            data.n, elapsed, (int)ARRAY_SIZE(idle), data.n / elapsed / 1e6);
+
+    qemu_bh_delete(data.bh);
+    for (i = 0; i < ARRAY_SIZE(idle); i++) {
+        qemu_bh_delete(idle[i]);
+    }
+    aio_poll(ctx, false);
+}
+
 static void test_set_event_notifier(void)
 {
     EventNotifierTestData data = { .n = 0, .active = 0 };
@@ -857,6 +928,11 @@ int main(int argc, char **argv)
     g_test_add_func("/aio/bh/callback-delete/one",  test_bh_delete_from_cb);
     g_test_add_func("/aio/bh/callback-delete/many", test_bh_delete_from_cb_many);
     g_test_add_func("/aio/bh/flush",                test_bh_flush);
+    g_test_add_func("/aio/bh/fifo",                 test_bh_fifo);
+    if (g_test_perf()) {
+        g_test_add_func("/aio/bh/schedule-many-idle",
+                        test_bh_schedule_many_idle);
+    }
     g_test_add_func("/aio/event/add-remove",        test_set_event_notifier);
     g_test_add_func("/aio/event/wait",              test_wait_event_notifier);
     g_test_add_func("/aio/event/wait/no-flush-cb",  test_wait_event_notifier_noflush);
@@ -135,6 +135,41 @@ static void test_submit_many(void)
     }
 }
 
+static void test_stats(void)
+{
+    WorkerTestData data[100];
+    ThreadPoolStats before, after;
+    int i;
+
+    /* Keep a few threads around even when idle, and cap the pool so that
+     * requests have to queue up behind each other.
+     */
+    aio_context_set_thread_pool_params(ctx, 2, 4, NULL, &error_abort);
+    thread_pool_get_stats(pool, &before);
+    g_assert_cmpint(before.min_threads, ==, 2);
+    g_assert_cmpint(before.max_threads, ==, 4);
+    g_assert_cmpint(before.threads, >=, 2);
+
+    for (i = 0; i < 100; i++) {
+        data[i].n = 0;
+        data[i].ret = -EINPROGRESS;
+        thread_pool_submit_aio(pool, worker_cb, &data[i], done_cb, &data[i]);
+    }
+
+    active = 100;
+    while (active > 0) {
+        aio_poll(ctx, true);
+    }
+
+    thread_pool_get_stats(pool, &after);
+    g_assert_cmpint(after.requests - before.requests, ==, 100);
+    g_assert_cmpint(after.queue_depth, ==, 0);
+    g_assert_cmpint(after.threads, >=, 2);
+    g_assert_cmpint(after.max_queue_depth, >=, 1);
+
+    aio_context_set_thread_pool_params(ctx, 0, 64, NULL, &error_abort);
+}
+
 static void do_test_cancel(bool sync)
 {
     WorkerTestData data[100];
@@ -235,6 +270,7 @@ int main(int argc, char **argv)
     g_test_add_func("/thread-pool/submit-aio", test_submit_aio);
     g_test_add_func("/thread-pool/submit-co", test_submit_co);
     g_test_add_func("/thread-pool/submit-many", test_submit_many);
+    g_test_add_func("/thread-pool/stats", test_stats);
     g_test_add_func("/thread-pool/cancel", test_cancel);
     g_test_add_func("/thread-pool/cancel-async", test_cancel_async);
 
@@ -0,0 +1,177 @@
+/*
+ * Timer list microbenchmark
+ *
+ * Arms and cancels timers at random on a single QEMUTimerList, then
+ * arms them all in the past and runs the list, checking that they
+ * fire in order.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qemu/timer.h"
+
+static QEMUTimer *timers;
+static int64_t *expire_times;
+static unsigned int n_timers = 1024;
+static unsigned long n_ops = 10000000;
+static unsigned int cancel_rate = 20;
+static uint64_t range = 1000000;
+
+static unsigned long n_fired;
+static int64_t last_fired;
+static bool out_of_order;
+
+static const char commands_string[] =
+    " -n = number of timers\n"
+    " -o = number of operations\n"
+    " -c = percentage of operations that cancel a timer\n"
+    " -r = range of the expiry times in ns";
+
+static void usage_complete(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [options]\n", argv[0]);
+    fprintf(stderr, "options:\n%s\n", commands_string);
+}
+
+/*
+ * From: https://en.wikipedia.org/wiki/Xorshift
+ * This is faster than rand_r(), and gives us a wider range (RAND_MAX is only
+ * guaranteed to be >= INT_MAX).
+ */
+static uint64_t xorshift64star(uint64_t x)
+{
+    x ^= x >> 12; /* a */
+    x ^= x << 25; /* b */
+    x ^= x >> 27; /* c */
+    return x * UINT64_C(2685821657736338717);
+}
+
+static void timer_nop_notify(void *opaque, QEMUClockType type)
+{
+}
+
+static void timer_fire_cb(void *opaque)
+{
+    QEMUTimer *ts = opaque;
+    int64_t expire = expire_times[ts - timers];
+
+    if (expire < last_fired) {
+        out_of_order = true;
+    }
+    last_fired = expire;
+    n_fired++;
+}
+
+static void pr_params(void)
+{
+    printf("Parameters:\n");
+    printf(" # of timers:       %u\n", n_timers);
+    printf(" # of operations:   %lu\n", n_ops);
+    printf(" cancel rate:       %u%%\n", cancel_rate);
+    printf(" expiry range:      %" PRIu64 " ns\n", range);
+}
+
+static void run_test(void)
+{
+    QEMUTimerList *tl;
+    uint64_t r = 1;
+    int64_t base, t0, t1, t2;
+    unsigned long i;
+
+    init_clocks(NULL);
+    tl = timerlist_new(QEMU_CLOCK_REALTIME, timer_nop_notify, NULL);
+
+    timers = g_new0(QEMUTimer, n_timers);
+    expire_times = g_new0(int64_t, n_timers);
+    for (i = 0; i < n_timers; i++) {
+        timer_init_tl(&timers[i], tl, SCALE_NS, timer_fire_cb, &timers[i]);
+    }
+
+    /* Keep the timers in the future, so that none of them fires.  */
+    base = qemu_clock_get_ns(QEMU_CLOCK_REALTIME)
+        + 3600 * NANOSECONDS_PER_SECOND;
+    t0 = get_clock();
+    for (i = 0; i < n_ops; i++) {
+        QEMUTimer *ts;
+
+        r = xorshift64star(r);
+        ts = &timers[(r >> 32) % n_timers];
+        if ((r & 0xffff) % 100 < cancel_rate) {
+            timer_del(ts);
+        } else {
+            timer_mod_ns(ts, base + (r >> 8) % range);
+        }
+    }
+    t1 = get_clock();
+
+    /* Now arm every timer in the past, and let them all fire.  */
+    for (i = 0; i < n_timers; i++) {
+        r = xorshift64star(r);
+        expire_times[i] = (r >> 8) % range;
+        timer_mod_ns(&timers[i], expire_times[i]);
+    }
+    timerlist_run_timers(tl);
+    t2 = get_clock();
+
+    for (i = 0; i < n_timers; i++) {
+        timer_deinit(&timers[i]);
+    }
+    timerlist_free(tl);
+    g_free(timers);
+    g_free(expire_times);
+
+    printf("Results:\n");
+    printf(" arm/cancel:        %.2f Mops/s\n",
+           n_ops * 1e3 / (t1 - t0));
+    printf(" arm and fire:      %.2f Mtimers/s\n",
+           n_timers * 1e3 / (t2 - t1));
+    if (n_fired != n_timers || out_of_order) {
+        fprintf(stderr, "error: %lu of %u timers fired%s\n", n_fired,
+                n_timers, out_of_order ? ", out of order" : "");
+        exit(1);
+    }
+}
+
+static void parse_args(int argc, char *argv[])
+{
+    int c;
+
+    for (;;) {
+        c = getopt(argc, argv, "hn:o:c:r:");
+        if (c < 0) {
+            break;
+        }
+        switch (c) {
+        case 'h':
+            usage_complete(argv);
+            exit(0);
+        case 'n':
+            n_timers = atoi(optarg);
+            break;
+        case 'o':
+            n_ops = atol(optarg);
+            break;
+        case 'c':
+            cancel_rate = MIN(atoi(optarg), 100);
+            break;
+        case 'r':
+            range = MAX(atoll(optarg), 1);
+            break;
+        default:
+            usage_complete(argv);
+            exit(1);
+        }
+    }
+    if (n_timers == 0) {
+        n_timers = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    parse_args(argc, argv);
+    pr_params();
+    run_test();
+    return 0;
+}
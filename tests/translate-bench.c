@@ -0,0 +1,127 @@
+/*
+ * Address space translation microbenchmark
+ *
+ * Starts QEMU under qtest and asks it to fill a range of MMIO (by
+ * default unassigned) guest physical memory.  Every access to such
+ * memory goes through flatview_translate, so once the cost of the
+ * qtest round trip is subtracted the result is the number of
+ * translations per second.  Run it with QTEST_QEMU_BINARY set, e.g.
+ *
+ *   QTEST_QEMU_BINARY=x86_64-softmmu/qemu-system-x86_64 tests/translate-bench
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+#include "qemu/osdep.h"
+#include "qemu/timer.h"
+#include "libqtest.h"
+
+static const char *extra_args = "-machine pc -nodefaults";
+static uint64_t addr = 0xe0000000;
+static size_t len = 16 * 1024 * 1024;
+static unsigned int access_size = 4;
+static unsigned int n_iters = 16;
+
+static const char commands_string[] =
+    " -m = QEMU command line arguments\n"
+    " -a = guest physical address of the range\n"
+    " -l = length of the range in bytes\n"
+    " -w = size of each access to the range (4 for unassigned memory)\n"
+    " -n = number of times the range is written";
+
+static void usage_complete(char *argv[])
+{
+    fprintf(stderr, "Usage: %s [options]\n", argv[0]);
+    fprintf(stderr, "options:\n%s\n", commands_string);
+}
+
+static void pr_params(void)
+{
+    printf("Parameters:\n");
+    printf(" arguments:         %s\n", extra_args);
+    printf(" address:           0x%" PRIx64 "\n", addr);
+    printf(" length:            %zu\n", len);
+    printf(" access size:       %u\n", access_size);
+    printf(" # of iterations:   %u\n", n_iters);
+}
+
+static int64_t time_memset(QTestState *s, size_t size)
+{
+    int64_t t0 = get_clock();
+    unsigned int i;
+
+    for (i = 0; i < n_iters; i++) {
+        qtest_memset(s, addr, 0, size);
+    }
+    return (get_clock() - t0) / n_iters;
+}
+
+static void run_test(void)
+{
+    QTestState *s;
+    int64_t t_small, t_big;
+    double n_accesses;
+
+    s = qtest_init(extra_args);
+
+    /* Warm up, then measure the fixed cost of a qtest command.  */
+    time_memset(s, access_size);
+    t_small = time_memset(s, access_size);
+    t_big = time_memset(s, len);
+
+    qtest_quit(s);
+
+    n_accesses = (double)(len - access_size) / access_size;
+    printf("Results:\n");
+    printf(" qtest round trip:  %.2f us\n", t_small / 1e3);
+    printf(" translations:      %.2f M/s\n",
+           n_accesses * 1e3 / MAX(t_big - t_small, 1));
+}
+
+static void parse_args(int argc, char *argv[])
+{
+    int c;
+
+    for (;;) {
+        c = getopt(argc, argv, "hm:a:l:w:n:");
+        if (c < 0) {
+            break;
+        }
+        switch (c) {
+        case 'h':
+            usage_complete(argv);
+            exit(0);
+        case 'm':
+            extra_args = optarg;
+            break;
+        case 'a':
+            addr = strtoull(optarg, NULL, 0);
+            break;
+        case 'l':
+            len = strtoull(optarg, NULL, 0);
+            break;
+        case 'w':
+            access_size = atoi(optarg);
+            break;
+        case 'n':
+            n_iters = atoi(optarg);
+            break;
+        default:
+            usage_complete(argv);
+            exit(1);
+        }
+    }
+    if (access_size == 0) {
+        access_size = 1;
+    }
+    len = MAX(len, 2 * access_size);
+    n_iters = MAX(n_iters, 1);
+}
+
+int main(int argc, char *argv[])
+{
+    parse_args(argc, argv);
+    pr_params();
+    run_test();
+    return 0;
+}
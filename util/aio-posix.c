@@ -36,6 +36,14 @@ struct AioHandler
     void *opaque;
     bool is_external;
     QLIST_ENTRY(AioHandler) node;
+
+    /* Adaptive polling state, see adjust_polling_time() */
+    bool poll_started;      /* io_poll_begin() has been called */
+    int64_t poll_ns;        /* polling window for this handler */
+    int64_t poll_ready_ns;  /* when io_poll() made progress, or 0 */
+    int64_t poll_event_ns;  /* moving average of the time to an event */
+    uint64_t poll_hits;     /* events detected by io_poll() */
+    uint64_t poll_misses;   /* polling windows that expired with no event */
 };
 
 #ifdef CONFIG_EPOLL_CREATE1
@@ -317,11 +325,14 @@ void aio_set_event_notifier_poll(AioContext *ctx,
                     (IOHandler *)io_poll_end);
 }
 
+/* Only handlers that have a polling window are switched to polling mode;
+ * the others keep being notified through their file descriptor.
+ */
 static void poll_set_started(AioContext *ctx, bool started)
 {
     AioHandler *node;
 
-    if (started == ctx->poll_started) {
+    if (!started && !ctx->poll_started) {
         return;
     }
 
@@ -330,12 +341,14 @@ static void poll_set_started(AioContext *ctx, bool started)
     qemu_lockcnt_inc(&ctx->list_lock);
     QLIST_FOREACH_RCU(node, &ctx->aio_handlers, node) {
         IOHandler *fn;
+        bool node_started = started && node->poll_ns;
 
-        if (node->deleted) {
+        if (node->deleted || node_started == node->poll_started) {
             continue;
         }
 
-        if (started) {
+        node->poll_started = node_started;
+        if (node_started) {
             fn = node->io_poll_begin;
         } else {
             fn = node->io_poll_end;
@@ -486,15 +499,31 @@ static void add_pollfd(AioHandler *node)
     npfd++;
 }
 
-static bool run_poll_handlers_once(AioContext *ctx)
+/* run_poll_handlers_once:
+ * @ctx: the AioContext
+ * @now: current time, recorded in handlers that make progress
+ * @elapsed_ns: time spent polling so far
+ *
+ * Polls the handlers whose polling window is at least @elapsed_ns, so
+ * that handlers that rarely complete quickly only cost one call per
+ * aio_poll().
+ *
+ * Returns: true if progress was made, false otherwise
+ */
+static bool run_poll_handlers_once(AioContext *ctx, int64_t now,
+                                   int64_t elapsed_ns)
 {
     bool progress = false;
     AioHandler *node;
 
     QLIST_FOREACH_RCU(node, &ctx->aio_handlers, node) {
         if (!node->deleted && node->io_poll &&
+            node->poll_ns >= elapsed_ns &&
             aio_node_check(ctx, node->is_external) &&
             node->io_poll(node->opaque)) {
+            if (!node->poll_ready_ns) {
+                node->poll_ready_ns = now;
+            }
             progress = true;
         }
 
@@ -520,7 +549,7 @@ static bool run_poll_handlers_once(AioContext *ctx)
 static bool run_poll_handlers(AioContext *ctx, int64_t max_ns)
 {
     bool progress;
-    int64_t end_time;
+    int64_t start_time, now;
 
     assert(ctx->notify_me);
     assert(qemu_lockcnt_count(&ctx->list_lock) > 0);
@@ -528,11 +557,20 @@ static bool run_poll_handlers(AioContext *ctx, int64_t max_ns)
 
     trace_run_poll_handlers_begin(ctx, max_ns);
 
-    end_time = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) + max_ns;
+    start_time = now = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
 
     do {
-        progress = run_poll_handlers_once(ctx);
-    } while (!progress && qemu_clock_get_ns(QEMU_CLOCK_REALTIME) < end_time);
+        progress = run_poll_handlers_once(ctx, now, now - start_time);
+        now = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
+    } while (!progress && now - start_time < max_ns);
+
+    if (progress) {
+        atomic_set__nocheck(&ctx->poll_hits, ctx->poll_hits + 1);
+    } else {
+        atomic_set__nocheck(&ctx->poll_misses, ctx->poll_misses + 1);
+    }
+    atomic_set__nocheck(&ctx->poll_time_ns,
+                        ctx->poll_time_ns + now - start_time);
 
     trace_run_poll_handlers_end(ctx, progress);
 
@@ -541,6 +579,7 @@ static bool run_poll_handlers(AioContext *ctx, int64_t max_ns)
 
 /* try_poll_mode:
  * @ctx: the AioContext
+ * @start: time at which aio_poll() started, or 0 if polling is disabled
  * @blocking: busy polling is only attempted when blocking is true
  *
  * ctx->notify_me must be non-zero so this function can detect aio_notify().
@@ -549,7 +588,7 @@ static bool run_poll_handlers(AioContext *ctx, int64_t max_ns)
  *
  * Returns: true if progress was made, false otherwise
  */
-static bool try_poll_mode(AioContext *ctx, bool blocking)
+static bool try_poll_mode(AioContext *ctx, int64_t start, bool blocking)
 {
     if (blocking && ctx->poll_max_ns && ctx->poll_disable_cnt == 0) {
         /* See qemu_soonest_timeout() uint64_t hack */
@@ -570,7 +609,106 @@ static bool try_poll_mode(AioContext *ctx, bool blocking)
     /* Even if we don't run busy polling, try polling once in case it can make
      * progress and the caller will be able to avoid ppoll(2)/epoll_wait(2).
      */
-    return run_poll_handlers_once(ctx);
+    return run_poll_handlers_once(ctx, start, 0);
+}
+
+/* Grow or shrink a polling window according to the time it took for an
+ * event to arrive, as configured by poll-max-ns, poll-grow and poll-shrink.
+ */
+static int64_t poll_window_adjust(AioContext *ctx, int64_t poll_ns,
+                                  int64_t block_ns)
+{
+    if (block_ns <= poll_ns) {
+        /* This is the sweet spot, no adjustment needed */
+    } else if (block_ns > ctx->poll_max_ns) {
+        /* We'd have to poll for too long, poll less */
+        if (ctx->poll_shrink) {
+            poll_ns /= ctx->poll_shrink;
+        } else {
+            poll_ns = 0;
+        }
+    } else if (poll_ns < ctx->poll_max_ns) {
+        /* There is room to grow, poll longer */
+        int64_t grow = ctx->poll_grow;
+
+        if (grow == 0) {
+            grow = 2;
+        }
+
+        if (poll_ns) {
+            poll_ns *= grow;
+        } else {
+            poll_ns = 4000; /* start polling at 4 microseconds */
+        }
+    }
+
+    return MIN(poll_ns, ctx->poll_max_ns);
+}
+
+/* adjust_polling_time:
+ * @ctx: the AioContext
+ * @start: time at which aio_poll() started
+ * @block_ns: time spent in polling and in ppoll(2)/epoll_wait(2)
+ *
+ * Each handler gets its own polling window, based on how long it took for
+ * its events to arrive.  A handler that had no event only has its window
+ * shrunk if it was being polled and nothing else ended the wait early, so
+ * that an idle device does not disable polling for a busy one.  The
+ * window of the AioContext is the largest of the handlers' windows.
+ *
+ * Note that the caller must have incremented ctx->list_lock.
+ */
+static void adjust_polling_time(AioContext *ctx, int64_t start,
+                                int64_t block_ns)
+{
+    AioHandler *node;
+    int64_t old = ctx->poll_ns;
+    int64_t poll_ns = 0;
+
+    QLIST_FOREACH_RCU(node, &ctx->aio_handlers, node) {
+        int64_t node_old = node->poll_ns;
+        int64_t event_ns;
+
+        if (node->deleted || !node->io_poll) {
+            continue;
+        }
+
+        if (node->poll_ready_ns) {
+            event_ns = node->poll_ready_ns - start;
+            node->poll_ready_ns = 0;
+            node->poll_hits++;
+        } else if (node->pfd.revents & node->pfd.events) {
+            event_ns = block_ns;
+        } else {
+            event_ns = -1;
+        }
+
+        if (event_ns >= 0) {
+            /* Exponential moving average with a weight of 1/8 */
+            node->poll_event_ns += (event_ns - node->poll_event_ns) / 8;
+            node->poll_ns = poll_window_adjust(ctx, node->poll_ns, event_ns);
+        } else if (node->poll_started && block_ns > ctx->poll_max_ns) {
+            node->poll_misses++;
+            node->poll_ns = poll_window_adjust(ctx, node->poll_ns, block_ns);
+        } else {
+            node->poll_ns = MIN(node->poll_ns, ctx->poll_max_ns);
+        }
+
+        if (node->poll_ns != node_old) {
+            trace_poll_handler_adjust(ctx, node, node->poll_hits,
+                                      node->poll_misses, node->poll_event_ns,
+                                      node_old, node->poll_ns);
+        }
+
+        poll_ns = MAX(poll_ns, node->poll_ns);
+    }
+
+    ctx->poll_ns = poll_ns;
+    if (poll_ns < old) {
+        trace_poll_shrink(ctx, old, poll_ns);
+    } else if (poll_ns > old) {
+        trace_poll_grow(ctx, old, poll_ns);
+    }
 }
 
 bool aio_poll(AioContext *ctx, bool blocking)
@@ -599,7 +737,7 @@ bool aio_poll(AioContext *ctx, bool blocking)
         start = qemu_clock_get_ns(QEMU_CLOCK_REALTIME);
     }
 
-    progress = try_poll_mode(ctx, blocking);
+    progress = try_poll_mode(ctx, start, blocking);
     if (!progress) {
         assert(npfd == 0);
 
@@ -634,47 +772,6 @@ bool aio_poll(AioContext *ctx, bool blocking)
         atomic_sub(&ctx->notify_me, 2);
     }
 
-    /* Adjust polling time */
-    if (ctx->poll_max_ns) {
-        int64_t block_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - start;
-
-        if (block_ns <= ctx->poll_ns) {
-            /* This is the sweet spot, no adjustment needed */
-        } else if (block_ns > ctx->poll_max_ns) {
-            /* We'd have to poll for too long, poll less */
-            int64_t old = ctx->poll_ns;
-
-            if (ctx->poll_shrink) {
-                ctx->poll_ns /= ctx->poll_shrink;
-            } else {
-                ctx->poll_ns = 0;
-            }
-
-            trace_poll_shrink(ctx, old, ctx->poll_ns);
-        } else if (ctx->poll_ns < ctx->poll_max_ns &&
-                   block_ns < ctx->poll_max_ns) {
-            /* There is room to grow, poll longer */
-            int64_t old = ctx->poll_ns;
-            int64_t grow = ctx->poll_grow;
-
-            if (grow == 0) {
-                grow = 2;
-            }
-
-            if (ctx->poll_ns) {
-                ctx->poll_ns *= grow;
-            } else {
-                ctx->poll_ns = 4000; /* start polling at 4 microseconds */
-            }
-
-            if (ctx->poll_ns > ctx->poll_max_ns) {
-                ctx->poll_ns = ctx->poll_max_ns;
-            }
-
-            trace_poll_grow(ctx, old, ctx->poll_ns);
-        }
-    }
-
     aio_notify_accept(ctx);
 
     /* if we have any readable fds, dispatch event */
@@ -686,6 +783,13 @@ bool aio_poll(AioContext *ctx, bool blocking)
 
     npfd = 0;
 
+    /* Adjust polling time */
+    if (ctx->poll_max_ns) {
+        int64_t block_ns = qemu_clock_get_ns(QEMU_CLOCK_REALTIME) - start;
+
+        adjust_polling_time(ctx, start, block_ns);
+    }
+
     progress |= aio_bh_poll(ctx);
 
     if (ret > 0) {
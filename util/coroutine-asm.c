@@ -0,0 +1,294 @@
+/*
+ * Host-specific assembly coroutine backend
+ *
+ * Copyright (C) 2006  Anthony Liguori <anthony@codemonkey.ws>
+ * Copyright (C) 2011  Kevin Wolf <kwolf@redhat.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu-common.h"
+#include "qemu/coroutine_int.h"
+
+#ifdef CONFIG_VALGRIND_H
+#include <valgrind/valgrind.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) || __has_feature(address_sanitizer)
+#ifdef CONFIG_ASAN_IFACE_FIBER
+#define CONFIG_ASAN 1
+#include <sanitizer/asan_interface.h>
+#endif
+#endif
+
+typedef struct {
+    Coroutine base;
+    void *sp;
+    void *stack;
+    size_t stack_size;
+
+#ifdef CONFIG_VALGRIND_H
+    unsigned int valgrind_stack_id;
+#endif
+
+} CoroutineAsm;
+
+/**
+ * Per-thread coroutine bookkeeping
+ */
+static __thread CoroutineAsm leader;
+static __thread Coroutine *current;
+
+/*
+ * coroutine_asm_switch saves the callee-saved registers of the host ABI
+ * on the current stack, stores the stack pointer in *from_sp, loads
+ * to_sp and restores the registers saved there, and returns action to
+ * whoever switched out of to_sp last.  Caller-saved registers are
+ * taken care of by the compiler, since this is a normal function call.
+ * The floating-point control registers are not saved: all coroutines
+ * run with the same settings.
+ *
+ * A new coroutine's stack is prepared so that coroutine_asm_switch
+ * "returns" to coroutine_asm_start, which calls the function and
+ * argument that were placed in two callee-saved register slots.
+ */
+#if defined(__x86_64__)
+/* Frame: r15, r14, r13, r12, rbx, rbp, return address.  */
+enum {
+    FRAME_ARG = 3,              /* r12 */
+    FRAME_FN = 2,               /* r13 */
+    FRAME_FP = 5,               /* rbp */
+    FRAME_RET = 6,
+    FRAME_SIZE = 9,             /* keeps the start function aligned */
+};
+
+asm(".text\n"
+    ".globl coroutine_asm_switch\n"
+    ".hidden coroutine_asm_switch\n"
+    ".type coroutine_asm_switch, @function\n"
+    "coroutine_asm_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    movl %edx, %eax\n"
+    "    ret\n"
+    ".size coroutine_asm_switch, .-coroutine_asm_switch\n"
+    ".globl coroutine_asm_start\n"
+    ".hidden coroutine_asm_start\n"
+    ".type coroutine_asm_start, @function\n"
+    "coroutine_asm_start:\n"
+    "    movq %r12, %rdi\n"
+    "    call *%r13\n"
+    "    ud2\n"
+    ".size coroutine_asm_start, .-coroutine_asm_start\n");
+
+#elif defined(__aarch64__)
+/* Frame: x19-x28, x29, x30, d8-d15.  */
+enum {
+    FRAME_ARG = 0,              /* x19 */
+    FRAME_FN = 1,               /* x20 */
+    FRAME_FP = 10,              /* x29 */
+    FRAME_RET = 11,             /* x30 */
+    FRAME_SIZE = 20,
+};
+
+asm(".text\n"
+    ".globl coroutine_asm_switch\n"
+    ".hidden coroutine_asm_switch\n"
+    ".type coroutine_asm_switch, %function\n"
+    "coroutine_asm_switch:\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x3, sp\n"
+    "    str x3, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    mov w0, w2\n"
+    "    ret\n"
+    ".size coroutine_asm_switch, .-coroutine_asm_switch\n"
+    ".globl coroutine_asm_start\n"
+    ".hidden coroutine_asm_start\n"
+    ".type coroutine_asm_start, %function\n"
+    "coroutine_asm_start:\n"
+    "    mov x0, x19\n"
+    "    blr x20\n"
+    "    brk #0\n"
+    ".size coroutine_asm_start, .-coroutine_asm_start\n");
+
+#else
+#error "The asm coroutine backend does not support this host"
+#endif
+
+int coroutine_asm_switch(void **from_sp, void *to_sp, int action)
+    __attribute__((visibility("hidden")));
+void coroutine_asm_start(void) __attribute__((visibility("hidden")));
+
+static void finish_switch_fiber(void *fake_stack_save)
+{
+#ifdef CONFIG_ASAN
+    const void *bottom_old;
+    size_t size_old;
+
+    __sanitizer_finish_switch_fiber(fake_stack_save, &bottom_old, &size_old);
+
+    if (!leader.stack) {
+        leader.stack = (void *)bottom_old;
+        leader.stack_size = size_old;
+    }
+#endif
+}
+
+static void start_switch_fiber(void **fake_stack_save,
+                               const void *bottom, size_t size)
+{
+#ifdef CONFIG_ASAN
+    __sanitizer_start_switch_fiber(fake_stack_save, bottom, size);
+#endif
+}
+
+static void QEMU_NORETURN coroutine_trampoline(CoroutineAsm *self)
+{
+    Coroutine *co = &self->base;
+
+    finish_switch_fiber(NULL);
+
+    while (true) {
+        co->entry(co->entry_arg);
+        qemu_coroutine_switch(co, co->caller, COROUTINE_TERMINATE);
+    }
+}
+
+Coroutine *qemu_coroutine_new(size_t stack_size)
+{
+    CoroutineAsm *co;
+    uintptr_t *frame;
+
+    co = g_malloc0(sizeof(*co));
+    co->stack_size = stack_size;
+    co->stack = qemu_alloc_stack(&co->stack_size);
+
+    /* The top of the stack is page aligned, and so is the frame.  */
+    frame = co->stack + co->stack_size;
+    frame -= FRAME_SIZE;
+    frame[FRAME_ARG] = (uintptr_t)co;
+    frame[FRAME_FN] = (uintptr_t)coroutine_trampoline;
+    frame[FRAME_FP] = 0;
+    frame[FRAME_RET] = (uintptr_t)coroutine_asm_start;
+    co->sp = frame;
+
+#ifdef CONFIG_VALGRIND_H
+    co->valgrind_stack_id =
+        VALGRIND_STACK_REGISTER(co->stack, co->stack + co->stack_size);
+#endif
+
+    return &co->base;
+}
+
+#ifdef CONFIG_VALGRIND_H
+#if defined(CONFIG_PRAGMA_DIAGNOSTIC_AVAILABLE) && !defined(__clang__)
+/* Work around an unused variable in the valgrind.h macro... */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+static inline void valgrind_stack_deregister(CoroutineAsm *co)
+{
+    VALGRIND_STACK_DEREGISTER(co->valgrind_stack_id);
+}
+#if defined(CONFIG_PRAGMA_DIAGNOSTIC_AVAILABLE) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+void qemu_coroutine_delete(Coroutine *co_)
+{
+    CoroutineAsm *co = DO_UPCAST(CoroutineAsm, base, co_);
+
+#ifdef CONFIG_VALGRIND_H
+    valgrind_stack_deregister(co);
+#endif
+
+    qemu_free_stack(co->stack, co->stack_size);
+    g_free(co);
+}
+
+/* This function is marked noinline to prevent GCC from inlining it
+ * into coroutine_trampoline(). If we allow it to do that then it
+ * hoists the code to get the address of the TLS variable "current"
+ * out of the while() loop. This is an invalid transformation because
+ * the switch may be called when running thread A but return in
+ * thread B, and so we might be in a different thread context each
+ * time round the loop.
+ */
+CoroutineAction __attribute__((noinline))
+qemu_coroutine_switch(Coroutine *from_, Coroutine *to_,
+                      CoroutineAction action)
+{
+    CoroutineAsm *from = DO_UPCAST(CoroutineAsm, base, from_);
+    CoroutineAsm *to = DO_UPCAST(CoroutineAsm, base, to_);
+    void *fake_stack_save = NULL;
+    int ret;
+
+    current = to_;
+
+    start_switch_fiber(action == COROUTINE_TERMINATE ?
+                       NULL : &fake_stack_save, to->stack, to->stack_size);
+    ret = coroutine_asm_switch(&from->sp, to->sp, action);
+    finish_switch_fiber(fake_stack_save);
+
+    return ret;
+}
+
+Coroutine *qemu_coroutine_self(void)
+{
+    if (!current) {
+        current = &leader.base;
+    }
+    return current;
+}
+
+bool qemu_in_coroutine(void)
+{
+    return current && current->caller;
+}
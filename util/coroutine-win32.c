@@ -69,13 +69,14 @@ static void CALLBACK coroutine_trampoline(void *co_)
     }
 }
 
-Coroutine *qemu_coroutine_new(void)
+Coroutine *qemu_coroutine_new(size_t stack_size)
 {
-    const size_t stack_size = COROUTINE_STACK_SIZE;
     CoroutineWin32 *co;
 
     co = g_malloc0(sizeof(*co));
-    co->fiber = CreateFiber(stack_size, coroutine_trampoline, &co->base);
+    /* Only reserve the stack, pages are committed as they are touched.  */
+    co->fiber = CreateFiberEx(0, stack_size, 0, coroutine_trampoline,
+                              &co->base);
     return &co->base;
 }
 
@@ -17,63 +17,178 @@
 #include "qemu-common.h"
 #include "qemu/thread.h"
 #include "qemu/atomic.h"
+#include "qemu/stats64.h"
 #include "qemu/coroutine.h"
 #include "qemu/coroutine_int.h"
 #include "block/aio.h"
 
 enum {
     POOL_BATCH_SIZE = 64,
+    POOL_MAX_SHARED_BATCHES = 4,
 };
 
-/** Free list to speed up creation */
-static QSLIST_HEAD(, Coroutine) release_pool = QSLIST_HEAD_INITIALIZER(pool);
-static unsigned int release_pool_size;
-static __thread QSLIST_HEAD(, Coroutine) alloc_pool = QSLIST_HEAD_INITIALIZER(pool);
-static __thread unsigned int alloc_pool_size;
+/*
+ * Free lists to speed up creation, one per stack size class.  Each thread
+ * puts the coroutines that terminate in it on its own list, and moves
+ * them to or from the shared pool a batch of POOL_BATCH_SIZE coroutines
+ * at a time.  Coroutines that are created in one thread and terminate in
+ * another thus cost one trip through the shared pool's lock every
+ * POOL_BATCH_SIZE coroutines.
+ */
+typedef struct CoroutinePool {
+    QSLIST_HEAD(, Coroutine) list;
+    unsigned int size;
+} CoroutinePool;
+
+/* The shared pool holds whole batches, linked through their first
+ * coroutine's pool_batch_next field.
+ */
+static struct {
+    QemuSpin lock;
+    QSLIST_HEAD(, Coroutine) batches;
+    unsigned int n_batches;
+} release_pool[COROUTINE_STACK_CLASSES];
+
+static __thread CoroutinePool alloc_pool[COROUTINE_STACK_CLASSES];
 static __thread Notifier coroutine_pool_cleanup_notifier;
 
+static Stat64 stacks_allocated;
+static Stat64 stacks_freed;
+static Stat64 batches_released;
+static Stat64 batches_acquired;
+static int live_stacks[COROUTINE_STACK_CLASSES];
+
+static unsigned int coroutine_stack_class(size_t stack_size)
+{
+    unsigned int class = 0;
+
+    assert(stack_size <= COROUTINE_STACK_SIZE);
+    while (((size_t)COROUTINE_STACK_SIZE_MIN << class) < stack_size) {
+        class++;
+    }
+    return class;
+}
+
+static void coroutine_free(Coroutine *co)
+{
+    atomic_dec(&live_stacks[co->stack_class]);
+    stat64_add(&stacks_freed, 1);
+    qemu_coroutine_delete(co);
+}
+
 static void coroutine_pool_cleanup(Notifier *n, void *value)
 {
     Coroutine *co;
     Coroutine *tmp;
+    unsigned int class;
 
-    QSLIST_FOREACH_SAFE(co, &alloc_pool, pool_next, tmp) {
-        QSLIST_REMOVE_HEAD(&alloc_pool, pool_next);
-        qemu_coroutine_delete(co);
+    for (class = 0; class < COROUTINE_STACK_CLASSES; class++) {
+        QSLIST_FOREACH_SAFE(co, &alloc_pool[class].list, pool_next, tmp) {
+            QSLIST_REMOVE_HEAD(&alloc_pool[class].list, pool_next);
+            coroutine_free(co);
+        }
+        alloc_pool[class].size = 0;
     }
 }
 
-Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
+static void coroutine_pool_register_cleanup(void)
+{
+    if (!coroutine_pool_cleanup_notifier.notify) {
+        coroutine_pool_cleanup_notifier.notify = coroutine_pool_cleanup;
+        qemu_thread_atexit_add(&coroutine_pool_cleanup_notifier);
+    }
+}
+
+/* Move the first POOL_BATCH_SIZE coroutines of this thread's pool for
+ * @class to the shared pool, or free them if the shared pool is full.
+ */
+static void coroutine_pool_release_batch(unsigned int class)
+{
+    CoroutinePool *pool = &alloc_pool[class];
+    Coroutine *first, *last, *co, *next;
+    unsigned int i;
+    bool full;
+
+    first = last = QSLIST_FIRST(&pool->list);
+    for (i = 1; i < POOL_BATCH_SIZE; i++) {
+        last = QSLIST_NEXT(last, pool_next);
+    }
+    QSLIST_FIRST(&pool->list) = QSLIST_NEXT(last, pool_next);
+    QSLIST_NEXT(last, pool_next) = NULL;
+    pool->size -= POOL_BATCH_SIZE;
+
+    qemu_spin_lock(&release_pool[class].lock);
+    full = release_pool[class].n_batches == POOL_MAX_SHARED_BATCHES;
+    if (!full) {
+        QSLIST_INSERT_HEAD(&release_pool[class].batches, first,
+                           pool_batch_next);
+        atomic_set(&release_pool[class].n_batches,
+                   release_pool[class].n_batches + 1);
+    }
+    qemu_spin_unlock(&release_pool[class].lock);
+
+    if (!full) {
+        stat64_add(&batches_released, 1);
+        return;
+    }
+
+    for (co = first; co; co = next) {
+        next = QSLIST_NEXT(co, pool_next);
+        coroutine_free(co);
+    }
+}
+
+/* Refill this thread's empty pool for @class from the shared pool.  */
+static Coroutine *coroutine_pool_acquire_batch(unsigned int class)
+{
+    CoroutinePool *pool = &alloc_pool[class];
+    Coroutine *first;
+
+    if (!atomic_read(&release_pool[class].n_batches)) {
+        return NULL;
+    }
+
+    /* Slow path; a good place to register the destructor, too.  */
+    coroutine_pool_register_cleanup();
+
+    qemu_spin_lock(&release_pool[class].lock);
+    first = QSLIST_FIRST(&release_pool[class].batches);
+    if (first) {
+        QSLIST_REMOVE_HEAD(&release_pool[class].batches, pool_batch_next);
+        atomic_set(&release_pool[class].n_batches,
+                   release_pool[class].n_batches - 1);
+    }
+    qemu_spin_unlock(&release_pool[class].lock);
+
+    if (first) {
+        QSLIST_FIRST(&pool->list) = first;
+        pool->size = POOL_BATCH_SIZE;
+        stat64_add(&batches_acquired, 1);
+    }
+    return first;
+}
+
+static inline Coroutine *coroutine_create(CoroutineEntry *entry, void *opaque,
+                                          unsigned int class)
 {
     Coroutine *co = NULL;
 
     if (CONFIG_COROUTINE_POOL) {
-        co = QSLIST_FIRST(&alloc_pool);
+        co = QSLIST_FIRST(&alloc_pool[class].list);
         if (!co) {
-            if (release_pool_size > POOL_BATCH_SIZE) {
-                /* Slow path; a good place to register the destructor, too.  */
-                if (!coroutine_pool_cleanup_notifier.notify) {
-                    coroutine_pool_cleanup_notifier.notify = coroutine_pool_cleanup;
-                    qemu_thread_atexit_add(&coroutine_pool_cleanup_notifier);
-                }
-
-                /* This is not exact; there could be a little skew between
-                 * release_pool_size and the actual size of release_pool.  But
-                 * it is just a heuristic, it does not need to be perfect.
-                 */
-                alloc_pool_size = atomic_xchg(&release_pool_size, 0);
-                QSLIST_MOVE_ATOMIC(&alloc_pool, &release_pool);
-                co = QSLIST_FIRST(&alloc_pool);
-            }
+            co = coroutine_pool_acquire_batch(class);
         }
         if (co) {
-            QSLIST_REMOVE_HEAD(&alloc_pool, pool_next);
-            alloc_pool_size--;
+            QSLIST_REMOVE_HEAD(&alloc_pool[class].list, pool_next);
+            alloc_pool[class].size--;
         }
     }
 
     if (!co) {
-        co = qemu_coroutine_new();
+        co = qemu_coroutine_new((size_t)COROUTINE_STACK_SIZE_MIN << class);
+        co->stack_class = class;
+        atomic_inc(&live_stacks[class]);
+        stat64_add(&stacks_allocated, 1);
     }
 
     co->entry = entry;
@@ -82,24 +197,50 @@ Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
     return co;
 }
 
+Coroutine *qemu_coroutine_create(CoroutineEntry *entry, void *opaque)
+{
+    return coroutine_create(entry, opaque, COROUTINE_STACK_CLASSES - 1);
+}
+
+Coroutine *qemu_coroutine_create_with_stack(CoroutineEntry *entry,
+                                            void *opaque, size_t stack_size)
+{
+    return coroutine_create(entry, opaque, coroutine_stack_class(stack_size));
+}
+
 static void coroutine_delete(Coroutine *co)
 {
     co->caller = NULL;
 
     if (CONFIG_COROUTINE_POOL) {
-        if (release_pool_size < POOL_BATCH_SIZE * 2) {
-            QSLIST_INSERT_HEAD_ATOMIC(&release_pool, co, pool_next);
-            atomic_inc(&release_pool_size);
-            return;
-        }
-        if (alloc_pool_size < POOL_BATCH_SIZE) {
-            QSLIST_INSERT_HEAD(&alloc_pool, co, pool_next);
-            alloc_pool_size++;
-            return;
+        CoroutinePool *pool = &alloc_pool[co->stack_class];
+
+        if (pool->size == POOL_BATCH_SIZE * 2) {
+            coroutine_pool_release_batch(co->stack_class);
+        } else if (pool->size == 0) {
+            coroutine_pool_register_cleanup();
         }
+        QSLIST_INSERT_HEAD(&pool->list, co, pool_next);
+        pool->size++;
+        return;
     }
 
-    qemu_coroutine_delete(co);
+    coroutine_free(co);
+}
+
+void qemu_coroutine_get_pool_stats(CoroutinePoolStats *stats)
+{
+    unsigned int class;
+
+    stats->stacks_allocated = stat64_get(&stacks_allocated);
+    stats->stacks_freed = stat64_get(&stacks_freed);
+    stats->stack_bytes = 0;
+    for (class = 0; class < COROUTINE_STACK_CLASSES; class++) {
+        stats->stack_bytes += (uint64_t)atomic_read(&live_stacks[class]) *
+                              (COROUTINE_STACK_SIZE_MIN << class);
+    }
+    stats->batches_released = stat64_get(&batches_released);
+    stats->batches_acquired = stat64_get(&batches_acquired);
 }
 
 void qemu_aio_coroutine_enter(AioContext *ctx, Coroutine *co)
@@ -65,10 +65,18 @@ static QEMUClock qemu_clocks[QEMU_CLOCK_MAX];
  * reenabling the clock can call all the notifiers.
  */
 
+/* The active timers are kept in a pairing heap, so that arming and
+ * cancelling a timer does not need to walk all the other timers on the
+ * list.  active_timers is the root of the heap, i.e. the timer that
+ * expires first.  Timers with the same expiry time fire in the order
+ * they were armed, as they did when active_timers was a sorted list.
+ */
+
 struct QEMUTimerList {
     QEMUClock *clock;
     QemuMutex active_timers_lock;
     QEMUTimer *active_timers;
+    uint64_t timer_seq;
     QLIST_ENTRY(QEMUTimerList) list;
     QEMUTimerListNotifyCB *notify_cb;
     void *notify_opaque;
@@ -356,43 +364,107 @@ void timer_deinit(QEMUTimer *ts)
     ts->timer_list = NULL;
 }
 
-static void timer_del_locked(QEMUTimerList *timer_list, QEMUTimer *ts)
+static bool timer_before(QEMUTimer *a, QEMUTimer *b)
 {
-    QEMUTimer **pt, *t;
+    return a->expire_time < b->expire_time ||
+           (a->expire_time == b->expire_time && a->seq < b->seq);
+}
 
-    ts->expire_time = -1;
-    pt = &timer_list->active_timers;
-    for(;;) {
-        t = *pt;
-        if (!t)
-            break;
-        if (t == ts) {
-            atomic_set(pt, t->next);
-            break;
+/* Merge two heaps, whose roots must not have siblings.  */
+static QEMUTimer *timer_heap_meld(QEMUTimer *a, QEMUTimer *b)
+{
+    QEMUTimer *t;
+
+    if (!a) {
+        return b;
+    }
+    if (!b) {
+        return a;
+    }
+    if (timer_before(b, a)) {
+        t = a, a = b, b = t;
+    }
+
+    /* b becomes the first child of a.  */
+    b->prev = a;
+    b->next = a->child;
+    if (a->child) {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
+
+/* Merge a list of sibling heaps into one, using the standard two-pass
+ * pairing: meld pairs left to right, then accumulate the results right
+ * to left.  The intermediate results are stacked through ->next.
+ */
+static QEMUTimer *timer_heap_merge_pairs(QEMUTimer *first)
+{
+    QEMUTimer *a, *b, *stack = NULL, *root = NULL;
+
+    while (first) {
+        a = first;
+        b = a->next;
+        first = b ? b->next : NULL;
+        a->next = a->prev = NULL;
+        if (b) {
+            b->next = b->prev = NULL;
+            a = timer_heap_meld(a, b);
         }
-        pt = &t->next;
+        a->next = stack;
+        stack = a;
     }
+
+    while (stack) {
+        a = stack;
+        stack = a->next;
+        a->next = NULL;
+        root = timer_heap_meld(root, a);
+    }
+    return root;
 }
 
-static bool timer_mod_ns_locked(QEMUTimerList *timer_list,
-                                QEMUTimer *ts, int64_t expire_time)
+static void timer_heap_remove(QEMUTimerList *timer_list, QEMUTimer *ts)
 {
-    QEMUTimer **pt, *t;
+    QEMUTimer *sub = timer_heap_merge_pairs(ts->child);
 
-    /* add the timer in the sorted list */
-    pt = &timer_list->active_timers;
-    for (;;) {
-        t = *pt;
-        if (!timer_expired_ns(t, expire_time)) {
-            break;
+    if (ts == timer_list->active_timers) {
+        atomic_set(&timer_list->active_timers, sub);
+    } else {
+        /* Unlink ts from its parent's list of children.  */
+        if (ts->prev->child == ts) {
+            ts->prev->child = ts->next;
+        } else {
+            ts->prev->next = ts->next;
+        }
+        if (ts->next) {
+            ts->next->prev = ts->prev;
         }
-        pt = &t->next;
+        atomic_set(&timer_list->active_timers,
+                   timer_heap_meld(timer_list->active_timers, sub));
+    }
+    ts->next = ts->prev = ts->child = NULL;
+}
+
+static void timer_del_locked(QEMUTimerList *timer_list, QEMUTimer *ts)
+{
+    if (ts->expire_time != -1) {
+        timer_heap_remove(timer_list, ts);
     }
+    ts->expire_time = -1;
+}
+
+static bool timer_mod_ns_locked(QEMUTimerList *timer_list,
+                                QEMUTimer *ts, int64_t expire_time)
+{
     ts->expire_time = MAX(expire_time, 0);
-    ts->next = *pt;
-    atomic_set(pt, ts);
+    ts->seq = timer_list->timer_seq++;
+    ts->next = ts->prev = ts->child = NULL;
+    atomic_set(&timer_list->active_timers,
+               timer_heap_meld(timer_list->active_timers, ts));
 
-    return pt == &timer_list->active_timers;
+    return timer_list->active_timers == ts;
 }
 
 static void timerlist_rearm(QEMUTimerList *timer_list)
@@ -525,8 +597,7 @@ bool timerlist_run_timers(QEMUTimerList *timer_list)
         }
 
         /* remove timer from the list before calling the callback */
-        timer_list->active_timers = ts->next;
-        ts->next = NULL;
+        timer_heap_remove(timer_list, ts);
         ts->expire_time = -1;
         cb = ts->cb;
         opaque = ts->opaque;
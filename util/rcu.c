@@ -32,6 +32,7 @@
 #include "qemu/atomic.h"
 #include "qemu/thread.h"
 #include "qemu/main-loop.h"
+#include "qemu/timer.h"
 #if defined(CONFIG_MALLOC_TRIM)
 #include <malloc.h>
 #endif
@@ -49,6 +50,22 @@ QemuEvent rcu_gp_event;
 static QemuMutex rcu_registry_lock;
 static QemuMutex rcu_sync_lock;
 
+/*
+ * Number of grace periods completed.  Written under rcu_sync_lock, but
+ * read outside it by synchronize_rcu to find out whether a grace period
+ * that started after the call has already elapsed.
+ */
+static unsigned long rcu_gp_completed;
+
+/* Statistics for rcu_get_stats.  Written under rcu_sync_lock, except
+ * for callbacks that is only written by the call_rcu thread.
+ */
+static uint64_t rcu_stat_grace_periods;
+static uint64_t rcu_stat_shared_grace_periods;
+static uint64_t rcu_stat_callbacks;
+static uint64_t rcu_stat_wait_ns;
+static uint64_t rcu_stat_max_wait_ns;
+
 /*
  * Check whether a quiescent state was crossed between the beginning of
  * update_counter_and_wait and now.
@@ -57,7 +74,10 @@ static inline int rcu_gp_ongoing(unsigned long *ctr)
 {
     unsigned long v;
 
-    v = atomic_read(ctr);
+    /* Order the load of *ctr before the writer frees anything; pairs
+     * with atomic_store_release in rcu_read_unlock.
+     */
+    v = atomic_load_acquire(ctr);
     return v && (v != rcu_gp_ctr);
 }
 
@@ -93,9 +113,12 @@ static void wait_for_readers(void)
         }
 
         /* Here, order the stores to index->waiting before the
-         * loads of index->ctr.
+         * loads of index->ctr.  Pairs with smp_mb_placeholder() in
+         * rcu_read_lock() and rcu_read_unlock(): if membarrier(2) is
+         * available, the readers only have a compiler barrier and the
+         * ordering is forced on them from here.
          */
-        smp_mb();
+        smp_mb_global();
 
         QLIST_FOREACH_SAFE(index, &registry, node, tmp) {
             if (!rcu_gp_ongoing(&index->ctr)) {
@@ -141,10 +164,35 @@ static void wait_for_readers(void)
 
 void synchronize_rcu(void)
 {
+    unsigned long snap;
+    int64_t start, wait_ns;
+
+    /* Any grace period that starts after this point covers the caller.
+     * One may already be in progress, so wait for the second one to
+     * complete; the first ends with rcu_gp_completed == snap - 1.  The
+     * barrier orders the caller's removal of RCU-protected pointers
+     * before the read of rcu_gp_completed.
+     */
+    smp_mb();
+    snap = atomic_read(&rcu_gp_completed) + 2;
+
     qemu_mutex_lock(&rcu_sync_lock);
+
+    /* Concurrent callers queue up on rcu_sync_lock while a grace period
+     * runs; once it is over, all of them but the first can share the
+     * next one instead of running their own back to back.
+     */
+    if ((long)(atomic_read(&rcu_gp_completed) - snap) >= 0) {
+        atomic_set__nocheck(&rcu_stat_shared_grace_periods,
+                            rcu_stat_shared_grace_periods + 1);
+        qemu_mutex_unlock(&rcu_sync_lock);
+        return;
+    }
+
     qemu_mutex_lock(&rcu_registry_lock);
 
     if (!QLIST_EMPTY(&registry)) {
+        start = get_clock();
         /* In either case, the atomic_mb_set below blocks stores that free
          * old RCU-protected pointers.
          */
@@ -163,8 +211,17 @@ void synchronize_rcu(void)
         }
 
         wait_for_readers();
+
+        wait_ns = get_clock() - start;
+        atomic_set__nocheck(&rcu_stat_grace_periods,
+                            rcu_stat_grace_periods + 1);
+        atomic_set__nocheck(&rcu_stat_wait_ns, rcu_stat_wait_ns + wait_ns);
+        if (wait_ns > rcu_stat_max_wait_ns) {
+            atomic_set__nocheck(&rcu_stat_max_wait_ns, wait_ns);
+        }
     }
 
+    atomic_mb_set(&rcu_gp_completed, rcu_gp_completed + 1);
     qemu_mutex_unlock(&rcu_registry_lock);
     qemu_mutex_unlock(&rcu_sync_lock);
 }
@@ -276,6 +333,7 @@ static void *call_rcu_thread(void *opaque)
 
             n--;
             node->func(node);
+            atomic_set__nocheck(&rcu_stat_callbacks, rcu_stat_callbacks + 1);
         }
         qemu_mutex_unlock_iothread();
     }
@@ -290,6 +348,18 @@ void call_rcu1(struct rcu_head *node, void (*func)(struct rcu_head *node))
     qemu_event_set(&rcu_call_ready_event);
 }
 
+void rcu_get_stats(RCUStats *stats)
+{
+    stats->grace_periods = atomic_read__nocheck(&rcu_stat_grace_periods);
+    stats->shared_grace_periods =
+        atomic_read__nocheck(&rcu_stat_shared_grace_periods);
+    stats->callbacks = atomic_read__nocheck(&rcu_stat_callbacks);
+    stats->backlog = atomic_read(&rcu_call_count);
+    stats->wait_ns = atomic_read__nocheck(&rcu_stat_wait_ns);
+    stats->max_wait_ns = atomic_read__nocheck(&rcu_stat_max_wait_ns);
+    stats->expedited = smp_mb_global_available;
+}
+
 void rcu_register_thread(void)
 {
     assert(rcu_reader.ctr == 0);
@@ -315,6 +385,9 @@ static void rcu_init_complete(void)
 
     qemu_event_init(&rcu_call_ready_event, false);
 
+    /* After fork(), the child has a new mm and must register again.  */
+    smp_mb_global_init();
+
     /* The caller is assumed to have iothread lock, so the call_rcu thread
      * must have been quiescent even after forking, just recreate it.
      */
@@ -0,0 +1,50 @@
+/*
+ * Process-global memory barriers
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/sys_membarrier.h"
+#include <sys/syscall.h>
+#include <linux/membarrier.h>
+
+bool smp_mb_global_available;
+
+static int membarrier(int cmd, int flags)
+{
+    return syscall(__NR_membarrier, cmd, flags);
+}
+
+void smp_mb_global(void)
+{
+    if (likely(smp_mb_global_available)) {
+        /* Cannot fail once registration has succeeded.  */
+        membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+    } else {
+        smp_mb();
+    }
+}
+
+void smp_mb_global_init(void)
+{
+    int ret;
+
+    smp_mb_global_available = false;
+
+    /* MEMBARRIER_CMD_SHARED is implemented with synchronize_sched() in
+     * the kernel and takes milliseconds, so only the expedited variant
+     * (which IPIs the CPUs running our threads) is worth using.  The
+     * registration is per mm, so this is also called again in the child
+     * after fork().
+     */
+    ret = membarrier(MEMBARRIER_CMD_QUERY, 0);
+    if (ret < 0 || !(ret & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+        return;
+    }
+    if (membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) < 0) {
+        return;
+    }
+    smp_mb_global_available = true;
+}
@@ -19,13 +19,19 @@
 #include "qemu/queue.h"
 #include "qemu/thread.h"
 #include "qemu/coroutine.h"
+#include "qemu/bitmap.h"
+#include "qemu/timer.h"
 #include "trace.h"
 #include "block/thread-pool.h"
 #include "qemu/main-loop.h"
+#ifdef CONFIG_LINUX
+#include <sched.h>
+#endif
 
 static void do_spawn_thread(ThreadPool *pool);
 
 typedef struct ThreadPoolElement ThreadPoolElement;
+typedef struct ThreadPoolWorker ThreadPoolWorker;
 
 enum ThreadState {
     THREAD_QUEUED,
@@ -39,100 +45,355 @@ struct ThreadPoolElement {
     ThreadPoolFunc *func;
     void *arg;
 
-    /* Moving state out of THREAD_QUEUED is protected by lock.  After
+    /* The worker whose queue the request was put on.  Set before the
+     * request is queued and never changed afterwards.
+     */
+    ThreadPoolWorker *worker;
+    int64_t submit_ns;
+
+    /* Moving state out of THREAD_QUEUED is protected by worker->lock.  After
      * that, only the worker thread can write to it.  Reads and writes
      * of state and ret are ordered with memory barriers.
      */
     enum ThreadState state;
     int ret;
 
-    /* Access to this list is protected by lock.  */
+    /* Access to this list is protected by worker->lock.  */
     QTAILQ_ENTRY(ThreadPoolElement) reqs;
 
     /* Access to this list is protected by the global mutex.  */
     QLIST_ENTRY(ThreadPoolElement) all;
 };
 
+/* Each worker thread has its own request queue, so that submitting a
+ * request only contends with the thread that will run it.  A worker whose
+ * queue is empty takes requests from the other queues before going to
+ * sleep.  The slot is kept until thread_pool_free(), even after the thread
+ * has exited, so that other threads can look at it without locking.
+ */
+struct ThreadPoolWorker {
+    ThreadPool *pool;
+    int index;
+    QemuSemaphore sem;  /* posted by whoever claims the idle bit */
+
+    /* The following variables are protected by lock.  */
+    QemuMutex lock;
+    QTAILQ_HEAD(, ThreadPoolElement) request_list;
+    unsigned int queue_depth;
+    unsigned int max_queue_depth;
+    bool running;       /* a thread is (or is about to be) serving the queue */
+
+    /* Statistics, only written by the thread that owns the slot.  */
+    uint64_t requests;
+    uint64_t steals;
+    int64_t queue_ns;
+    int64_t run_ns;
+};
+
 struct ThreadPool {
     AioContext *ctx;
     QEMUBH *completion_bh;
     QemuMutex lock;
     QemuCond worker_stopped;
-    QemuSemaphore sem;
-    int max_threads;
     QEMUBH *new_thread_bh;
 
     /* The following variables are only accessed from one AioContext. */
     QLIST_HEAD(, ThreadPoolElement) head;
+    unsigned int next_worker;
+
+    /* Worker slots, allocated under lock and then never freed until
+     * thread_pool_free().  nr_workers only grows.
+     */
+    ThreadPoolWorker *workers[THREAD_POOL_MAX_THREADS];
+    int nr_workers;
+
+    /* Workers sleeping on their semaphore.  Submitters claim a bit with
+     * an atomic and, and then post the semaphore of the worker.
+     */
+    DECLARE_BITMAP(idle_workers, THREAD_POOL_MAX_THREADS);
 
     /* The following variables are protected by lock.  */
-    QTAILQ_HEAD(, ThreadPoolElement) request_list;
+    DECLARE_BITMAP(start_workers, THREAD_POOL_MAX_THREADS);
+    int min_threads;
+    int max_threads;
     int cur_threads;
-    int idle_threads;
     int new_threads;     /* backlog of threads we need to create */
     int pending_threads; /* threads created but not running yet */
     bool stopping;
+    unsigned long *cpus; /* host CPUs for the workers, NULL for any */
+    unsigned int affinity_gen;
 };
 
+#ifdef CONFIG_LINUX
+/* Apply the CPU affinity of the pool to the calling thread.  Without an
+ * affinity setting, go back to the one inherited when it was created.
+ */
+static void thread_pool_set_affinity(ThreadPool *pool,
+                                     const cpu_set_t *inherited)
+{
+    cpu_set_t set;
+    long cpu;
+
+    qemu_mutex_lock(&pool->lock);
+    if (pool->cpus) {
+        CPU_ZERO(&set);
+        for (cpu = find_first_bit(pool->cpus, THREAD_POOL_MAX_CPUS);
+             cpu < MIN(THREAD_POOL_MAX_CPUS, CPU_SETSIZE);
+             cpu = find_next_bit(pool->cpus, THREAD_POOL_MAX_CPUS, cpu + 1)) {
+            CPU_SET(cpu, &set);
+        }
+    } else {
+        set = *inherited;
+    }
+    qemu_mutex_unlock(&pool->lock);
+
+    if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+        trace_thread_pool_set_affinity_failed(pool, errno);
+    }
+}
+#endif
+
+/* Claim an idle worker so that nobody else wakes it up.  Returns NULL if
+ * all workers are busy.
+ */
+static ThreadPoolWorker *thread_pool_claim_idle(ThreadPool *pool)
+{
+    int nr_words = BITS_TO_LONGS(atomic_read(&pool->nr_workers));
+    int i;
+
+    for (i = 0; i < nr_words; i++) {
+        unsigned long word = atomic_read(&pool->idle_workers[i]);
+
+        while (word) {
+            unsigned long mask = word & -word;
+
+            if (atomic_fetch_and(&pool->idle_workers[i], ~mask) & mask) {
+                return atomic_rcu_read(&pool->workers[i * BITS_PER_LONG +
+                                                      ctzl(mask)]);
+            }
+            word &= ~mask;
+        }
+    }
+    return NULL;
+}
+
+/* Go back to work after having set the idle bit.  If somebody claimed the
+ * worker in the meanwhile, consume the semaphore post that comes with it.
+ */
+static void thread_pool_worker_unidle(ThreadPoolWorker *worker)
+{
+    ThreadPool *pool = worker->pool;
+    unsigned long mask = BIT_MASK(worker->index);
+
+    if (!(atomic_fetch_and(&pool->idle_workers[BIT_WORD(worker->index)],
+                           ~mask) & mask)) {
+        qemu_sem_wait(&worker->sem);
+    }
+}
+
+/* Runs with worker->lock taken.  */
+static void thread_pool_push_locked(ThreadPoolWorker *worker,
+                                    ThreadPoolElement *req)
+{
+    req->worker = worker;
+    QTAILQ_INSERT_TAIL(&worker->request_list, req, reqs);
+    worker->queue_depth++;
+}
+
+/* Runs with worker->lock taken.  */
+static ThreadPoolElement *thread_pool_pop_locked(ThreadPoolWorker *worker)
+{
+    ThreadPoolElement *req = QTAILQ_FIRST(&worker->request_list);
+
+    if (req) {
+        QTAILQ_REMOVE(&worker->request_list, req, reqs);
+        worker->queue_depth--;
+        req->state = THREAD_ACTIVE;
+    }
+    return req;
+}
+
+/* Take the oldest request from another worker's queue.  Stealing from the
+ * head rather than the tail keeps requests roughly in submission order,
+ * which matters more for I/O latency than cache locality does here.
+ */
+static ThreadPoolElement *thread_pool_steal(ThreadPoolWorker *worker)
+{
+    ThreadPool *pool = worker->pool;
+    int nr_workers = atomic_read(&pool->nr_workers);
+    int i;
+
+    for (i = 1; i < nr_workers; i++) {
+        ThreadPoolWorker *victim;
+        ThreadPoolElement *req;
+
+        victim = atomic_rcu_read(&pool->workers[(worker->index + i) %
+                                                nr_workers]);
+        if (!victim || !atomic_read(&victim->queue_depth)) {
+            continue;
+        }
+
+        qemu_mutex_lock(&victim->lock);
+        req = thread_pool_pop_locked(victim);
+        qemu_mutex_unlock(&victim->lock);
+        if (req) {
+            atomic_set__nocheck(&worker->steals, worker->steals + 1);
+            return req;
+        }
+    }
+    return NULL;
+}
+
+/* Returns true if the thread should exit, in which case the slot has
+ * been released and the thread must not touch it anymore.  This only
+ * happens if the queue is empty; submitters check worker->running under
+ * worker->lock, so nothing can be queued afterwards.
+ */
+static bool thread_pool_worker_exit(ThreadPoolWorker *worker)
+{
+    ThreadPool *pool = worker->pool;
+    bool exit = false;
+
+    qemu_mutex_lock(&pool->lock);
+    if (pool->stopping || pool->cur_threads > pool->min_threads) {
+        qemu_mutex_lock(&worker->lock);
+        if (QTAILQ_EMPTY(&worker->request_list)) {
+            worker->running = false;
+            exit = true;
+        }
+        qemu_mutex_unlock(&worker->lock);
+    }
+    if (exit) {
+        pool->cur_threads--;
+        qemu_cond_signal(&pool->worker_stopped);
+    }
+    qemu_mutex_unlock(&pool->lock);
+    return exit;
+}
+
+/* Returns the next request for the worker, or NULL if the thread should
+ * exit.
+ */
+static ThreadPoolElement *thread_pool_next_request(ThreadPoolWorker *worker)
+{
+    ThreadPool *pool = worker->pool;
+    ThreadPoolElement *req;
+
+    for (;;) {
+        if (atomic_read(&pool->stopping) && thread_pool_worker_exit(worker)) {
+            return NULL;
+        }
+
+        qemu_mutex_lock(&worker->lock);
+        req = thread_pool_pop_locked(worker);
+        qemu_mutex_unlock(&worker->lock);
+        if (req) {
+            return req;
+        }
+
+        /* Advertise the worker as idle before looking at the other
+         * queues: the submitter queues first and then looks at
+         * idle_workers, so one of the two will notice the other.
+         */
+        set_bit_atomic(worker->index, pool->idle_workers);
+
+        req = thread_pool_steal(worker);
+        if (req || atomic_read(&worker->queue_depth) ||
+            atomic_read(&pool->stopping)) {
+            thread_pool_worker_unidle(worker);
+            if (req) {
+                return req;
+            }
+            continue;
+        }
+
+        if (qemu_sem_timedwait(&worker->sem, 10000) == 0) {
+            /* Claimed by a submitter, which cleared the idle bit.  */
+            continue;
+        }
+
+        thread_pool_worker_unidle(worker);
+        if (thread_pool_worker_exit(worker)) {
+            return NULL;
+        }
+    }
+}
+
 static void *worker_thread(void *opaque)
 {
-    ThreadPool *pool = opaque;
+    ThreadPoolWorker *worker = opaque;
+    ThreadPool *pool = worker->pool;
+    ThreadPoolElement *req;
+#ifdef CONFIG_LINUX
+    unsigned int affinity_gen = 0;
+    cpu_set_t inherited;
+
+    if (sched_getaffinity(0, sizeof(inherited), &inherited) < 0) {
+        CPU_ZERO(&inherited);
+    }
+#endif
 
     qemu_mutex_lock(&pool->lock);
     pool->pending_threads--;
     do_spawn_thread(pool);
+    qemu_mutex_unlock(&pool->lock);
 
-    while (!pool->stopping) {
-        ThreadPoolElement *req;
+    for (;;) {
+        int64_t start_ns;
         int ret;
 
-        do {
-            pool->idle_threads++;
-            qemu_mutex_unlock(&pool->lock);
-            ret = qemu_sem_timedwait(&pool->sem, 10000);
-            qemu_mutex_lock(&pool->lock);
-            pool->idle_threads--;
-        } while (ret == -1 && !QTAILQ_EMPTY(&pool->request_list));
-        if (ret == -1 || pool->stopping) {
+#ifdef CONFIG_LINUX
+        if (affinity_gen != atomic_read(&pool->affinity_gen)) {
+            affinity_gen = atomic_read(&pool->affinity_gen);
+            thread_pool_set_affinity(pool, &inherited);
+        }
+#endif
+
+        req = thread_pool_next_request(worker);
+        if (!req) {
             break;
         }
 
-        req = QTAILQ_FIRST(&pool->request_list);
-        QTAILQ_REMOVE(&pool->request_list, req, reqs);
-        req->state = THREAD_ACTIVE;
-        qemu_mutex_unlock(&pool->lock);
+        start_ns = get_clock();
+        atomic_set__nocheck(&worker->queue_ns,
+                            worker->queue_ns + start_ns - req->submit_ns);
 
         ret = req->func(req->arg);
 
+        atomic_set__nocheck(&worker->run_ns,
+                            worker->run_ns + get_clock() - start_ns);
+        atomic_set__nocheck(&worker->requests, worker->requests + 1);
+
         req->ret = ret;
         /* Write ret before state.  */
         smp_wmb();
         req->state = THREAD_DONE;
 
-        qemu_mutex_lock(&pool->lock);
-
         qemu_bh_schedule(pool->completion_bh);
     }
 
-    pool->cur_threads--;
-    qemu_cond_signal(&pool->worker_stopped);
-    qemu_mutex_unlock(&pool->lock);
     return NULL;
 }
 
 static void do_spawn_thread(ThreadPool *pool)
 {
     QemuThread t;
+    long i;
 
     /* Runs with lock taken.  */
     if (!pool->new_threads) {
         return;
     }
 
+    i = find_first_bit(pool->start_workers, THREAD_POOL_MAX_THREADS);
+    assert(i < THREAD_POOL_MAX_THREADS);
+    clear_bit(i, pool->start_workers);
+
     pool->new_threads--;
     pool->pending_threads++;
 
-    qemu_thread_create(&t, "worker", worker_thread, pool, QEMU_THREAD_DETACHED);
+    qemu_thread_create(&t, "worker", worker_thread, pool->workers[i],
+                       QEMU_THREAD_DETACHED);
 }
 
 static void spawn_thread_bh_fn(void *opaque)
@@ -144,8 +405,41 @@ static void spawn_thread_bh_fn(void *opaque)
     qemu_mutex_unlock(&pool->lock);
 }
 
-static void spawn_thread(ThreadPool *pool)
+/* Reserve a worker slot for a new thread.  Runs with lock taken.  Returns
+ * NULL if no slot is available.
+ */
+static ThreadPoolWorker *spawn_thread(ThreadPool *pool)
 {
+    ThreadPoolWorker *worker = NULL;
+    int i;
+
+    for (i = 0; i < pool->nr_workers; i++) {
+        worker = pool->workers[i];
+        qemu_mutex_lock(&worker->lock);
+        if (!worker->running) {
+            worker->running = true;
+            qemu_mutex_unlock(&worker->lock);
+            break;
+        }
+        qemu_mutex_unlock(&worker->lock);
+    }
+
+    if (i == pool->nr_workers) {
+        if (i == THREAD_POOL_MAX_THREADS) {
+            return NULL;
+        }
+        worker = g_new0(ThreadPoolWorker, 1);
+        worker->pool = pool;
+        worker->index = i;
+        worker->running = true;
+        qemu_mutex_init(&worker->lock);
+        qemu_sem_init(&worker->sem, 0);
+        QTAILQ_INIT(&worker->request_list);
+        atomic_rcu_set(&pool->workers[i], worker);
+        atomic_set(&pool->nr_workers, i + 1);
+    }
+
+    set_bit(i, pool->start_workers);
     pool->cur_threads++;
     pool->new_threads++;
     /* If there are threads being created, they will spawn new workers, so
@@ -158,6 +452,7 @@ static void spawn_thread(ThreadPool *pool)
     if (!pool->pending_threads) {
         qemu_bh_schedule(pool->new_thread_bh);
     }
+    return worker;
 }
 
 static void thread_pool_completion_bh(void *opaque)
@@ -208,25 +503,24 @@ static void thread_pool_cancel(BlockAIOCB *acb)
 {
     ThreadPoolElement *elem = (ThreadPoolElement *)acb;
     ThreadPool *pool = elem->pool;
+    ThreadPoolWorker *worker = elem->worker;
 
     trace_thread_pool_cancel(elem, elem->common.opaque);
 
-    qemu_mutex_lock(&pool->lock);
-    if (elem->state == THREAD_QUEUED &&
-        /* No thread has yet started working on elem. we can try to "steal"
-         * the item from the worker if we can get a signal from the
-         * semaphore.  Because this is non-blocking, we can do it with
-         * the lock taken and ensure that elem will remain THREAD_QUEUED.
-         */
-        qemu_sem_timedwait(&pool->sem, 0) == 0) {
-        QTAILQ_REMOVE(&pool->request_list, elem, reqs);
+    /* No thread has yet started working on elem if it is still queued, and
+     * it cannot be taken from the queue while we hold the lock.
+     */
+    qemu_mutex_lock(&worker->lock);
+    if (elem->state == THREAD_QUEUED) {
+        QTAILQ_REMOVE(&worker->request_list, elem, reqs);
+        worker->queue_depth--;
         qemu_bh_schedule(pool->completion_bh);
 
         elem->state = THREAD_DONE;
         elem->ret = -ECANCELED;
     }
 
-    qemu_mutex_unlock(&pool->lock);
+    qemu_mutex_unlock(&worker->lock);
 }
 
 static AioContext *thread_pool_get_aio_context(BlockAIOCB *acb)
@@ -242,6 +536,87 @@ static const AIOCBInfo thread_pool_aiocb_info = {
     .get_aio_context    = thread_pool_get_aio_context,
 };
 
+/* Queue @req on @worker if a thread is serving it.  */
+static bool thread_pool_push(ThreadPoolWorker *worker, ThreadPoolElement *req)
+{
+    bool running;
+
+    qemu_mutex_lock(&worker->lock);
+    running = worker->running;
+    if (running) {
+        thread_pool_push_locked(worker, req);
+        worker->max_queue_depth = MAX(worker->max_queue_depth,
+                                      worker->queue_depth);
+    }
+    qemu_mutex_unlock(&worker->lock);
+    return running;
+}
+
+static void thread_pool_enqueue(ThreadPool *pool, ThreadPoolElement *req)
+{
+    ThreadPoolWorker *worker;
+    int i, nr_workers;
+
+    /* Prefer a worker that is sleeping; it was claimed, so it is still
+     * running and will be woken up by us alone.
+     */
+    worker = thread_pool_claim_idle(pool);
+    if (worker) {
+        bool queued = thread_pool_push(worker, req);
+
+        assert(queued);
+        qemu_sem_post(&worker->sem);
+        return;
+    }
+
+    qemu_mutex_lock(&pool->lock);
+    if (pool->cur_threads < pool->max_threads) {
+        worker = spawn_thread(pool);
+        if (worker) {
+            thread_pool_push(worker, req);
+            qemu_mutex_unlock(&pool->lock);
+            return;
+        }
+    }
+    qemu_mutex_unlock(&pool->lock);
+
+    /* All threads are busy, queue the request round robin.  Threads can
+     * exit concurrently, so retry until one accepts it.
+     */
+    for (;;) {
+        nr_workers = atomic_read(&pool->nr_workers);
+        for (i = 0; i < nr_workers; i++) {
+            worker = atomic_rcu_read(&pool->workers[pool->next_worker++ %
+                                                    nr_workers]);
+            if (worker && thread_pool_push(worker, req)) {
+                goto queued;
+            }
+        }
+
+        qemu_mutex_lock(&pool->lock);
+        worker = NULL;
+        if (pool->cur_threads < pool->max_threads) {
+            worker = spawn_thread(pool);
+        }
+        if (worker) {
+            thread_pool_push(worker, req);
+            qemu_mutex_unlock(&pool->lock);
+            return;
+        }
+        qemu_mutex_unlock(&pool->lock);
+    }
+
+queued:
+    /* A worker may have gone idle since we looked; it will steal the
+     * request.  Pairs with set_bit_atomic in thread_pool_next_request.
+     */
+    smp_mb();
+    worker = thread_pool_claim_idle(pool);
+    if (worker) {
+        qemu_sem_post(&worker->sem);
+    }
+}
+
 BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
         ThreadPoolFunc *func, void *arg,
         BlockCompletionFunc *cb, void *opaque)
@@ -253,18 +628,13 @@ BlockAIOCB *thread_pool_submit_aio(ThreadPool *pool,
     req->arg = arg;
     req->state = THREAD_QUEUED;
     req->pool = pool;
+    req->submit_ns = get_clock();
 
     QLIST_INSERT_HEAD(&pool->head, req, all);
 
     trace_thread_pool_submit(pool, req, arg);
 
-    qemu_mutex_lock(&pool->lock);
-    if (pool->idle_threads == 0 && pool->cur_threads < pool->max_threads) {
-        spawn_thread(pool);
-    }
-    QTAILQ_INSERT_TAIL(&pool->request_list, req, reqs);
-    qemu_mutex_unlock(&pool->lock);
-    qemu_sem_post(&pool->sem);
+    thread_pool_enqueue(pool, req);
     return &req->common;
 }
 
@@ -296,6 +666,69 @@ void thread_pool_submit(ThreadPool *pool, ThreadPoolFunc *func, void *arg)
     thread_pool_submit_aio(pool, func, arg, NULL, NULL);
 }
 
+/* Start threads until there are at least min_threads.  Runs with lock
+ * taken.
+ */
+static void thread_pool_adjust_min_threads(ThreadPool *pool)
+{
+    while (pool->cur_threads < pool->min_threads) {
+        if (!spawn_thread(pool)) {
+            break;
+        }
+    }
+}
+
+void thread_pool_update_params(ThreadPool *pool, AioContext *ctx)
+{
+    qemu_mutex_lock(&ctx->thread_pool_params_lock);
+    qemu_mutex_lock(&pool->lock);
+
+    pool->min_threads = ctx->thread_pool_min;
+    pool->max_threads = ctx->thread_pool_max;
+
+    g_free(pool->cpus);
+    pool->cpus = NULL;
+    if (ctx->thread_pool_cpus) {
+        pool->cpus = bitmap_new(THREAD_POOL_MAX_CPUS);
+        bitmap_copy(pool->cpus, ctx->thread_pool_cpus, THREAD_POOL_MAX_CPUS);
+    }
+    /* Threads pick up the new affinity before running their next request */
+    atomic_inc(&pool->affinity_gen);
+
+    thread_pool_adjust_min_threads(pool);
+
+    qemu_mutex_unlock(&pool->lock);
+    qemu_mutex_unlock(&ctx->thread_pool_params_lock);
+}
+
+void thread_pool_get_stats(ThreadPool *pool, ThreadPoolStats *stats)
+{
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    qemu_mutex_lock(&pool->lock);
+    stats->min_threads = pool->min_threads;
+    stats->max_threads = pool->max_threads;
+    stats->threads = pool->cur_threads;
+
+    for (i = 0; i < pool->nr_workers; i++) {
+        ThreadPoolWorker *worker = pool->workers[i];
+
+        qemu_mutex_lock(&worker->lock);
+        stats->queue_depth += worker->queue_depth;
+        stats->max_queue_depth = MAX(stats->max_queue_depth,
+                                     worker->max_queue_depth);
+        qemu_mutex_unlock(&worker->lock);
+
+        stats->requests += atomic_read__nocheck(&worker->requests);
+        stats->steals += atomic_read__nocheck(&worker->steals);
+        stats->queue_ns += atomic_read__nocheck(&worker->queue_ns);
+        stats->run_ns += atomic_read__nocheck(&worker->run_ns);
+    }
+    qemu_mutex_unlock(&pool->lock);
+}
+
 static void thread_pool_init_one(ThreadPool *pool, AioContext *ctx)
 {
     if (!ctx) {
@@ -307,12 +740,11 @@ static void thread_pool_init_one(ThreadPool *pool, AioContext *ctx)
     pool->completion_bh = aio_bh_new(ctx, thread_pool_completion_bh, pool);
     qemu_mutex_init(&pool->lock);
     qemu_cond_init(&pool->worker_stopped);
-    qemu_sem_init(&pool->sem, 0);
-    pool->max_threads = 64;
     pool->new_thread_bh = aio_bh_new(ctx, spawn_thread_bh_fn, pool);
 
     QLIST_INIT(&pool->head);
-    QTAILQ_INIT(&pool->request_list);
+
+    thread_pool_update_params(pool, ctx);
 }
 
 ThreadPool *thread_pool_new(AioContext *ctx)
@@ -324,6 +756,9 @@ ThreadPool *thread_pool_new(AioContext *ctx)
 
 void thread_pool_free(ThreadPool *pool)
 {
+    ThreadPoolWorker *worker;
+    long i;
+
     if (!pool) {
         return;
     }
@@ -334,21 +769,40 @@ void thread_pool_free(ThreadPool *pool)
 
     /* Stop new threads from spawning */
     qemu_bh_delete(pool->new_thread_bh);
+    for (i = find_first_bit(pool->start_workers, THREAD_POOL_MAX_THREADS);
+         i < THREAD_POOL_MAX_THREADS;
+         i = find_next_bit(pool->start_workers, THREAD_POOL_MAX_THREADS,
+                           i + 1)) {
+        pool->workers[i]->running = false;
+    }
+    bitmap_zero(pool->start_workers, THREAD_POOL_MAX_THREADS);
     pool->cur_threads -= pool->new_threads;
     pool->new_threads = 0;
 
     /* Wait for worker threads to terminate */
-    pool->stopping = true;
+    atomic_mb_set(&pool->stopping, true);
     while (pool->cur_threads > 0) {
-        qemu_sem_post(&pool->sem);
+        worker = thread_pool_claim_idle(pool);
+        if (worker) {
+            qemu_sem_post(&worker->sem);
+            continue;
+        }
         qemu_cond_wait(&pool->worker_stopped, &pool->lock);
     }
 
     qemu_mutex_unlock(&pool->lock);
 
+    for (i = 0; i < pool->nr_workers; i++) {
+        worker = pool->workers[i];
+        assert(QTAILQ_EMPTY(&worker->request_list));
+        qemu_sem_destroy(&worker->sem);
+        qemu_mutex_destroy(&worker->lock);
+        g_free(worker);
+    }
+
     qemu_bh_delete(pool->completion_bh);
-    qemu_sem_destroy(&pool->sem);
     qemu_cond_destroy(&pool->worker_stopped);
     qemu_mutex_destroy(&pool->lock);
+    g_free(pool->cpus);
     g_free(pool);
 }
@@ -335,6 +335,11 @@ static QemuOptsList qemu_accel_opts = {
             .type = QEMU_OPT_STRING,
             .help = "Enable/disable multi-threaded TCG",
         },
+        {
+            .name = "regalloc",
+            .type = QEMU_OPT_STRING,
+            .help = "Select the TCG register allocator",
+        },
         { /* end of list */ }
     },
 };